@@ -18,6 +18,7 @@ public class FlecsLibrary : ModuleRules
 		PrivateDependencyModuleNames.AddRange(new string[] { 
 			"AIModule", 
 			"Navmesh",
+			"Landscape",
 		});
 
 		
@@ -1,11 +1,15 @@
 #include "FlecsLibrary.h"
 
+#include "UECS/EcsOsApi.h"
+
 // DEFINE_LOG_CATEGORY(PeGeneral);
 
 IMPLEMENT_MODULE(FFlecsLibrary, FlecsLibrary);
 
 void FFlecsLibrary::StartupModule()
 {
+	// Before any world exists, so flecs never allocates or spawns threads on its own.
+	FEcsOsApi::Install();
 }
 
 void FFlecsLibrary::ShutdownModule()
@@ -0,0 +1,189 @@
+#include "UECS/CollisionBatchHelper.h"
+
+namespace
+{
+	FORCEINLINE VectorRegister4Float Dot3(const VectorRegister4Float& AX, const VectorRegister4Float& AY, const VectorRegister4Float& AZ,
+	                                      const VectorRegister4Float& BX, const VectorRegister4Float& BY, const VectorRegister4Float& BZ)
+	{
+		return VectorMultiplyAdd(AX, BX, VectorMultiplyAdd(AY, BY, VectorMultiply(AZ, BZ)));
+	}
+
+	FORCEINLINE VectorRegister4Float Clamp01(const VectorRegister4Float& Value)
+	{
+		return VectorMin(VectorMax(Value, VectorZeroFloat()), VectorOneFloat());
+	}
+
+	// Returns zero in every lane whose denominator is degenerate.
+	FORCEINLINE VectorRegister4Float SafeDivide(const VectorRegister4Float& Numerator, const VectorRegister4Float& Denominator)
+	{
+		const VectorRegister4Float Valid = VectorCompareGT(Denominator, VectorSetFloat1(SMALL_NUMBER));
+		const VectorRegister4Float Quotient = VectorDivide(Numerator, VectorSelect(Valid, Denominator, VectorOneFloat()));
+		return VectorSelect(Valid, Quotient, VectorZeroFloat());
+	}
+
+	struct FLaneClosestPoints
+	{
+		VectorRegister4Float Gap;
+		VectorRegister4Float DeltaX, DeltaY, DeltaZ;
+		VectorRegister4Float Distance;
+		VectorRegister4Float PointX, PointY, PointZ;
+	};
+
+	// Branchless segment-segment closest points (Ericson, RTCD 5.1.9). The mover segment sits at the origin.
+	FORCEINLINE FLaneClosestPoints ClosestPoints(const FSweptSegment& Mover, const VectorRegister4Float& MoverRadius,
+	                                             const VectorRegister4Float& CX, const VectorRegister4Float& CY, const VectorRegister4Float& CZ,
+	                                             const VectorRegister4Float& HX, const VectorRegister4Float& HY, const VectorRegister4Float& HZ,
+	                                             const VectorRegister4Float& Radius)
+	{
+		const VectorRegister4Float Two = VectorSetFloat1(2.0f);
+
+		const VectorRegister4Float D1X = VectorSetFloat1(Mover.HalfSegment.X * 2.0f);
+		const VectorRegister4Float D1Y = VectorSetFloat1(Mover.HalfSegment.Y * 2.0f);
+		const VectorRegister4Float D1Z = VectorSetFloat1(Mover.HalfSegment.Z * 2.0f);
+		const VectorRegister4Float P1X = VectorSetFloat1(-Mover.HalfSegment.X);
+		const VectorRegister4Float P1Y = VectorSetFloat1(-Mover.HalfSegment.Y);
+		const VectorRegister4Float P1Z = VectorSetFloat1(-Mover.HalfSegment.Z);
+
+		const VectorRegister4Float D2X = VectorMultiply(HX, Two);
+		const VectorRegister4Float D2Y = VectorMultiply(HY, Two);
+		const VectorRegister4Float D2Z = VectorMultiply(HZ, Two);
+		const VectorRegister4Float P2X = VectorSubtract(CX, HX);
+		const VectorRegister4Float P2Y = VectorSubtract(CY, HY);
+		const VectorRegister4Float P2Z = VectorSubtract(CZ, HZ);
+
+		const VectorRegister4Float RX = VectorSubtract(P1X, P2X);
+		const VectorRegister4Float RY = VectorSubtract(P1Y, P2Y);
+		const VectorRegister4Float RZ = VectorSubtract(P1Z, P2Z);
+
+		const VectorRegister4Float A = Dot3(D1X, D1Y, D1Z, D1X, D1Y, D1Z);
+		const VectorRegister4Float E = Dot3(D2X, D2Y, D2Z, D2X, D2Y, D2Z);
+		const VectorRegister4Float B = Dot3(D1X, D1Y, D1Z, D2X, D2Y, D2Z);
+		const VectorRegister4Float C = Dot3(D1X, D1Y, D1Z, RX, RY, RZ);
+		const VectorRegister4Float F = Dot3(D2X, D2Y, D2Z, RX, RY, RZ);
+
+		// Parallel (or degenerate) segments pick S = 0, then everything is resolved by the clamp on T.
+		const VectorRegister4Float Denominator = VectorSubtract(VectorMultiply(A, E), VectorMultiply(B, B));
+		const VectorRegister4Float S0 = Clamp01(SafeDivide(VectorSubtract(VectorMultiply(B, F), VectorMultiply(C, E)), Denominator));
+		const VectorRegister4Float T = Clamp01(SafeDivide(VectorMultiplyAdd(B, S0, F), E));
+
+		// Re-solving S against the clamped T covers both clamp cases without branching.
+		const VectorRegister4Float S = Clamp01(SafeDivide(VectorSubtract(VectorMultiply(B, T), C), A));
+
+		const VectorRegister4Float Closest1X = VectorMultiplyAdd(D1X, S, P1X);
+		const VectorRegister4Float Closest1Y = VectorMultiplyAdd(D1Y, S, P1Y);
+		const VectorRegister4Float Closest1Z = VectorMultiplyAdd(D1Z, S, P1Z);
+
+		FLaneClosestPoints Output;
+		Output.DeltaX = VectorSubtract(VectorMultiplyAdd(D2X, T, P2X), Closest1X);
+		Output.DeltaY = VectorSubtract(VectorMultiplyAdd(D2Y, T, P2Y), Closest1Y);
+		Output.DeltaZ = VectorSubtract(VectorMultiplyAdd(D2Z, T, P2Z), Closest1Z);
+		Output.Distance = VectorSqrt(Dot3(Output.DeltaX, Output.DeltaY, Output.DeltaZ, Output.DeltaX, Output.DeltaY, Output.DeltaZ));
+		Output.Gap = VectorSubtract(Output.Distance, VectorAdd(MoverRadius, Radius));
+		Output.PointX = Closest1X;
+		Output.PointY = Closest1Y;
+		Output.PointZ = Closest1Z;
+
+		return Output;
+	}
+}
+
+bool FCollisionBatchHelper::MakeSweptSegment(const FSupportShape& SupportShape, const FTransform& Transform, const FVector& Velocity,
+                                             const FVector& AngularVelocity, const float DeltaTime, FSweptSegment& OutSegment)
+{
+	if(SupportShape.Hull.IsValid()) { return false; }
+
+	const FCollisionShape& Shape = SupportShape.Shape;
+	switch(Shape.ShapeType)
+	{
+	case ECollisionShape::Sphere:
+		OutSegment.HalfSegment = FVector3f::ZeroVector;
+		OutSegment.Radius = Shape.GetSphereRadius() * Transform.GetMaximumAxisScale();
+		break;
+	case ECollisionShape::Capsule:
+		if(!AngularVelocity.IsNearlyZero()) { return false; }
+
+		// Mirrors FCollisionHelper::Support, which treats the half height as the half length of the inner segment.
+		OutSegment.HalfSegment = FVector3f(Transform.GetScaledAxis(EAxis::Z) * Shape.GetCapsuleHalfHeight());
+		OutSegment.Radius = Shape.GetCapsuleRadius();
+		break;
+	default:
+		return false;
+	}
+
+	OutSegment.Displacement = FVector3f(Velocity * DeltaTime);
+	return true;
+}
+
+void FCollisionBatchHelper::SweepSegments(const FSweptSegment& Mover, const FSweptSegmentLanes& Lanes, FSweptSegmentBatchOutput& Output)
+{
+	const VectorRegister4Float MoverRadius = VectorSetFloat1(Mover.Radius);
+	const VectorRegister4Float Tolerance = VectorSetFloat1(ContactTolerance);
+
+	const VectorRegister4Float CX = VectorLoadAligned(Lanes.CenterX);
+	const VectorRegister4Float CY = VectorLoadAligned(Lanes.CenterY);
+	const VectorRegister4Float CZ = VectorLoadAligned(Lanes.CenterZ);
+	const VectorRegister4Float HX = VectorLoadAligned(Lanes.HalfSegmentX);
+	const VectorRegister4Float HY = VectorLoadAligned(Lanes.HalfSegmentY);
+	const VectorRegister4Float HZ = VectorLoadAligned(Lanes.HalfSegmentZ);
+	const VectorRegister4Float Radius = VectorLoadAligned(Lanes.Radius);
+
+	// Work in the mover's frame: only the candidates move, by their displacement relative to the mover's.
+	const VectorRegister4Float VX = VectorSubtract(VectorLoadAligned(Lanes.DisplacementX), VectorSetFloat1(Mover.Displacement.X));
+	const VectorRegister4Float VY = VectorSubtract(VectorLoadAligned(Lanes.DisplacementY), VectorSetFloat1(Mover.Displacement.Y));
+	const VectorRegister4Float VZ = VectorSubtract(VectorLoadAligned(Lanes.DisplacementZ), VectorSetFloat1(Mover.Displacement.Z));
+	const VectorRegister4Float Speed = VectorSqrt(Dot3(VX, VY, VZ, VX, VY, VZ));
+
+	const int32 UsedLaneBits = (1 << Lanes.Count) - 1;
+
+	VectorRegister4Float Time = VectorZeroFloat();
+	VectorRegister4Float Active = VectorCompareGE(VectorZeroFloat(), VectorZeroFloat());
+	VectorRegister4Float Hit = VectorZeroFloat();
+	FLaneClosestPoints Closest;
+
+	for(int32 IdxLane = 0; IdxLane < CollisionBatchWidth; ++IdxLane)
+	{
+		Output.NumIterations[IdxLane] = 0;
+	}
+
+	for(int32 IdxIter = 0; IdxIter < MaxIterations; ++IdxIter)
+	{
+		const int32 ActiveBits = VectorMaskBits(Active) & UsedLaneBits;
+		for(int32 IdxLane = 0; IdxLane < Lanes.Count; ++IdxLane)
+		{
+			Output.NumIterations[IdxLane] += (ActiveBits >> IdxLane) & 1;
+		}
+
+		Closest = ClosestPoints(Mover, MoverRadius,
+			VectorMultiplyAdd(VX, Time, CX), VectorMultiplyAdd(VY, Time, CY), VectorMultiplyAdd(VZ, Time, CZ),
+			HX, HY, HZ, Radius);
+
+		const VectorRegister4Float Converged = VectorBitwiseAnd(Active, VectorCompareLE(Closest.Gap, Tolerance));
+		Hit = VectorBitwiseOr(Hit, Converged);
+		Active = VectorSelect(Converged, VectorZeroFloat(), Active);
+
+		// Relative linear speed bounds the rate at which the gap can close, so this step never tunnels.
+		const VectorRegister4Float NextTime = VectorAdd(Time, SafeDivide(Closest.Gap, Speed));
+		const VectorRegister4Float Missed = VectorBitwiseOr(VectorCompareGT(NextTime, VectorOneFloat()), VectorCompareLE(Speed, VectorSetFloat1(SMALL_NUMBER)));
+		Active = VectorSelect(Missed, VectorZeroFloat(), Active);
+		Time = VectorSelect(Active, NextTime, Time);
+
+		if((VectorMaskBits(Active) & UsedLaneBits) == 0) { break; }
+	}
+
+	// Finished lanes keep their time, so the last evaluation holds the contact data of every hit lane.
+	const VectorRegister4Float InvDistance = SafeDivide(VectorOneFloat(), Closest.Distance);
+	const VectorRegister4Float NX = VectorMultiply(Closest.DeltaX, InvDistance);
+	const VectorRegister4Float NY = VectorMultiply(Closest.DeltaY, InvDistance);
+	const VectorRegister4Float NZ = VectorMultiply(Closest.DeltaZ, InvDistance);
+
+	VectorStoreAligned(Time, Output.Time);
+	VectorStoreAligned(NX, Output.NormalX);
+	VectorStoreAligned(NY, Output.NormalY);
+	VectorStoreAligned(NZ, Output.NormalZ);
+	VectorStoreAligned(VectorMultiplyAdd(NX, MoverRadius, Closest.PointX), Output.PointX);
+	VectorStoreAligned(VectorMultiplyAdd(NY, MoverRadius, Closest.PointY), Output.PointY);
+	VectorStoreAligned(VectorMultiplyAdd(NZ, MoverRadius, Closest.PointZ), Output.PointZ);
+
+	Output.HitMask = VectorMaskBits(Hit) & UsedLaneBits;
+	Output.UnresolvedMask = VectorMaskBits(Active) & UsedLaneBits;
+}
@@ -1,22 +1,119 @@
 #include "..\..\Public\UECS\CollisionHelper.h"
 
+#include "UECS/CollisionBatchHelper.h"
+#include "UECS/CollisionKernels.h"
+#include "Algo/Impl/BinaryHeap.h"
+#include "HAL/IConsoleManager.h"
 #include "UECS/Components/AngularVelocity.h"
 #include "UECS/Components/BaseComponents.h"
+#include "UECS/Components/PhysicsAndCollision/CcdMode.h"
+#include "UECS/Components/PhysicsAndCollision/ColliderTable.h"
+#include "UECS/Components/PhysicsAndCollision/ConvexHullShape.h"
 #include "UECS/Components/PhysicsAndCollision/CollisionSpatialGrid.h"
 #include "UECS/Components/PhysicsAndCollision/ICollisionHandler.h"
 #include "UECS/Components/PhysicsAndCollision/NarrowPhaseCollisionCandidates.h"
 #include "UECS/Components/PhysicsAndCollision/NarrowPhaseEntityContacts.h"
 #include "UECS/Components/PhysicsAndCollision/OverlapCollision.h"
 
-FTransform FCollisionHelper::LerpTransform(const FTransform& Start, const FTransform& End, float Alpha)
+static TAutoConsoleVariable<int32> CVarCollisionKernelPrecision(
+	TEXT("ecs.Collision.KernelPrecision"),
+	0,
+	TEXT("Precision of the GJK and conservative advancement kernels. 0: doubles in world space, 1: floats relative to the first shape of each pair."),
+	ECVF_Default);
+
+namespace
 {
-	FTransform Result;
-		
-	Result.SetTranslation(FMath::Lerp(Start.GetTranslation(), End.GetTranslation(), Alpha));
-	Result.SetRotation(FQuat::Slerp(Start.GetRotation(), End.GetRotation(), Alpha));
-	Result.SetScale3D(FMath::Lerp(Start.GetScale3D(), End.GetScale3D(), Alpha));
+	// Moves a world space transform into single precision, relative to Origin.
+	FORCEINLINE FTransform3f ToLocal(const FTransform& Transform, const FVector& Origin)
+	{
+		return FTransform3f(FQuat4f(Transform.GetRotation()), FVector3f(Transform.GetTranslation() - Origin), FVector3f(Transform.GetScale3D()));
+	}
 
-	return Result;
+	FORCEINLINE FCollisionOutput ToWorld(const TCollisionOutput<float>& Output, const FVector& Origin)
+	{
+		return FCollisionOutput {
+			.bDidOverlap = Output.bDidOverlap,
+			.Distance = Output.Distance,
+			.ClosestA = FVector(Output.ClosestA) + Origin,
+			.ClosestB = FVector(Output.ClosestB) + Origin,
+			.Normal = FVector(Output.Normal)
+		};
+	}
+
+	FORCEINLINE FConservativeAdvancementOutput ToWorld(const TConservativeAdvancementOutput<float>& Output, const FVector& Origin)
+	{
+		return FConservativeAdvancementOutput {
+			.Time = Output.Time,
+			.bInitialOverlap = Output.bInitialOverlap,
+			.bCollided = Output.bCollided,
+			.bStoppedShort = Output.bStoppedShort,
+			.NumIterations = Output.NumIterations,
+			.ContactPoint = Output.bCollided ? FVector(Output.ContactPoint) + Origin : FVector::ZeroVector,
+			.ContactNormal = FVector(Output.ContactNormal)
+		};
+	}
+
+	// Yields candidate collider ids nearest-first without sorting all of them. The array is heapified once, and every pop
+	// moves the nearest remaining id behind the heap, so popped ids keep their index while the rest stay unordered. Ids
+	// without a live proxy come last.
+	struct FNearestCandidateHeap
+	{
+		FNearestCandidateHeap(const FColliderTable& InColliderTable, TArray<int32>& InCandidates, const FVector& InOrigin)
+			: Candidates(InCandidates), IsNearer { InColliderTable, InOrigin }, NumRemaining(InCandidates.Num())
+		{
+			AlgoImpl::HeapifyInternal(Candidates.GetData(), NumRemaining, FIdentityFunctor(), IsNearer);
+		}
+
+		FORCEINLINE bool IsEmpty() const { return NumRemaining <= 0; }
+
+		// Collider id of the nearest candidate not popped yet.
+		FORCEINLINE int32 Pop()
+		{
+			const int32 IdxLast = --NumRemaining;
+			Swap(Candidates[0], Candidates[IdxLast]);
+			AlgoImpl::HeapSiftDown(Candidates.GetData(), 0, IdxLast, FIdentityFunctor(), IsNearer);
+			return Candidates[IdxLast];
+		}
+
+	private:
+		// Ties are broken by entity id so the order doesn't depend on where the candidates happened to sit in the grid.
+		struct FIsNearer
+		{
+			const FColliderTable& ColliderTable;
+			FVector Origin;
+
+			FORCEINLINE bool operator()(const int32 IdA, const int32 IdB) const
+			{
+				const bool bLiveA = ColliderTable.IsLiveId(IdA);
+				const bool bLiveB = ColliderTable.IsLiveId(IdB);
+				if(!bLiveA || !bLiveB) { return bLiveA; }
+
+				const FColliderProxy& A = ColliderTable[IdA];
+				const FColliderProxy& B = ColliderTable[IdB];
+				const double DistanceA = (A.Transform.GetLocation() - Origin).SizeSquared();
+				const double DistanceB = (B.Transform.GetLocation() - Origin).SizeSquared();
+
+				return DistanceA != DistanceB ? DistanceA < DistanceB : A.Entity.id() < B.Entity.id();
+			}
+		};
+
+		TArray<int32>& Candidates;
+		FIsNearer IsNearer;
+		int32 NumRemaining;
+	};
+
+	FORCEINLINE FTransform AdvanceTransform(const FTransform& Transform, const FVector& Velocity, const FVector& AngularVelocity, const float Time)
+	{
+		FTransform Result = Transform;
+		Result.SetRotation(Transform.GetRotation() * (AngularVelocity * Time).ToOrientationQuat());
+		Result.AddToTranslation(Velocity * Time);
+		return Result;
+	}
+}
+
+FTransform FCollisionHelper::LerpTransform(const FTransform& Start, const FTransform& End, float Alpha)
+{
+	return TCollisionKernels<double>::LerpTransform(Start, End, Alpha);
 }
 
 float FCollisionHelper::ApproximateDistanceFromOrigin(const TArray<FVector>& Simplex)
@@ -35,42 +132,9 @@ float FCollisionHelper::ApproximateDistanceFromOrigin(const TArray<FVector>& Sim
 	return MinDistance;
 }
 
-FVector FCollisionHelper::Support(const FCollisionShape& Shape, const FTransform& Transform, const FVector& Direction)
+FVector FCollisionHelper::Support(const FSupportShape& SupportShape, const FTransform& Transform, const FVector& Direction)
 {
-	switch (Shape.ShapeType)
-	{
-	case ECollisionShape::Box:
-		{
-			const FVector X = Transform.GetScaledAxis(EAxis::X);
-			const FVector Y = Transform.GetScaledAxis(EAxis::Y);
-			const FVector Z = Transform.GetScaledAxis(EAxis::Z);
-
-			const FVector HalfExtents = Shape.GetExtent() * Transform.GetScale3D();
-
-			return (X * FMath::Sign(X.Dot(Direction)) * HalfExtents.X)
-				+ (Y * FMath::Sign(Y.Dot(Direction)) * HalfExtents.Y)
-				+ (Z * FMath::Sign(Z.Dot(Direction)) * HalfExtents.Z)
-				+ Transform.GetTranslation();
-		}
-
-	case ECollisionShape::Sphere:
-		return Direction * Shape.GetSphereRadius() * Transform.GetMaximumAxisScale() + Transform.GetTranslation();
-			
-	case ECollisionShape::Capsule:
-		{
-			const FVector CapsuleAxis = Transform.GetScaledAxis(EAxis::Z);
-			const float HalfLength = Shape.GetCapsuleHalfHeight();
-			const float Radius = Shape.GetCapsuleRadius();
-
-			return Transform.GetTranslation()
-				+ CapsuleAxis * (HalfLength * FMath::Sign(CapsuleAxis.Dot(Direction)))
-				+ Direction.GetSafeNormal()
-				* Radius;
-		}
-			
-	default:
-		return FVector::ZeroVector;
-	}
+	return TCollisionKernels<double>::Support(SupportShape, Transform, Direction);
 }
 
 FVector FCollisionHelper::CalculateLineNormal(const FVector& A, const FVector& B)
@@ -255,209 +319,17 @@ bool FCollisionHelper::UpdateSimplex(TArray<FVector>& Simplex, FVector& Directio
 
 FVector FCollisionHelper::SolveSimplex2(FSimplex& Simplex, FVector& OutDirection)
 {
-	const FVector Ab = Simplex.B - Simplex.A;
-	const FVector Ao = -Simplex.A;
-
-	if (SameDirection(Ab, Ao))
-	{
-		// The origin falls on the line.
-		// Project the origin onto the line and return.
-		const float T = FVector::DotProduct(Ao, Ab) / FVector::DotProduct(Ab, Ab);
-		OutDirection = FVector::CrossProduct(FVector::CrossProduct(Ab, Ao), Ab);
-		return Simplex.A + T * Ab;
-	}
-		
-	// The origin is closer to A.
-	Simplex.Count = 1;
-	OutDirection = Ao;
-	return Simplex.A;
+	return TCollisionKernels<double>::SolveSimplex2(Simplex, OutDirection);
 }
 
 FVector FCollisionHelper::SolveSimplex3(FSimplex& Simplex, FVector& OutDirection)
 {
-	const FVector Abc = FVector::CrossProduct(Simplex.B - Simplex.A, Simplex.C - Simplex.A);
-	const FVector Ac = Simplex.C - Simplex.A;
-	const FVector Ao = -Simplex.A;
-
-	if (SameDirection(FVector::CrossProduct(Abc, Ac), Ao))
-	{
-		if (SameDirection(Ac, Ao))
-		{
-			// The origin is nearest to the line AC
-			Simplex.B = Simplex.C;
-			Simplex.Count = 2;
-			const float T = FVector::DotProduct(Ao, Ac) / FVector::DotProduct(Ac, Ac);
-			OutDirection = FVector::CrossProduct(FVector::CrossProduct(Ac, Ao), Ac);
-			return Simplex.A + T * Ac;
-		}
-
-		const FVector Ab = Simplex.B - Simplex.A;
-		if (SameDirection(Ab, Ao))
-		{
-			// The origin is nearest to the line AB
-			Simplex.Count = 2;
-			const float T = FVector::DotProduct(Ao, Ab) / FVector::DotProduct(Ab, Ab);
-			OutDirection = FVector::CrossProduct(FVector::CrossProduct(Ab, Ao), Ab);
-			return Simplex.A + T * Ab;
-		}
-	        	
-		// The origin is nearest to the point A
-		Simplex.Count = 1;
-		OutDirection = Ao;
-		return Simplex.A;
-	}
-
-	const FVector Ab = Simplex.B - Simplex.A;
-	if (SameDirection(FVector::CrossProduct(Ab, Abc), Ao))
-	{
-		if (SameDirection(Ab, Ao))
-		{
-			// The origin is nearest to the line AB
-			Simplex.Count = 2;
-			const float T = FVector::DotProduct(Ao, Ab) / FVector::DotProduct(Ab, Ab);
-			OutDirection = FVector::CrossProduct(FVector::CrossProduct(Ab, Ao), Ab);
-			return Simplex.A + T * Ab;
-		}
-	    	
-		// The origin is nearest to the point A
-		Simplex.Count = 1;
-		OutDirection = Ao;
-		return Simplex.A;
-	}
-		
-	if (SameDirection(Abc, Ao))
-	{
-		// The origin is nearest to the triangle ABC
-		const FVector Bo = -Simplex.B;
-		const FVector Co = -Simplex.C;
-		const float D1 = FVector::DotProduct(Ab, Ao);
-		const float D2 = FVector::DotProduct(Ac, Ao);
-		const float D3 = FVector::DotProduct(Ab, Bo);
-		const float D4 = FVector::DotProduct(Ac, Bo);
-		const float D5 = FVector::DotProduct(Ab, Co);
-		const float D6 = FVector::DotProduct(Ac, Co);
-		const float Va = D3 * D6 - D5 * D4;
-		const float Vb = D5 * D2 - D1 * D6;
-		const float Vc = D1 * D4 - D3 * D2;
-		const float Denom = 1.0f / (Va + Vb + Vc);
-		const float V = Vb * Denom;
-		const float W = Vc * Denom;
-		OutDirection = Abc;
-		return Simplex.A + V * Ab + W * Ac;
-	}
-		
-	// The origin is nearest to the triangle ACB
-	Swap(Simplex.B, Simplex.C);
-	Swap(Simplex.B1, Simplex.C1);
-	Swap(Simplex.B2, Simplex.C2);
-		
-	const FVector Bo = -Simplex.B;
-	const FVector Co = -Simplex.C;
-	const float D1 = FVector::DotProduct(Ac, Ao);
-	const float D2 = FVector::DotProduct(Ab, Ao);
-	const float D3 = FVector::DotProduct(Ac, Co);
-	const float D4 = FVector::DotProduct(Ab, Co);
-	const float D5 = FVector::DotProduct(Ac, Bo);
-	const float D6 = FVector::DotProduct(Ab, Bo);
-	const float Va = D3 * D6 - D5 * D4;
-	const float Vb = D5 * D2 - D1 * D6;
-	const float Vc = D1 * D4 - D3 * D2;
-	const float Denom = 1.0f / (Va + Vb + Vc);
-	const float V = Vb * Denom;
-	const float W = Vc * Denom;
-	OutDirection = -Abc;
-	return Simplex.A + V * Ab + W * Ac;
+	return TCollisionKernels<double>::SolveSimplex3(Simplex, OutDirection);
 }
 
 FVector FCollisionHelper::SolveSimplex4(FSimplex& Simplex, FVector& OutDirection)
 {
-	const FVector Abc = FVector::CrossProduct(Simplex.B - Simplex.A, Simplex.C - Simplex.A);
-	const FVector Acd = FVector::CrossProduct(Simplex.C - Simplex.A, Simplex.D - Simplex.A);
-	const FVector Adb = FVector::CrossProduct(Simplex.D - Simplex.A, Simplex.B - Simplex.A);
-	const FVector Ao = -Simplex.A;
-
-	const bool bSameAbcDir = SameDirection(Abc, Ao);
-	const bool bSameAcdDir = SameDirection(Acd, Ao);
-	const bool bSameAdbDir = SameDirection(Adb, Ao);
-
-	if (!bSameAbcDir && !bSameAcdDir && !bSameAdbDir)
-	{
-		OutDirection = FVector(0, 0, 0);
-		return FVector(0, 0, 0);
-	}
-
-	if (bSameAbcDir && !bSameAcdDir && !bSameAdbDir)
-	{
-		Simplex.Count = 3;
-		return SolveSimplex3(Simplex, OutDirection);
-	}
-
-	if (!bSameAbcDir && bSameAcdDir && !bSameAdbDir)
-	{
-		Simplex.B = Simplex.C;
-		Simplex.C = Simplex.D;
-		Simplex.Count = 3;
-		return SolveSimplex3(Simplex, OutDirection);
-	}
-
-	if (!bSameAbcDir && !bSameAcdDir && bSameAdbDir)
-	{
-		Simplex.C = Simplex.B;
-		Simplex.B = Simplex.D;
-		Simplex.Count = 3;
-		return SolveSimplex3(Simplex, OutDirection);
-	}
-
-	// The origin potentially falls on multiple triangles.
-	FSimplex SimplexAbc = Simplex;
-	SimplexAbc.Count = 3;
-
-	FSimplex SimplexAcd = Simplex;
-	SimplexAcd.B = SimplexAcd.C;
-	SimplexAcd.C = SimplexAcd.D;
-	SimplexAcd.Count = 3;
-
-	FSimplex SimplexAdb = Simplex;
-	SimplexAdb.C = SimplexAdb.B;
-	SimplexAdb.B = SimplexAdb.D;
-	SimplexAdb.Count = 3;
-
-	FVector DirAbc, DirAcd, DirAdb;
-
-	const FVector PAbc = SolveSimplex3(SimplexAbc, DirAbc);
-	const FVector PAcd = SolveSimplex3(SimplexAcd, DirAcd);
-	const FVector PAdb = SolveSimplex3(SimplexAdb, DirAdb);
-
-	const float AbcD2 = FVector::DotProduct(PAbc, PAbc);
-	const float AcdD2 = FVector::DotProduct(PAcd, PAcd);
-	const float AdbD2 = FVector::DotProduct(PAdb, PAdb);
-
-	if (AbcD2 <= AcdD2 && AbcD2 <= AdbD2)
-	{
-		Simplex = SimplexAbc;
-		OutDirection = DirAbc;
-		return PAbc;
-	}
-		
-	if (AcdD2 <= AbcD2 && AcdD2 <= AdbD2)
-	{
-		Simplex = SimplexAcd;
-		OutDirection = DirAcd;
-		return PAcd;
-	}
-		
-	if (AdbD2 <= AbcD2 && AdbD2 <= AcdD2)
-	{
-		Simplex = SimplexAdb;
-		OutDirection = DirAdb;
-		return PAdb;
-	}
-
-	// Should never be reached...
-	check(false);
-		
-	OutDirection = FVector(0, 0, 0);
-	return FVector(0, 0, 0);
+	return TCollisionKernels<double>::SolveSimplex4(Simplex, OutDirection);
 }
 
 float FCollisionHelper::TriangleArea2D(const float X1, const float Y1, const float X2, const float Y2, const float X3, const float Y3)
@@ -489,181 +361,37 @@ FVector FCollisionHelper::ConvertBarycentricCoordsToCartesianCoordsLine(const FV
 
 FVector FCollisionHelper::GetBarycentricCoordsTriangle(const FVector& A, const FVector& B, const FVector& C, const FVector& P)
 {
-	const FVector Abc = FVector::CrossProduct(B - A, C - A);
-
-	float Nu, Nv, Ood;
-
-	const float X = FMath::Abs(Abc.X);
-	const float Y = FMath::Abs(Abc.Y);
-	const float Z = FMath::Abs(Abc.Z);
-
-	if (X >= Y && X >= Z)
-	{
-		// X is the largest, so project onto the YZ plane.
-		Nu = TriangleArea2D(P.Y, P.Z, B.Y, B.Z, C.Y, C.Z);
-		Nv = TriangleArea2D(P.Y, P.Z, C.Y, C.Z, A.Y, A.Z);
-		Ood = 1.0f / Abc.X;
-	}
-	else if (Y >= X && Y >= Z)
-	{
-		// Y is the largest, so project onto the XZ plane.
-		Nu = TriangleArea2D(P.X, P.Z, B.X, B.Z, C.X, C.Z);
-		Nv = TriangleArea2D(P.X, P.Z, C.X, C.Z, A.X, A.Z);
-		Ood = 1.0f / -Abc.Y; // Negated because of the coordinate system orientation
-	}
-	else
-	{
-		// Z is the largest, so project onto the XY plane.
-		Nu = TriangleArea2D(P.X, P.Y, B.X, B.Y, C.X, C.Y);
-		Nv = TriangleArea2D(P.X, P.Y, C.X, C.Y, A.X, A.Y);
-		Ood = 1.0f / Abc.Z;
-	}
-
-	FVector Result;
-	Result.X = Nu * Ood;
-	Result.Y = Nv * Ood;
-	Result.Z = 1.0f - Result.X - Result.Y;
-
-	return Result;
+	return TCollisionKernels<double>::GetBarycentricCoordsTriangle(A, B, C, P);
 }
 
 float FCollisionHelper::GetBarycentricScalarLine(const FVector& A, const FVector& B, const FVector& P)
 {
-	const FVector AB = B - A;
-	const FVector AP = P - A;
-	const float T = FVector::DotProduct(AP, AB) / FVector::DotProduct(AB, AB);
-	return T;
+	return TCollisionKernels<double>::GetBarycentricScalarLine(A, B, P);
 }
 
 TTuple<FVector, FVector> FCollisionHelper::GetLocalPoints(FSimplex Simplex, const FVector& Point)
 {
-	switch(Simplex.Count)
-	{
-	case 1:
-		return {Simplex.A1, Simplex.A2 };
-	case 2:
-		{
-			const float Barycentric  = GetBarycentricScalarLine(Simplex.A, Simplex.B, Point);
-			const FVector CartesianA = ConvertBarycentricCoordsToCartesianCoordsLine(Simplex.A1, Simplex.B1, Barycentric);
-			const FVector CartesianB = ConvertBarycentricCoordsToCartesianCoordsLine(Simplex.A2, Simplex.B2, Barycentric);
-			return { CartesianA, CartesianB };
-		}
-	case 3:
-		{
-			const FVector Barycentric = GetBarycentricCoordsTriangle(Simplex.A, Simplex.B, Simplex.C, Point);
-			const FVector CartesianA = ConvertBarycentricCoordsToCartesianCoordsTriangle(Simplex.A1, Simplex.B1, Simplex.C1, Barycentric);
-			const FVector CartesianB = ConvertBarycentricCoordsToCartesianCoordsTriangle(Simplex.A2, Simplex.B2, Simplex.C2, Barycentric);
-			return { CartesianA, CartesianB };
-		}
-	default:
-		return { FVector::ZeroVector, FVector::ZeroVector };
-	}
+	return TCollisionKernels<double>::GetLocalPoints(Simplex, Point);
 }
 
-FCollisionOutput FCollisionHelper::GJK_Complex(const FCollisionShape& ShapeA, const FTransform& TransformA, const FCollisionShape& ShapeB, const FTransform& TransformB)
+FCollisionOutput FCollisionHelper::GJK_Complex(const FSupportShape& ShapeA, const FTransform& TransformA, const FSupportShape& ShapeB, const FTransform& TransformB)
 {
-	FSimplex Simplex;
-	FVector Dir = (TransformB.GetLocation() - TransformA.GetLocation()).GetSafeNormal();
-
-	Simplex.A1 = Support(ShapeA, TransformA, -Dir);
-	Simplex.A2 = Support(ShapeB, TransformB, Dir);
-	Simplex.A = Simplex.A2 - Simplex.A1;
-	Simplex.Count = 1;
-
-	FSimplex BestSimplex;
-	float BestSupportDifference = -std::numeric_limits<float>::infinity();
-	FVector BestPointOnSimplex;
+	return GJK_Complex(GetKernelPrecision(), ShapeA, TransformA, ShapeB, TransformB);
+}
 
-	for(int32 IdxIter = 0; IdxIter < 32; ++IdxIter)
+FCollisionOutput FCollisionHelper::GJK_Complex(const ECollisionKernelPrecision Precision, const FSupportShape& ShapeA, const FTransform& TransformA, const FSupportShape& ShapeB,
+	const FTransform& TransformB)
+{
+	if(Precision == ECollisionKernelPrecision::Double)
 	{
-		FVector PointOnSimplex;
-
-		FVector Direction;
-			
-		switch(Simplex.Count)
-		{
-		case 1:
-			PointOnSimplex = Simplex.A;
-			Direction = -Simplex.A;
-			break;
-		case 2:
-			PointOnSimplex = SolveSimplex2(Simplex, Direction);
-			break;
-		case 3:
-			PointOnSimplex = SolveSimplex3(Simplex, Direction);
-			break;
-		case 4:
-			PointOnSimplex = SolveSimplex4(Simplex, Direction);
-			break;
-		default:
-			check(false);
-		}
-
-		Direction.Normalize();
-
-		// Early-out to avoid FPU imprecision issues. We're close enough to 0, so it's good enough.
-		if(PointOnSimplex.Length() < KINDA_SMALL_NUMBER)
-		{
-			const TTuple<FVector, FVector> BestPoints = GetLocalPoints(Simplex, PointOnSimplex);
-			return FCollisionOutput
-			{
-				.bDidOverlap = true,
-				.Distance = 0.0f,
-				.ClosestA = BestPoints.Key,
-				.ClosestB = BestPoints.Value,
-				.Normal = -Direction.GetSafeNormal()
-			};
-		}
-
-		FVector SupportA = Support(ShapeA, TransformA, -Direction);
-		FVector SupportB = Support(ShapeB, TransformB, Direction);
-		FVector Support = SupportB - SupportA;
-			
-		const float PDotDir = PointOnSimplex.Dot(Direction);
-		const float SupportDotDir = Support.Dot(Direction) - KINDA_SMALL_NUMBER;
-
-		// Detect if PointOnSimplex is more extreme than the Support point. In this case, we can't have a better support point.
-		if(PDotDir >= SupportDotDir)
-		{
-			const TTuple<FVector, FVector> BestPoints = GetLocalPoints(Simplex, PointOnSimplex);
-			return FCollisionOutput
-			{
-				.bDidOverlap = false,
-				.Distance = static_cast<float>(PointOnSimplex.Length()),
-				.ClosestA = BestPoints.Key,
-				.ClosestB = BestPoints.Value,
-				.Normal = -Direction.GetSafeNormal()
-			};
-		}
-
-		const float SupportDifference = SupportDotDir - PDotDir;
-		if(SupportDifference > BestSupportDifference)
-		{
-			BestSupportDifference = SupportDifference;
-			BestSimplex = Simplex;
-			BestPointOnSimplex = PointOnSimplex;
-		}
-
-		check(Simplex.Count < 4);
-
-		// Shuffle 'dem points.
-		Simplex.ShufflePoints(SupportA, SupportB, Support);
-
-		++Simplex.Count;
+		return TCollisionKernels<double>::GJK(ShapeA, TransformA, ShapeB, TransformB);
 	}
-		
-	const TTuple<FVector, FVector> BestPoints = GetLocalPoints(BestSimplex, BestPointOnSimplex);
-	return FCollisionOutput
-	{
-		.bDidOverlap = false,
-		.Distance = static_cast<float>(BestPointOnSimplex.Length()),
-		.ClosestA = BestPoints.Key,
-		.ClosestB = BestPoints.Value,
-		.Normal = -BestPointOnSimplex.GetSafeNormal()
-	};
+
+	const FVector Origin = TransformA.GetTranslation();
+	return ToWorld(TCollisionKernels<float>::GJK(ShapeA, ToLocal(TransformA, Origin), ShapeB, ToLocal(TransformB, Origin)), Origin);
 }
 
-FCollisionOutput FCollisionHelper::GJK_Simple(const FCollisionShape& ShapeA, const FTransform& TransformA, const FCollisionShape& ShapeB, const FTransform& TransformB)
+FCollisionOutput FCollisionHelper::GJK_Simple(const FSupportShape& ShapeA, const FTransform& TransformA, const FSupportShape& ShapeB, const FTransform& TransformB)
 {
 	FCollisionOutput Output;
 	Output.bDidOverlap = false;
@@ -702,77 +430,45 @@ FCollisionOutput FCollisionHelper::GJK_Simple(const FCollisionShape& ShapeA, con
 	return Output;
 }
 
-FConservativeAdvancementOutput FCollisionHelper::ConservativeAdvancement(const FCollisionShape& ShapeA, const FTransform& TransformFromA, const FTransform& TransformToA, const FCollisionShape& ShapeB,
+FConservativeAdvancementOutput FCollisionHelper::ConservativeAdvancement(const FSupportShape& ShapeA, const FTransform& TransformFromA, const FTransform& TransformToA, const FSupportShape& ShapeB,
 	const FTransform& TransformFromB, const FTransform& TransformToB)
 {
-	FConservativeAdvancementOutput Output;
-		
-	FCollisionOutput GJKOutput = GJK_Complex(ShapeA, TransformFromA, ShapeB, TransformFromB);
-	Output.bInitialOverlap = GJKOutput.bDidOverlap;
-		
-	if (GJKOutput.bDidOverlap)
-	{
-		Output.bCollided = true;
-		Output.Time = 0.0f;
-		return Output;
-	}
-		
-	const FVector LinearVelocityA = TransformToA.GetTranslation() - TransformFromA.GetTranslation();
-	const FVector LinearVelocityB = TransformToB.GetTranslation() - TransformFromB.GetTranslation();
-	const FVector RelativeLinearVelocity = LinearVelocityA - LinearVelocityB;
+	return ConservativeAdvancement(GetKernelPrecision(), ShapeA, TransformFromA, TransformToA, ShapeB, TransformFromB, TransformToB);
+}
 
-	const float AngularVelocityA = TransformToA.GetRotation().AngularDistance(TransformFromA.GetRotation());
-	const float AngularVelocityB = TransformToB.GetRotation().AngularDistance(TransformFromB.GetRotation());
-		
-	const float BoundingRadiusA = GetBoundingRadius(ShapeA, TransformFromA);
-	const float BoundingRadiusB = GetBoundingRadius(ShapeB, TransformFromB);
-	const float MaxAngularProjectedVelocity = AngularVelocityA * BoundingRadiusA + AngularVelocityB * BoundingRadiusB;
-	const float TotalMovement = RelativeLinearVelocity.Length();
-		
-	if (FMath::IsNearlyZero(TotalMovement))
+FConservativeAdvancementOutput FCollisionHelper::ConservativeAdvancement(const ECollisionKernelPrecision Precision, const FSupportShape& ShapeA, const FTransform& TransformFromA,
+	const FTransform& TransformToA, const FSupportShape& ShapeB, const FTransform& TransformFromB, const FTransform& TransformToB)
+{
+	if(Precision == ECollisionKernelPrecision::Double)
 	{
-		Output.Time = 1.0f; // No relative movement; they will never touch during this step.
-		return Output;
+		return TCollisionKernels<double>::ConservativeAdvancement(ShapeA, TransformFromA, TransformToA, ShapeB, TransformFromB, TransformToB);
 	}
 
-	float Lambda = 0.0f;
-	float NDotVel = RelativeLinearVelocity.Dot(GJKOutput.Normal);
-	
-	while (GJKOutput.Distance > KINDA_SMALL_NUMBER)
-	{
-		if(NDotVel + MaxAngularProjectedVelocity <= SMALL_NUMBER)
-		{
-			Output.Time = 1.0f;
-			return Output;
-		}
+	const FVector Origin = TransformFromA.GetTranslation();
+	return ToWorld(TCollisionKernels<float>::ConservativeAdvancement(ShapeA, ToLocal(TransformFromA, Origin), ToLocal(TransformToA, Origin),
+	                                                                 ShapeB, ToLocal(TransformFromB, Origin), ToLocal(TransformToB, Origin)), Origin);
+}
 
-		const float DeltaLambda = GJKOutput.Distance / (NDotVel + MaxAngularProjectedVelocity);
-		Lambda += DeltaLambda;
-			
-		if(Lambda < 0.0f || Lambda > 1.0f || DeltaLambda <= 0.0f)
-		{
-			Output.Time = 1.0f;
-			return Output;
-		}
-			
-		GJKOutput = GJK_Complex(ShapeA, LerpTransform(TransformFromA, TransformToA, Lambda), ShapeB, LerpTransform(TransformFromB, TransformToB, Lambda));
-		NDotVel = RelativeLinearVelocity.Dot(GJKOutput.Normal);
-		if(GJKOutput.bDidOverlap)
-		{
-			Output.Time = Lambda;
-			Output.bCollided = true;
-			Output.ContactNormal = GJKOutput.Normal;
-			Output.ContactPoint = GJKOutput.ClosestA;
-			return Output;
-		}
+FConservativeAdvancementOutput FCollisionHelper::SpeculativeContact(const FSupportShape& ShapeA, const FTransform& TransformFromA, const FTransform& TransformToA, const FSupportShape& ShapeB,
+	const FTransform& TransformFromB, const FTransform& TransformToB)
+{
+	if(GetKernelPrecision() == ECollisionKernelPrecision::Double)
+	{
+		return TCollisionKernels<double>::SpeculativeContact(ShapeA, TransformFromA, TransformToA, ShapeB, TransformFromB, TransformToB);
 	}
 
-	Output.Time = 1.0f;
-	return Output;
+	const FVector Origin = TransformFromA.GetTranslation();
+	return ToWorld(TCollisionKernels<float>::SpeculativeContact(ShapeA, ToLocal(TransformFromA, Origin), ToLocal(TransformToA, Origin),
+	                                                            ShapeB, ToLocal(TransformFromB, Origin), ToLocal(TransformToB, Origin)), Origin);
+}
+
+ECollisionKernelPrecision FCollisionHelper::GetKernelPrecision()
+{
+	return CVarCollisionKernelPrecision.GetValueOnAnyThread() == 1 ? ECollisionKernelPrecision::Single : ECollisionKernelPrecision::Double;
 }
 
 void FCollisionHelper::BoxBroadphase(float DeltaTime, const flecs::entity& Entity, const FCollisionShape& CollisionShape, const FPosition& Position, const FVelocity& Velocity,
-                                     FCollisionSpatialGrid& CollisionSpatialGrid, TArray<FEntityPositionCache>& CollisionCandidates)
+                                     const FCollisionFilter& Filter, FCollisionSpatialGrid& CollisionSpatialGrid, TArray<FEntityPositionCache>& CollisionCandidates)
 {
 	const FCollisionShape& Shape = CollisionShape;
 	const FVector MyPosition = Position.Value;
@@ -786,65 +482,262 @@ void FCollisionHelper::BoxBroadphase(float DeltaTime, const flecs::entity& Entit
 	const FBox Bounds = FBox(FVector::Min(BoundsA, BoundsB), FVector::Max(BoundsA, BoundsB));
 
 	CollisionCandidates.Reset();
-	CollisionSpatialGrid.GetEntitiesInBox(Entity, Bounds, CollisionCandidates);
+	CollisionSpatialGrid.GetCollidableEntitiesInBox(Entity, Filter, Bounds, CollisionCandidates);
+}
+
+void FCollisionHelper::PolylineBroadphase(const float DeltaTime, const flecs::entity& Entity, const FPosition& Position, const TConstArrayView<FVector> Steps,
+                                          const FCollisionFilter& Filter, FCollisionSpatialGrid& CollisionSpatialGrid, TArray<FEntityPositionCache>& CollisionCandidates)
+{
+	const FVector MyPosition = Position.Value;
+	const FVector Extents = FVector(50.0f);
 
-	// Sort candidates by square distance
-	CollisionCandidates.Sort([MyPosition](const FEntityPositionCache& A, const FEntityPositionCache& B)
+	FBox Bounds(MyPosition - Extents, MyPosition + Extents);
+	FVector Vertex = MyPosition;
+	for(const FVector& Step : Steps)
 	{
-		const float DistanceA = (A.Position - MyPosition).SizeSquared();
-		const float DistanceB = (B.Position - MyPosition).SizeSquared();
+		Vertex += Step * DeltaTime;
+		Bounds += FBox(Vertex - Extents, Vertex + Extents);
+	}
 
-		return DistanceA < DistanceB;
-	});
+	CollisionCandidates.Reset();
+	CollisionSpatialGrid.GetCollidableEntitiesInBox(Entity, Filter, Bounds, CollisionCandidates);
+}
+
+void FCollisionHelper::GatherCandidates(const FColliderTable& ColliderTable, const TArray<FEntityPositionCache>& CollisionCandidates, TArray<int32>& OutColliderIds)
+{
+	OutColliderIds.Reset(CollisionCandidates.Num());
+
+	for(const FEntityPositionCache& Candidate : CollisionCandidates)
+	{
+		OutColliderIds.Add(ColliderTable.IsLiveId(Candidate.ColliderId) ? Candidate.ColliderId : INDEX_NONE);
+	}
 }
 
 bool FCollisionHelper::NarrowPhase(const float DeltaTime, const flecs::entity& Entity, const FCollisionShape& CollisionShape, const FTransformComponent& Transform, const FVector& Velocity,
-	const FAngularVelocity& AngularVelocity, const TArray<FEntityPositionCache>& CollisionCandidates, FPosition& Position, TSet<FNarrowPhaseEntityContact>& NarrowPhaseEntityContacts, float& OutTime)
+	const FAngularVelocity& AngularVelocity, const FColliderTable& ColliderTable, TArray<int32>& CollisionCandidates, int32& InOutHullWarmStartVertex, FPosition& Position,
+	FNarrowPhaseEntityContacts& NarrowPhaseEntityContacts, float& OutTime, FConservativeAdvancementHistogram& Histogram, const bool bAllowBatching)
 {
-	NarrowPhaseEntityContacts.Reset();
-	
 	const FTransform& TargetTransform = Transform.Value;
 	const FVector& TargetAngularVelocity = AngularVelocity.Value;
 	const FTransform TargetFinalTransform = FTransform(TargetTransform.GetRotation() * (TargetAngularVelocity * DeltaTime).ToOrientationQuat(), TargetTransform.GetLocation() + Velocity * DeltaTime);
+	const FVector TargetOrigin = TargetTransform.GetLocation();
+	const bool bIsOverlapOnly = Entity.has<FOverlapCollision>();
+	const FCcdMode* CcdMode = Entity.get<FCcdMode>();
+	const bool bSpeculative = nullptr != CcdMode && CcdMode->Mode == ECcdMode::Speculative;
+	const FConvexHullShape* ConvexHullShape = Entity.get<FConvexHullShape>();
+	const FSupportShape TargetShape = nullptr != ConvexHullShape ? ConvexHullShape->MakeSupportShape(CollisionShape, InOutHullWarmStartVertex) : FSupportShape(CollisionShape);
 
 	OutTime = 1.0f;
 
 	// Print num collision candidates
 	// GEngine->AddOnScreenDebugMessage(-1, 1.f, FColor::Red, FString::Printf(TEXT("Num Collision Candidates: %d"), CollisionCandidates.Num()));
+
+	// Sphere and non-rotating capsule candidates are transposed into SIMD lanes and swept CollisionBatchWidth at a time.
+	FSweptSegment TargetSegment;
+	const bool bCanBatch = bAllowBatching && !bSpeculative && FCollisionBatchHelper::MakeSweptSegment(TargetShape, TargetTransform, Velocity, TargetAngularVelocity, DeltaTime, TargetSegment);
+
+	FSweptSegmentLanes Lanes;
+	Lanes.Reset();
+	int32 LaneCandidates[CollisionBatchWidth];
+
+	auto SweepCandidate = [&](const FColliderProxy& Candidate) -> bool
+	{
+		const FTransform& CandidateTransform = Candidate.Transform;
+		const FTransform CandidateFinalTransform = FTransform(CandidateTransform.GetRotation() * (Candidate.AngularVelocity * DeltaTime).ToOrientationQuat(), CandidateTransform.GetLocation() + Candidate.Velocity * DeltaTime);
+
+		// The proxy is shared with every other worker, so its hull warm start is only updated on a local copy.
+		const FSupportShape CandidateShape = Candidate.Shape;
+
+		const FConservativeAdvancementOutput SweepOutput = bSpeculative
+			? SpeculativeContact(TargetShape, TargetTransform, TargetFinalTransform, CandidateShape, CandidateTransform, CandidateFinalTransform)
+			: ConservativeAdvancement(TargetShape, TargetTransform, TargetFinalTransform, CandidateShape, CandidateTransform, CandidateFinalTransform);
+
+		if(!bSpeculative) { Histogram.Add(SweepOutput.NumIterations); }
+
+		// A sweep that ran out of iterations holds the mover back without touching anything.
+		if(SweepOutput.bStoppedShort) { OutTime = FMath::Min(OutTime, SweepOutput.Time); }
+		if(!SweepOutput.bCollided) { return false; }
+
+		// A hit only blocks when neither side is an overlap-only collider.
+		const bool bIsBlockingHit = !bIsOverlapOnly && !Candidate.bOverlapOnly;
+		NarrowPhaseEntityContacts.Add({
+			.ContactPoint = SweepOutput.ContactPoint,
+			.ContactNormal = SweepOutput.ContactNormal,
+			.EntityHit = Candidate.Entity,
+			.Time = SweepOutput.Time,
+			.bIsBlockingHit = bIsBlockingHit
+		});
+
+		OutTime = FMath::Min(OutTime, SweepOutput.Time);
+		return bIsBlockingHit;
+	};
+
+	auto SweepLanes = [&]() -> bool
+	{
+		FSweptSegmentBatchOutput BatchOutput;
+		FCollisionBatchHelper::SweepSegments(TargetSegment, Lanes, BatchOutput);
+
+		bool bBlocked = false;
+		for(int32 IdxLane = 0; IdxLane < Lanes.Count; ++IdxLane)
+		{
+			const FColliderProxy& Candidate = ColliderTable[LaneCandidates[IdxLane]];
+			const int32 LaneBit = 1 << IdxLane;
+
+			// Lanes that ran out of iterations are handed to the scalar sweep rather than guessed at.
+			if(BatchOutput.UnresolvedMask & LaneBit)
+			{
+				bBlocked |= SweepCandidate(Candidate);
+				continue;
+			}
+
+			// Unresolved lanes are counted by the scalar sweep that settles them.
+			Histogram.Add(BatchOutput.NumIterations[IdxLane]);
+			if(!(BatchOutput.HitMask & LaneBit)) { continue; }
+
+			const float Time = BatchOutput.Time[IdxLane];
+			const bool bIsBlockingHit = !bIsOverlapOnly && !Candidate.bOverlapOnly;
+
+			// Lane points are relative to the mover's start, so they're carried along its sweep to the time of contact.
+			NarrowPhaseEntityContacts.Add({
+				.ContactPoint = TargetOrigin + Velocity * DeltaTime * Time + BatchOutput.GetPoint(IdxLane),
+				.ContactNormal = BatchOutput.GetNormal(IdxLane),
+				.EntityHit = Candidate.Entity,
+				.Time = Time,
+				.bIsBlockingHit = bIsBlockingHit
+			});
+
+			OutTime = FMath::Min(OutTime, Time);
+			bBlocked |= bIsBlockingHit;
+		}
+
+		Lanes.Reset();
+		return bBlocked;
+	};
 	
-	for(const FEntityPositionCache& Candidate : CollisionCandidates)
+	// Candidates are only ordered as far as they're swept: a mover blocked by its nearest neighbour never pays for ordering
+	// the rest.
+	FNearestCandidateHeap NearestCandidates(ColliderTable, CollisionCandidates, TargetOrigin);
+	while(!NearestCandidates.IsEmpty())
 	{
-		FNarrowPhaseEntityContact Contact {
-			.EntityHit = Candidate.Entity
-		};
-		if(Candidate.Entity == Entity || NarrowPhaseEntityContacts.Contains(Contact)) { continue; }
-		
-		const FTransform& CandidateTransform = Candidate.Entity.get<FTransformComponent>()->Value;
-		const FCollisionShape& CandidateShape = *Candidate.Entity.get<FCollisionShape>();
-		const FVector CandidateVelocity = Candidate.Entity.has<FVelocity>() ? Candidate.Entity.get<FVelocity>()->Value : FVector::Zero();
-		const FVector CandidateAngularVelocity = Candidate.Entity.has<FAngularVelocity>() ? Candidate.Entity.get<FAngularVelocity>()->Value : FVector::Zero();
-		const FTransform CandidateFinalTransform = FTransform(CandidateTransform.GetRotation() * (CandidateAngularVelocity * DeltaTime).ToOrientationQuat(), CandidateTransform.GetLocation() + CandidateVelocity * DeltaTime);
+		// Ids without a live proxy come last, so the rest are all dead too.
+		const int32 ColliderId = NearestCandidates.Pop();
+		if(!ColliderTable.IsLiveId(ColliderId)) { break; }
 
-		const FConservativeAdvancementOutput SweepOutput = ConservativeAdvancement(CollisionShape, TargetTransform, TargetFinalTransform, CandidateShape, CandidateTransform, CandidateFinalTransform);
-		
-		if(SweepOutput.bCollided)
+		const FColliderProxy& Candidate = ColliderTable[ColliderId];
+		if(Candidate.Entity == Entity || NarrowPhaseEntityContacts.Contains(Candidate.Entity)) { continue; }
+
+		if(bCanBatch)
 		{
-			const bool bIsBlockingHit = Entity.has<FOverlapCollision>();
-			
+			FSweptSegment CandidateSegment;
+			if(FCollisionBatchHelper::MakeSweptSegment(Candidate.Shape, Candidate.Transform, Candidate.Velocity, Candidate.AngularVelocity, DeltaTime, CandidateSegment))
+			{
+				LaneCandidates[Lanes.Add(FVector3f(Candidate.Transform.GetLocation() - TargetOrigin), CandidateSegment)] = ColliderId;
+
+				// Candidates come nearest-first, so we can stop once a full batch produced a blocking hit.
+				if(Lanes.IsFull() && SweepLanes()) { break; }
+				continue;
+			}
+		}
+
+		// Candidates come nearest-first, so we can break early if we hit a blocking hit.
+		if(SweepCandidate(Candidate)) { break; }
+	}
+
+	if(Lanes.Count > 0)
+	{
+		SweepLanes();
+	}
+
+	InOutHullWarmStartVertex = TargetShape.WarmStartVertex;
+
+	return FMath::IsNearlyEqual(OutTime, 1.0f);
+}
+
+bool FCollisionHelper::SweepPolyline(const float DeltaTime, const flecs::entity& Entity, const FCollisionShape& CollisionShape, const FTransformComponent& Transform,
+	const TConstArrayView<FVector> Steps, const FAngularVelocity& AngularVelocity, const FColliderTable& ColliderTable, const TArray<int32>& CollisionCandidates,
+	int32& InOutHullWarmStartVertex, FNarrowPhaseEntityContacts& NarrowPhaseEntityContacts, FPolylineSweepOutput& Output,
+	FConservativeAdvancementHistogram& Histogram)
+{
+	Output = FPolylineSweepOutput {};
+
+	const int32 NumSegments = Steps.Num();
+	if(NumSegments <= 0) { return true; }
+
+	const bool bIsOverlapOnly = Entity.has<FOverlapCollision>();
+	const FCcdMode* CcdMode = Entity.get<FCcdMode>();
+	const bool bSpeculative = nullptr != CcdMode && CcdMode->Mode == ECcdMode::Speculative;
+	const FConvexHullShape* ConvexHullShape = Entity.get<FConvexHullShape>();
+	const FSupportShape TargetShape = nullptr != ConvexHullShape ? ConvexHullShape->MakeSupportShape(CollisionShape, InOutHullWarmStartVertex) : FSupportShape(CollisionShape);
+
+	const float SegmentDeltaTime = DeltaTime / NumSegments;
+	FTransform SegmentStart = Transform.Value;
+
+	for(int32 IdxSegment = 0; IdxSegment < NumSegments; ++IdxSegment)
+	{
+		FTransform SegmentEnd = AdvanceTransform(SegmentStart, FVector::ZeroVector, AngularVelocity.Value, SegmentDeltaTime);
+		SegmentEnd.AddToTranslation(Steps[IdxSegment] * DeltaTime);
+
+		const float SegmentStartTime = IdxSegment * SegmentDeltaTime;
+		float SegmentHitTime = 1.0f;
+		bool bHit = false;
+
+		for(const int32 ColliderId : CollisionCandidates)
+		{
+			if(!ColliderTable.IsLiveId(ColliderId)) { continue; }
+
+			const FColliderProxy& Candidate = ColliderTable[ColliderId];
+			if(Candidate.Entity == Entity || NarrowPhaseEntityContacts.Contains(Candidate.Entity)) { continue; }
+
+			const FTransform CandidateStart = AdvanceTransform(Candidate.Transform, Candidate.Velocity, Candidate.AngularVelocity, SegmentStartTime);
+			const FTransform CandidateEnd = AdvanceTransform(Candidate.Transform, Candidate.Velocity, Candidate.AngularVelocity, SegmentStartTime + SegmentDeltaTime);
+
+			// Local copy, as in NarrowPhase, so the shared proxy's hull warm start isn't raced on.
+			const FSupportShape CandidateShape = Candidate.Shape;
+
+			const FConservativeAdvancementOutput SweepOutput = bSpeculative
+				? SpeculativeContact(TargetShape, SegmentStart, SegmentEnd, CandidateShape, CandidateStart, CandidateEnd)
+				: ConservativeAdvancement(TargetShape, SegmentStart, SegmentEnd, CandidateShape, CandidateStart, CandidateEnd);
+
+			if(!bSpeculative) { Histogram.Add(SweepOutput.NumIterations); }
+
+			if(SweepOutput.bStoppedShort)
+			{
+				SegmentHitTime = FMath::Min(SegmentHitTime, SweepOutput.Time);
+				bHit = true;
+			}
+			if(!SweepOutput.bCollided) { continue; }
+
+			// Contact times are reported as a fraction of the whole frame, like the single-step narrowphase does.
 			NarrowPhaseEntityContacts.Add({
 				.ContactPoint = SweepOutput.ContactPoint,
 				.ContactNormal = SweepOutput.ContactNormal,
 				.EntityHit = Candidate.Entity,
-				.Time = SweepOutput.Time,
-				.bIsBlockingHit = bIsBlockingHit
+				.Time = (IdxSegment + SweepOutput.Time) / NumSegments,
+				.bIsBlockingHit = !bIsOverlapOnly && !Candidate.bOverlapOnly
 			});
 
-			OutTime = FMath::Min(OutTime, SweepOutput.Time);
-			
-			// Candidates are pre-sorted by distance, so we can break early if we hit a blocking hit.
-			if(bIsBlockingHit) { break; }
+			SegmentHitTime = FMath::Min(SegmentHitTime, SweepOutput.Time);
+			bHit = true;
 		}
+
+		// Like the single-step narrowphase, the move is clamped to the earliest hit of any kind. Unlike it, we can't stop
+		// at the first candidate hit, as candidates are sorted by distance from the start of the polyline rather than from
+		// this segment.
+		if(bHit)
+		{
+			InOutHullWarmStartVertex = TargetShape.WarmStartVertex;
+
+			Output.IdxSegment = IdxSegment;
+			Output.Time = SegmentHitTime;
+			Output.Displacement += Steps[IdxSegment] * DeltaTime * SegmentHitTime;
+			return false;
+		}
+
+		Output.Displacement += Steps[IdxSegment] * DeltaTime;
+		SegmentStart = SegmentEnd;
 	}
 
-	return FMath::IsNearlyEqual(OutTime, 1.0f);
-}
\ No newline at end of file
+	InOutHullWarmStartVertex = TargetShape.WarmStartVertex;
+
+	return true;
+}
@@ -0,0 +1,120 @@
+#include "UECS/CollisionHelper.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+	// Shape mix of the benchmark, roughly what the game spawns: mostly capsules, then spheres, boxes and hulls.
+	struct FBenchmarkShape
+	{
+		const TCHAR* Name;
+		FSupportShape Shape;
+		int32 Weight;
+	};
+
+	struct FBenchmarkPair
+	{
+		int32 IdxShapeA;
+		int32 IdxShapeB;
+		FTransform FromA;
+		FTransform ToA;
+		FTransform FromB;
+		FTransform ToB;
+	};
+
+	FORCEINLINE FTransform MakeRandomTransform(FRandomStream& Random, const FVector& Location)
+	{
+		return FTransform(FRotator(Random.FRandRange(-180.0f, 180.0f), Random.FRandRange(-180.0f, 180.0f), Random.FRandRange(-180.0f, 180.0f)).Quaternion(), Location);
+	}
+
+	double RunBenchmark(const ECollisionKernelPrecision Precision, TConstArrayView<FBenchmarkShape> Shapes, TConstArrayView<FBenchmarkPair> Pairs,
+	                    TArray<FConservativeAdvancementOutput>& OutResults)
+	{
+		OutResults.Reset(Pairs.Num());
+
+		const double StartTime = FPlatformTime::Seconds();
+		for(const FBenchmarkPair& Pair : Pairs)
+		{
+			OutResults.Add(FCollisionHelper::ConservativeAdvancement(Precision,
+				Shapes[Pair.IdxShapeA].Shape, Pair.FromA, Pair.ToA,
+				Shapes[Pair.IdxShapeB].Shape, Pair.FromB, Pair.ToB));
+		}
+		return FPlatformTime::Seconds() - StartTime;
+	}
+
+	void BenchmarkKernels(const TArray<FString>& Args)
+	{
+		const int32 NumPairs = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+		const double WorldOffset = Args.Num() > 1 ? FCString::Atod(*Args[1]) : 1000000.0;
+
+		static const FVector3f HullVertices[] = {
+			FVector3f(-40.0f, -40.0f, -40.0f), FVector3f(40.0f, -40.0f, -40.0f), FVector3f(0.0f, 40.0f, -40.0f),
+			FVector3f(-30.0f, -30.0f, 40.0f), FVector3f(30.0f, -30.0f, 40.0f), FVector3f(0.0f, 30.0f, 40.0f)
+		};
+		static const int32 HullIndices[] = { 0, 2, 1,  3, 4, 5,  0, 1, 4,  0, 4, 3,  1, 2, 5,  1, 5, 4,  2, 0, 3,  2, 3, 5 };
+		const FConvexHullRef Hull = FConvexHullHelper::Build(HullVertices, HullIndices);
+
+		const FBenchmarkShape Shapes[] = {
+			{ TEXT("Capsule"), FSupportShape(FCollisionShape::MakeCapsule(35.0f, 90.0f)), 4 },
+			{ TEXT("Sphere"), FSupportShape(FCollisionShape::MakeSphere(50.0f)), 3 },
+			{ TEXT("Box"), FSupportShape(FCollisionShape::MakeBox(FVector(50.0f, 30.0f, 40.0f))), 2 },
+			{ TEXT("Hull"), FSupportShape(FCollisionShape::MakeBox(FVector(Hull->Extents)), Hull, 0), 1 }
+		};
+
+		TArray<int32> WeightedShapes;
+		for(int32 IdxShape = 0; IdxShape < UE_ARRAY_COUNT(Shapes); ++IdxShape)
+		{
+			for(int32 IdxWeight = 0; IdxWeight < Shapes[IdxShape].Weight; ++IdxWeight) { WeightedShapes.Add(IdxShape); }
+		}
+
+		// Pairs a few hundred units apart closing in on each other, far from the origin, so both paths lose the most precision.
+		FRandomStream Random(0x45435331);
+		TArray<FBenchmarkPair> Pairs;
+		Pairs.Reserve(NumPairs);
+		for(int32 IdxPair = 0; IdxPair < NumPairs; ++IdxPair)
+		{
+			const FVector Center(WorldOffset + Random.FRandRange(-1000.0f, 1000.0f), WorldOffset + Random.FRandRange(-1000.0f, 1000.0f), Random.FRandRange(0.0f, 500.0f));
+			const FVector Offset = Random.GetUnitVector() * Random.FRandRange(100.0f, 300.0f);
+			const FVector Motion = -Offset * Random.FRandRange(0.2f, 1.5f);
+
+			FBenchmarkPair& Pair = Pairs.AddDefaulted_GetRef();
+			Pair.IdxShapeA = WeightedShapes[Random.RandHelper(WeightedShapes.Num())];
+			Pair.IdxShapeB = WeightedShapes[Random.RandHelper(WeightedShapes.Num())];
+			Pair.FromA = MakeRandomTransform(Random, Center + Offset);
+			Pair.ToA = Pair.FromA;
+			Pair.ToA.AddToTranslation(Motion);
+			Pair.FromB = MakeRandomTransform(Random, Center);
+			Pair.ToB = Pair.FromB;
+		}
+
+		TArray<FConservativeAdvancementOutput> DoubleResults;
+		TArray<FConservativeAdvancementOutput> SingleResults;
+
+		// Warm up caches and the hull, then measure.
+		RunBenchmark(ECollisionKernelPrecision::Double, Shapes, Pairs, DoubleResults);
+		const double DoubleTime = RunBenchmark(ECollisionKernelPrecision::Double, Shapes, Pairs, DoubleResults);
+		const double SingleTime = RunBenchmark(ECollisionKernelPrecision::Single, Shapes, Pairs, SingleResults);
+
+		int32 NumHitMismatches = 0;
+		float MaxTimeError = 0.0f;
+		for(int32 IdxPair = 0; IdxPair < Pairs.Num(); ++IdxPair)
+		{
+			if(DoubleResults[IdxPair].bCollided != SingleResults[IdxPair].bCollided)
+			{
+				++NumHitMismatches;
+				continue;
+			}
+
+			MaxTimeError = FMath::Max(MaxTimeError, FMath::Abs(DoubleResults[IdxPair].Time - SingleResults[IdxPair].Time));
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Collision kernels, %d pairs at %.0f from the origin: double %.2f ms, single %.2f ms (%.2fx). %d hit mismatches, max time error %f."),
+			NumPairs, WorldOffset, DoubleTime * 1000.0, SingleTime * 1000.0, SingleTime > 0.0 ? DoubleTime / SingleTime : 0.0, NumHitMismatches, MaxTimeError);
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkCollisionKernels(
+	TEXT("ecs.Collision.BenchmarkKernels"),
+	TEXT("Times conservative advancement in double and single precision over a mix of shapes. Args: [NumPairs] [WorldOffset]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkKernels));
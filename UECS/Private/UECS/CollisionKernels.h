@@ -0,0 +1,556 @@
+#pragma once
+
+#include "UECS/CollisionHelper.h"
+
+// GJK and conservative advancement kernels, generic over the scalar type. FCollisionHelper runs them in doubles on world
+// space transforms, or in floats on transforms rebased onto an origin next to the pair being tested.
+template<typename T>
+struct TCollisionKernels
+{
+	using FVec = UE::Math::TVector<T>;
+	using FXform = UE::Math::TTransform<T>;
+	using FSimplexT = TSimplex<T>;
+	using FCollisionOutputT = TCollisionOutput<T>;
+	using FConservativeAdvancementOutputT = TConservativeAdvancementOutput<T>;
+
+	static FXform LerpTransform(const FXform& Start, const FXform& End, const T Alpha)
+	{
+		FXform Result;
+
+		Result.SetTranslation(FMath::Lerp(Start.GetTranslation(), End.GetTranslation(), Alpha));
+		Result.SetRotation(UE::Math::TQuat<T>::Slerp(Start.GetRotation(), End.GetRotation(), Alpha));
+		Result.SetScale3D(FMath::Lerp(Start.GetScale3D(), End.GetScale3D(), Alpha));
+
+		return Result;
+	}
+
+	static FVec Support(const FSupportShape& SupportShape, const FXform& Transform, const FVec& Direction)
+	{
+		if(SupportShape.Hull.IsValid())
+		{
+			// The support of a scaled hull along D is the scaled support of the unscaled hull along Scale * D.
+			const FVec LocalDirection = Transform.InverseTransformVectorNoScale(Direction) * Transform.GetScale3D();
+			const int32 IdxVertex = FConvexHullHelper::FindSupportVertex(*SupportShape.Hull, FVector3f(LocalDirection), SupportShape.WarmStartVertex);
+			if(IdxVertex == INDEX_NONE) { return Transform.GetTranslation(); }
+
+			SupportShape.WarmStartVertex = IdxVertex;
+			return Transform.TransformPosition(FVec(SupportShape.Hull->Vertices[IdxVertex]));
+		}
+
+		const FCollisionShape& Shape = SupportShape.Shape;
+		switch (Shape.ShapeType)
+		{
+		case ECollisionShape::Box:
+			{
+				const FVec X = Transform.GetScaledAxis(EAxis::X);
+				const FVec Y = Transform.GetScaledAxis(EAxis::Y);
+				const FVec Z = Transform.GetScaledAxis(EAxis::Z);
+
+				const FVec HalfExtents = FVec(Shape.GetExtent()) * Transform.GetScale3D();
+
+				return (X * FMath::Sign(X.Dot(Direction)) * HalfExtents.X)
+					+ (Y * FMath::Sign(Y.Dot(Direction)) * HalfExtents.Y)
+					+ (Z * FMath::Sign(Z.Dot(Direction)) * HalfExtents.Z)
+					+ Transform.GetTranslation();
+			}
+
+		case ECollisionShape::Sphere:
+			return Direction * static_cast<T>(Shape.GetSphereRadius()) * Transform.GetMaximumAxisScale() + Transform.GetTranslation();
+
+		case ECollisionShape::Capsule:
+			{
+				const FVec CapsuleAxis = Transform.GetScaledAxis(EAxis::Z);
+				const T HalfLength = Shape.GetCapsuleHalfHeight();
+				const T Radius = Shape.GetCapsuleRadius();
+
+				return Transform.GetTranslation()
+					+ CapsuleAxis * (HalfLength * FMath::Sign(CapsuleAxis.Dot(Direction)))
+					+ Direction.GetSafeNormal()
+					* Radius;
+			}
+
+		default:
+			return FVec::ZeroVector;
+		}
+	}
+
+	FORCEINLINE static bool SameDirection(const FVec& A, const FVec& B)
+	{
+		return A.Dot(B) > 0;
+	}
+
+	static FVec SolveSimplex2(FSimplexT& Simplex, FVec& OutDirection)
+	{
+		const FVec Ab = Simplex.B - Simplex.A;
+		const FVec Ao = -Simplex.A;
+
+		if (SameDirection(Ab, Ao))
+		{
+			// The origin falls on the line.
+			// Project the origin onto the line and return.
+			const T Time = FVec::DotProduct(Ao, Ab) / FVec::DotProduct(Ab, Ab);
+			OutDirection = FVec::CrossProduct(FVec::CrossProduct(Ab, Ao), Ab);
+			return Simplex.A + Time * Ab;
+		}
+
+		// The origin is closer to A.
+		Simplex.Count = 1;
+		OutDirection = Ao;
+		return Simplex.A;
+	}
+
+	static FVec SolveSimplex3(FSimplexT& Simplex, FVec& OutDirection)
+	{
+		const FVec Abc = FVec::CrossProduct(Simplex.B - Simplex.A, Simplex.C - Simplex.A);
+		const FVec Ac = Simplex.C - Simplex.A;
+		const FVec Ao = -Simplex.A;
+
+		if (SameDirection(FVec::CrossProduct(Abc, Ac), Ao))
+		{
+			if (SameDirection(Ac, Ao))
+			{
+				// The origin is nearest to the line AC
+				Simplex.B = Simplex.C;
+				Simplex.Count = 2;
+				const T Time = FVec::DotProduct(Ao, Ac) / FVec::DotProduct(Ac, Ac);
+				OutDirection = FVec::CrossProduct(FVec::CrossProduct(Ac, Ao), Ac);
+				return Simplex.A + Time * Ac;
+			}
+
+			const FVec Ab = Simplex.B - Simplex.A;
+			if (SameDirection(Ab, Ao))
+			{
+				// The origin is nearest to the line AB
+				Simplex.Count = 2;
+				const T Time = FVec::DotProduct(Ao, Ab) / FVec::DotProduct(Ab, Ab);
+				OutDirection = FVec::CrossProduct(FVec::CrossProduct(Ab, Ao), Ab);
+				return Simplex.A + Time * Ab;
+			}
+
+			// The origin is nearest to the point A
+			Simplex.Count = 1;
+			OutDirection = Ao;
+			return Simplex.A;
+		}
+
+		const FVec Ab = Simplex.B - Simplex.A;
+		if (SameDirection(FVec::CrossProduct(Ab, Abc), Ao))
+		{
+			if (SameDirection(Ab, Ao))
+			{
+				// The origin is nearest to the line AB
+				Simplex.Count = 2;
+				const T Time = FVec::DotProduct(Ao, Ab) / FVec::DotProduct(Ab, Ab);
+				OutDirection = FVec::CrossProduct(FVec::CrossProduct(Ab, Ao), Ab);
+				return Simplex.A + Time * Ab;
+			}
+
+			// The origin is nearest to the point A
+			Simplex.Count = 1;
+			OutDirection = Ao;
+			return Simplex.A;
+		}
+
+		if (SameDirection(Abc, Ao))
+		{
+			// The origin is nearest to the triangle ABC
+			OutDirection = Abc;
+			return ClosestPointOnTriangle(Simplex.A, Simplex.B, Simplex.C, Ab, Ac, Ao);
+		}
+
+		// The origin is nearest to the triangle ACB
+		Swap(Simplex.B, Simplex.C);
+		Swap(Simplex.B1, Simplex.C1);
+		Swap(Simplex.B2, Simplex.C2);
+
+		// Only the winding kept for the next iteration flips. The closest point is the same as for ABC, so it's taken from
+		// the unswapped vertices, which now sit in C and B, and the edges computed from them.
+		OutDirection = -Abc;
+		return ClosestPointOnTriangle(Simplex.A, Simplex.C, Simplex.B, Ab, Ac, Ao);
+	}
+
+	static FVec SolveSimplex4(FSimplexT& Simplex, FVec& OutDirection)
+	{
+		const FVec Abc = FVec::CrossProduct(Simplex.B - Simplex.A, Simplex.C - Simplex.A);
+		const FVec Acd = FVec::CrossProduct(Simplex.C - Simplex.A, Simplex.D - Simplex.A);
+		const FVec Adb = FVec::CrossProduct(Simplex.D - Simplex.A, Simplex.B - Simplex.A);
+		const FVec Ao = -Simplex.A;
+
+		const bool bSameAbcDir = SameDirection(Abc, Ao);
+		const bool bSameAcdDir = SameDirection(Acd, Ao);
+		const bool bSameAdbDir = SameDirection(Adb, Ao);
+
+		if (!bSameAbcDir && !bSameAcdDir && !bSameAdbDir)
+		{
+			OutDirection = FVec(0, 0, 0);
+			return FVec(0, 0, 0);
+		}
+
+		if (bSameAbcDir && !bSameAcdDir && !bSameAdbDir)
+		{
+			Simplex.Count = 3;
+			return SolveSimplex3(Simplex, OutDirection);
+		}
+
+		if (!bSameAbcDir && bSameAcdDir && !bSameAdbDir)
+		{
+			Simplex.B = Simplex.C;
+			Simplex.C = Simplex.D;
+			Simplex.Count = 3;
+			return SolveSimplex3(Simplex, OutDirection);
+		}
+
+		if (!bSameAbcDir && !bSameAcdDir && bSameAdbDir)
+		{
+			Simplex.C = Simplex.B;
+			Simplex.B = Simplex.D;
+			Simplex.Count = 3;
+			return SolveSimplex3(Simplex, OutDirection);
+		}
+
+		// The origin potentially falls on multiple triangles.
+		FSimplexT SimplexAbc = Simplex;
+		SimplexAbc.Count = 3;
+
+		FSimplexT SimplexAcd = Simplex;
+		SimplexAcd.B = SimplexAcd.C;
+		SimplexAcd.C = SimplexAcd.D;
+		SimplexAcd.Count = 3;
+
+		FSimplexT SimplexAdb = Simplex;
+		SimplexAdb.C = SimplexAdb.B;
+		SimplexAdb.B = SimplexAdb.D;
+		SimplexAdb.Count = 3;
+
+		FVec DirAbc, DirAcd, DirAdb;
+
+		const FVec PAbc = SolveSimplex3(SimplexAbc, DirAbc);
+		const FVec PAcd = SolveSimplex3(SimplexAcd, DirAcd);
+		const FVec PAdb = SolveSimplex3(SimplexAdb, DirAdb);
+
+		const T AbcD2 = FVec::DotProduct(PAbc, PAbc);
+		const T AcdD2 = FVec::DotProduct(PAcd, PAcd);
+		const T AdbD2 = FVec::DotProduct(PAdb, PAdb);
+
+		if (AbcD2 <= AcdD2 && AbcD2 <= AdbD2)
+		{
+			Simplex = SimplexAbc;
+			OutDirection = DirAbc;
+			return PAbc;
+		}
+
+		if (AcdD2 <= AbcD2 && AcdD2 <= AdbD2)
+		{
+			Simplex = SimplexAcd;
+			OutDirection = DirAcd;
+			return PAcd;
+		}
+
+		Simplex = SimplexAdb;
+		OutDirection = DirAdb;
+		return PAdb;
+	}
+
+	FORCEINLINE static T TriangleArea2D(const T X1, const T Y1, const T X2, const T Y2, const T X3, const T Y3)
+	{
+		return (X1 - X2) * (Y2 - Y3) - (X2 - X3) * (Y1 - Y2);
+	}
+
+	static FVec GetBarycentricCoordsTriangle(const FVec& A, const FVec& B, const FVec& C, const FVec& P)
+	{
+		const FVec Abc = FVec::CrossProduct(B - A, C - A);
+
+		T Nu, Nv, Ood;
+
+		const T X = FMath::Abs(Abc.X);
+		const T Y = FMath::Abs(Abc.Y);
+		const T Z = FMath::Abs(Abc.Z);
+
+		if (X >= Y && X >= Z)
+		{
+			// X is the largest, so project onto the YZ plane.
+			Nu = TriangleArea2D(P.Y, P.Z, B.Y, B.Z, C.Y, C.Z);
+			Nv = TriangleArea2D(P.Y, P.Z, C.Y, C.Z, A.Y, A.Z);
+			Ood = 1 / Abc.X;
+		}
+		else if (Y >= X && Y >= Z)
+		{
+			// Y is the largest, so project onto the XZ plane.
+			Nu = TriangleArea2D(P.X, P.Z, B.X, B.Z, C.X, C.Z);
+			Nv = TriangleArea2D(P.X, P.Z, C.X, C.Z, A.X, A.Z);
+			Ood = 1 / -Abc.Y; // Negated because of the coordinate system orientation
+		}
+		else
+		{
+			// Z is the largest, so project onto the XY plane.
+			Nu = TriangleArea2D(P.X, P.Y, B.X, B.Y, C.X, C.Y);
+			Nv = TriangleArea2D(P.X, P.Y, C.X, C.Y, A.X, A.Y);
+			Ood = 1 / Abc.Z;
+		}
+
+		return FVec(Nu * Ood, Nv * Ood, 1 - Nu * Ood - Nv * Ood);
+	}
+
+	static T GetBarycentricScalarLine(const FVec& A, const FVec& B, const FVec& P)
+	{
+		const FVec AB = B - A;
+		const FVec AP = P - A;
+		return FVec::DotProduct(AP, AB) / FVec::DotProduct(AB, AB);
+	}
+
+	static TTuple<FVec, FVec> GetLocalPoints(const FSimplexT& Simplex, const FVec& Point)
+	{
+		switch(Simplex.Count)
+		{
+		case 1:
+			return { Simplex.A1, Simplex.A2 };
+		case 2:
+			{
+				const T Barycentric = GetBarycentricScalarLine(Simplex.A, Simplex.B, Point);
+				return { FMath::Lerp(Simplex.A1, Simplex.B1, Barycentric), FMath::Lerp(Simplex.A2, Simplex.B2, Barycentric) };
+			}
+		case 3:
+			{
+				const FVec Barycentric = GetBarycentricCoordsTriangle(Simplex.A, Simplex.B, Simplex.C, Point);
+				return {
+					Simplex.A1 * Barycentric.X + Simplex.B1 * Barycentric.Y + Simplex.C1 * Barycentric.Z,
+					Simplex.A2 * Barycentric.X + Simplex.B2 * Barycentric.Y + Simplex.C2 * Barycentric.Z
+				};
+			}
+		default:
+			return { FVec::ZeroVector, FVec::ZeroVector };
+		}
+	}
+
+	static FCollisionOutputT GJK(const FSupportShape& ShapeA, const FXform& TransformA, const FSupportShape& ShapeB, const FXform& TransformB)
+	{
+		FSimplexT Simplex;
+		const FVec Dir = (TransformB.GetLocation() - TransformA.GetLocation()).GetSafeNormal();
+
+		Simplex.A1 = Support(ShapeA, TransformA, -Dir);
+		Simplex.A2 = Support(ShapeB, TransformB, Dir);
+		Simplex.A = Simplex.A2 - Simplex.A1;
+		Simplex.Count = 1;
+
+		FSimplexT BestSimplex;
+		T BestSupportDifference = -std::numeric_limits<T>::infinity();
+		FVec BestPointOnSimplex;
+
+		for(int32 IdxIter = 0; IdxIter < 32; ++IdxIter)
+		{
+			FVec PointOnSimplex;
+			FVec Direction;
+
+			switch(Simplex.Count)
+			{
+			case 1:
+				PointOnSimplex = Simplex.A;
+				Direction = -Simplex.A;
+				break;
+			case 2:
+				PointOnSimplex = SolveSimplex2(Simplex, Direction);
+				break;
+			case 3:
+				PointOnSimplex = SolveSimplex3(Simplex, Direction);
+				break;
+			case 4:
+				PointOnSimplex = SolveSimplex4(Simplex, Direction);
+				break;
+			default:
+				check(false);
+			}
+
+			Direction.Normalize();
+
+			// Early-out to avoid FPU imprecision issues. We're close enough to 0, so it's good enough.
+			if(PointOnSimplex.Length() < KINDA_SMALL_NUMBER)
+			{
+				const TTuple<FVec, FVec> BestPoints = GetLocalPoints(Simplex, PointOnSimplex);
+				return FCollisionOutputT
+				{
+					.bDidOverlap = true,
+					.Distance = 0.0f,
+					.ClosestA = BestPoints.Key,
+					.ClosestB = BestPoints.Value,
+					.Normal = -Direction.GetSafeNormal()
+				};
+			}
+
+			const FVec SupportA = Support(ShapeA, TransformA, -Direction);
+			const FVec SupportB = Support(ShapeB, TransformB, Direction);
+			const FVec SupportAB = SupportB - SupportA;
+
+			const T PDotDir = PointOnSimplex.Dot(Direction);
+			const T SupportDotDir = SupportAB.Dot(Direction) - KINDA_SMALL_NUMBER;
+
+			// Detect if PointOnSimplex is more extreme than the Support point. In this case, we can't have a better support point.
+			if(PDotDir >= SupportDotDir)
+			{
+				const TTuple<FVec, FVec> BestPoints = GetLocalPoints(Simplex, PointOnSimplex);
+				return FCollisionOutputT
+				{
+					.bDidOverlap = false,
+					.Distance = static_cast<float>(PointOnSimplex.Length()),
+					.ClosestA = BestPoints.Key,
+					.ClosestB = BestPoints.Value,
+					.Normal = -Direction.GetSafeNormal()
+				};
+			}
+
+			const T SupportDifference = SupportDotDir - PDotDir;
+			if(SupportDifference > BestSupportDifference)
+			{
+				BestSupportDifference = SupportDifference;
+				BestSimplex = Simplex;
+				BestPointOnSimplex = PointOnSimplex;
+			}
+
+			check(Simplex.Count < 4);
+
+			Simplex.ShufflePoints(SupportA, SupportB, SupportAB);
+			++Simplex.Count;
+		}
+
+		const TTuple<FVec, FVec> BestPoints = GetLocalPoints(BestSimplex, BestPointOnSimplex);
+		return FCollisionOutputT
+		{
+			.bDidOverlap = false,
+			.Distance = static_cast<float>(BestPointOnSimplex.Length()),
+			.ClosestA = BestPoints.Key,
+			.ClosestB = BestPoints.Value,
+			.Normal = -BestPointOnSimplex.GetSafeNormal()
+		};
+	}
+
+	static FConservativeAdvancementOutputT ConservativeAdvancement(const FSupportShape& ShapeA, const FXform& TransformFromA, const FXform& TransformToA,
+	                                                               const FSupportShape& ShapeB, const FXform& TransformFromB, const FXform& TransformToB)
+	{
+		FConservativeAdvancementOutputT Output;
+
+		FCollisionOutputT GJKOutput = GJK(ShapeA, TransformFromA, ShapeB, TransformFromB);
+		Output.bInitialOverlap = GJKOutput.bDidOverlap;
+
+		if (GJKOutput.bDidOverlap)
+		{
+			Output.bCollided = true;
+			Output.Time = 0.0f;
+			return Output;
+		}
+
+		const FVec LinearVelocityA = TransformToA.GetTranslation() - TransformFromA.GetTranslation();
+		const FVec LinearVelocityB = TransformToB.GetTranslation() - TransformFromB.GetTranslation();
+		const FVec RelativeLinearVelocity = LinearVelocityA - LinearVelocityB;
+
+		const T AngularVelocityA = TransformToA.GetRotation().AngularDistance(TransformFromA.GetRotation());
+		const T AngularVelocityB = TransformToB.GetRotation().AngularDistance(TransformFromB.GetRotation());
+
+		const T BoundingRadiusA = FCollisionHelper::GetBoundingRadius(ShapeA, TransformFromA);
+		const T BoundingRadiusB = FCollisionHelper::GetBoundingRadius(ShapeB, TransformFromB);
+		const T MaxAngularProjectedVelocity = AngularVelocityA * BoundingRadiusA + AngularVelocityB * BoundingRadiusB;
+		const T TotalMovement = RelativeLinearVelocity.Length();
+
+		if (FMath::IsNearlyZero(TotalMovement))
+		{
+			Output.Time = 1.0f; // No relative movement; they will never touch during this step.
+			return Output;
+		}
+
+		T Lambda = 0;
+		T NDotVel = RelativeLinearVelocity.Dot(GJKOutput.Normal);
+
+		while (GJKOutput.Distance > KINDA_SMALL_NUMBER)
+		{
+			// Every step so far was safe, so stopping at the current time can't tunnel. No contact has been reached yet,
+			// so none is reported.
+			if(Output.NumIterations >= FCollisionHelper::MaxConservativeAdvancementIterations)
+			{
+				Output.Time = Lambda;
+				Output.bStoppedShort = true;
+				return Output;
+			}
+
+			++Output.NumIterations;
+
+			if(NDotVel + MaxAngularProjectedVelocity <= SMALL_NUMBER)
+			{
+				Output.Time = 1.0f;
+				return Output;
+			}
+
+			const T DeltaLambda = GJKOutput.Distance / (NDotVel + MaxAngularProjectedVelocity);
+			Lambda += DeltaLambda;
+
+			if(Lambda < 0 || Lambda > 1 || DeltaLambda <= 0)
+			{
+				Output.Time = 1.0f;
+				return Output;
+			}
+
+			GJKOutput = GJK(ShapeA, LerpTransform(TransformFromA, TransformToA, Lambda), ShapeB, LerpTransform(TransformFromB, TransformToB, Lambda));
+			NDotVel = RelativeLinearVelocity.Dot(GJKOutput.Normal);
+			if(GJKOutput.bDidOverlap)
+			{
+				Output.Time = Lambda;
+				Output.bCollided = true;
+				Output.ContactNormal = GJKOutput.Normal;
+				Output.ContactPoint = GJKOutput.ClosestA;
+				return Output;
+			}
+		}
+
+		Output.Time = 1.0f;
+		return Output;
+	}
+
+	static FConservativeAdvancementOutputT SpeculativeContact(const FSupportShape& ShapeA, const FXform& TransformFromA, const FXform& TransformToA,
+	                                                          const FSupportShape& ShapeB, const FXform& TransformFromB, const FXform& TransformToB)
+	{
+		FConservativeAdvancementOutputT Output;
+		Output.Time = 1.0f;
+
+		const FCollisionOutputT GJKOutput = GJK(ShapeA, TransformFromA, ShapeB, TransformFromB);
+		Output.bInitialOverlap = GJKOutput.bDidOverlap;
+
+		if(GJKOutput.bDidOverlap)
+		{
+			Output.bCollided = true;
+			Output.Time = 0.0f;
+			return Output;
+		}
+
+		const FVec RelativeLinearVelocity = (TransformToA.GetTranslation() - TransformFromA.GetTranslation()) - (TransformToB.GetTranslation() - TransformFromB.GetTranslation());
+		const T AngularVelocityA = TransformToA.GetRotation().AngularDistance(TransformFromA.GetRotation());
+		const T AngularVelocityB = TransformToB.GetRotation().AngularDistance(TransformFromB.GetRotation());
+		const T MaxAngularProjectedVelocity = AngularVelocityA * FCollisionHelper::GetBoundingRadius(ShapeA, TransformFromA) + AngularVelocityB * FCollisionHelper::GetBoundingRadius(ShapeB, TransformFromB);
+
+		// Upper bound of how much of the gap can be closed during the step.
+		const T Approach = RelativeLinearVelocity.Dot(GJKOutput.Normal) + MaxAngularProjectedVelocity;
+		if(Approach <= SMALL_NUMBER || Approach < GJKOutput.Distance) { return Output; }
+
+		Output.bCollided = true;
+		Output.Time = FMath::Clamp(static_cast<float>(GJKOutput.Distance / Approach), 0.0f, 1.0f);
+		Output.ContactNormal = GJKOutput.Normal;
+		Output.ContactPoint = GJKOutput.ClosestA;
+		return Output;
+	}
+
+private:
+	// Closest point to the origin on the triangle ABC, with the origin known to be in front of its face. Ab and Ac must be
+	// the edges from A to B and to C; the barycentric weights pair each edge with the dot products of its own vertex.
+	FORCEINLINE static FVec ClosestPointOnTriangle(const FVec& A, const FVec& B, const FVec& C, const FVec& Ab, const FVec& Ac, const FVec& Ao)
+	{
+		const FVec Bo = -B;
+		const FVec Co = -C;
+		const T D1 = FVec::DotProduct(Ab, Ao);
+		const T D2 = FVec::DotProduct(Ac, Ao);
+		const T D3 = FVec::DotProduct(Ab, Bo);
+		const T D4 = FVec::DotProduct(Ac, Bo);
+		const T D5 = FVec::DotProduct(Ab, Co);
+		const T D6 = FVec::DotProduct(Ac, Co);
+		const T Va = D3 * D6 - D5 * D4;
+		const T Vb = D5 * D2 - D1 * D6;
+		const T Vc = D1 * D4 - D3 * D2;
+		const T Denom = 1 / (Va + Vb + Vc);
+		return A + (Vb * Denom) * Ab + (Vc * Denom) * Ac;
+	}
+};
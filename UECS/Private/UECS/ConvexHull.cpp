@@ -0,0 +1,138 @@
+#include "UECS/ConvexHull.h"
+
+#include "Engine/StaticMesh.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "PhysicsEngine/ConvexElem.h"
+
+void FConvexHullData::UpdateBounds()
+{
+	BoundingRadius = 0.0f;
+
+	FBox3f Bounds(ForceInit);
+	for(const FVector3f& Vertex : Vertices)
+	{
+		Bounds += Vertex;
+		BoundingRadius = FMath::Max(BoundingRadius, Vertex.Size());
+	}
+
+	Extents = Bounds.IsValid ? Bounds.GetExtent() : FVector3f::ZeroVector;
+}
+
+FConvexHullRef FConvexHullHelper::Build(const TConstArrayView<FVector3f> Vertices, const TConstArrayView<int32> Indices)
+{
+	const TSharedRef<FConvexHullData, ESPMode::ThreadSafe> Hull = MakeShared<FConvexHullData, ESPMode::ThreadSafe>();
+	Hull->VertexStorage.Append(Vertices.GetData(), Vertices.Num());
+	BuildAdjacency(Vertices.Num(), Indices, Hull->AdjacencyOffsetStorage, Hull->AdjacencyStorage);
+
+	Hull->Vertices = Hull->VertexStorage;
+	Hull->AdjacencyOffsets = Hull->AdjacencyOffsetStorage;
+	Hull->Adjacency = Hull->AdjacencyStorage;
+	Hull->UpdateBounds();
+
+	return Hull;
+}
+
+void FConvexHullHelper::BuildAdjacency(const int32 NumVertices, const TConstArrayView<int32> Indices, TArray<int32>& OutOffsets, TArray<int32>& OutAdjacency)
+{
+	OutOffsets.Reset();
+	OutAdjacency.Reset();
+
+	if(Indices.Num() < 3) { return; }
+
+	// Collect the unique neighbours of every vertex from the triangle edges.
+	TArray<TArray<int32, TInlineAllocator<8>>> Neighbours;
+	Neighbours.SetNum(NumVertices);
+	for(int32 IdxTriangle = 0; IdxTriangle + 2 < Indices.Num(); IdxTriangle += 3)
+	{
+		for(int32 IdxCorner = 0; IdxCorner < 3; ++IdxCorner)
+		{
+			const int32 From = Indices[IdxTriangle + IdxCorner];
+			const int32 To = Indices[IdxTriangle + (IdxCorner + 1) % 3];
+			if(From < 0 || From >= NumVertices || To < 0 || To >= NumVertices || From == To) { continue; }
+
+			Neighbours[From].AddUnique(To);
+			Neighbours[To].AddUnique(From);
+		}
+	}
+
+	OutOffsets.Reserve(NumVertices + 1);
+	for(const TArray<int32, TInlineAllocator<8>>& VertexNeighbours : Neighbours)
+	{
+		OutOffsets.Add(OutAdjacency.Num());
+		OutAdjacency.Append(VertexNeighbours);
+	}
+	OutOffsets.Add(OutAdjacency.Num());
+}
+
+TArray<FConvexHullRef> FConvexHullHelper::BakeFromStaticMesh(const UStaticMesh* StaticMesh)
+{
+	TArray<FConvexHullRef> Hulls;
+	if(nullptr == StaticMesh || nullptr == StaticMesh->GetBodySetup()) { return Hulls; }
+
+	TArray<FVector3f> Vertices;
+	for(const FKConvexElem& ConvexElem : StaticMesh->GetBodySetup()->AggGeom.ConvexElems)
+	{
+		if(ConvexElem.VertexData.Num() <= 0) { continue; }
+
+		const FTransform ElemTransform = ConvexElem.GetTransform();
+
+		Vertices.Reset(ConvexElem.VertexData.Num());
+		for(const FVector& Vertex : ConvexElem.VertexData)
+		{
+			Vertices.Add(FVector3f(ElemTransform.TransformPosition(Vertex)));
+		}
+
+		Hulls.Add(Build(Vertices, ConvexElem.IndexData));
+	}
+
+	return Hulls;
+}
+
+int32 FConvexHullHelper::FindSupportVertex(const FConvexHullData& Hull, const FVector3f& LocalDirection, const int32 StartVertex)
+{
+	const int32 NumVertices = Hull.Num();
+	if(NumVertices <= 0) { return INDEX_NONE; }
+
+	if(!Hull.HasAdjacency())
+	{
+		int32 IdxBest = 0;
+		float BestDot = Hull.Vertices[0] | LocalDirection;
+		for(int32 IdxVertex = 1; IdxVertex < NumVertices; ++IdxVertex)
+		{
+			const float Dot = Hull.Vertices[IdxVertex] | LocalDirection;
+			if(Dot > BestDot)
+			{
+				BestDot = Dot;
+				IdxBest = IdxVertex;
+			}
+		}
+
+		return IdxBest;
+	}
+
+	int32 IdxCurrent = Hull.Vertices.IsValidIndex(StartVertex) ? StartVertex : 0;
+	float CurrentDot = Hull.Vertices[IdxCurrent] | LocalDirection;
+
+	// On a convex hull a vertex with no better neighbour is the global maximum. The step cap only guards against
+	// malformed adjacency.
+	for(int32 IdxStep = 0; IdxStep < NumVertices; ++IdxStep)
+	{
+		int32 IdxBestNeighbour = INDEX_NONE;
+		for(int32 IdxAdjacency = Hull.AdjacencyOffsets[IdxCurrent]; IdxAdjacency < Hull.AdjacencyOffsets[IdxCurrent + 1]; ++IdxAdjacency)
+		{
+			const int32 IdxNeighbour = Hull.Adjacency[IdxAdjacency];
+			const float Dot = Hull.Vertices[IdxNeighbour] | LocalDirection;
+			if(Dot > CurrentDot)
+			{
+				CurrentDot = Dot;
+				IdxBestNeighbour = IdxNeighbour;
+			}
+		}
+
+		if(IdxBestNeighbour == INDEX_NONE) { break; }
+
+		IdxCurrent = IdxBestNeighbour;
+	}
+
+	return IdxCurrent;
+}
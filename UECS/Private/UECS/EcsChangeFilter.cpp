@@ -0,0 +1,14 @@
+#include "UECS/EcsChangeFilter.h"
+
+#include "UECS/flecs.h"
+
+bool FEcsChangeFilter::ShouldProcess(flecs::iter& Iterator, const bool bForce)
+{
+	++NumTables;
+
+	if(!bEnabled || bForce || Iterator.changed()) { return true; }
+
+	Iterator.skip();
+	++NumSkippedTables;
+	return false;
+}
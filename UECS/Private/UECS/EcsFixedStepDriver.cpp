@@ -0,0 +1,97 @@
+#include "UECS/EcsFixedStepDriver.h"
+
+#include "FlecsLibrary.h"
+#include "UECS/flecs.h"
+#include "UECS/Components/BaseComponents.h"
+#include "UECS/Components/FixedStepClock.h"
+#include "UECS/Components/PreviousPosition.h"
+
+DECLARE_CYCLE_STAT(TEXT("FixedStep"), CS_FIXED_STEP, STATGROUP_ECS)
+
+FEcsFixedStepDriver::FEcsFixedStepDriver(flecs::world& InWorld, const float InFixedDeltaTime, const int32 InMaxStepsPerFrame)
+	: World(InWorld), MaxStepsPerFrame(FMath::Max(InMaxStepsPerFrame, 1))
+{
+	TickDebt.TickInterval = FMath::Max(InFixedDeltaTime, KINDA_SMALL_NUMBER);
+
+	QueryPreviousPositions = new flecs::query(World.query_builder<const FPosition, FPreviousPosition>()
+		.term<FPosition>().in().self()
+		.term<FPreviousPosition>().out().self()
+		.build());
+
+	// Entities start at rest where they were added instead of blending in from the origin.
+	World.observer<const FPosition, FPreviousPosition>()
+		.term_at(1).filter()
+		.event(flecs::OnAdd)
+		.each([](const FPosition& Position, FPreviousPosition& PreviousPosition)
+		{
+			PreviousPosition.Value = Position.Value;
+		});
+
+	PublishClock();
+}
+
+FEcsFixedStepDriver::~FEcsFixedStepDriver()
+{
+	delete QueryPreviousPositions;
+}
+
+void FEcsFixedStepDriver::AddStep(const TCHAR* Name, FStepFunction Function)
+{
+	Steps.Add({ .Name = Name, .Function = MoveTemp(Function) });
+}
+
+int32 FEcsFixedStepDriver::Advance(const float DeltaTime)
+{
+	TickDebt.AddDebt(FMath::Max(DeltaTime, 0.0f), 1);
+	NumDroppedSteps += TickDebt.ClampTicks(MaxStepsPerFrame);
+
+	int32 NumStepsRun = 0;
+	while(TickDebt.ConsumeTick())
+	{
+		SCOPE_CYCLE_COUNTER(CS_FIXED_STEP)
+
+		SnapshotPreviousPositions();
+		for(const FStep& Step : Steps)
+		{
+			Step.Function(TickDebt.TickInterval, World);
+		}
+
+		++NumSteps;
+		++NumStepsRun;
+	}
+
+	PublishClock();
+	return NumStepsRun;
+}
+
+void FEcsFixedStepDriver::SetFixedDeltaTime(const float InFixedDeltaTime)
+{
+	// Leftover debt is real time already owed, so it carries over to the new interval.
+	TickDebt.TickInterval = FMath::Max(InFixedDeltaTime, KINDA_SMALL_NUMBER);
+	PublishClock();
+}
+
+void FEcsFixedStepDriver::SetMaxStepsPerFrame(const int32 InMaxStepsPerFrame)
+{
+	MaxStepsPerFrame = FMath::Max(InMaxStepsPerFrame, 1);
+}
+
+void FEcsFixedStepDriver::SnapshotPreviousPositions() const
+{
+	QueryPreviousPositions->iter(World, [](const flecs::iter& Iterator, const FPosition* Position, FPreviousPosition* PreviousPosition)
+	{
+		for(const auto IdxEntity : Iterator)
+		{
+			PreviousPosition[IdxEntity].Value = Position[IdxEntity].Value;
+		}
+	});
+}
+
+void FEcsFixedStepDriver::PublishClock() const
+{
+	World.set<FFixedStepClock>({
+		.FixedDeltaTime = TickDebt.TickInterval,
+		.Alpha = TickDebt.GetAlpha(),
+		.NumSteps = NumSteps
+	});
+}
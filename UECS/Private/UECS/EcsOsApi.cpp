@@ -0,0 +1,300 @@
+#include "UECS/EcsOsApi.h"
+
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/Event.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+#include "Tasks/Task.h"
+#include "UECS/flecs.h"
+
+namespace
+{
+	// A flecs thread, running its callback once on an engine thread of its own.
+	class FEcsOsThread final : public FRunnable
+	{
+	public:
+		FEcsOsThread(const ecs_os_thread_callback_t InCallback, void* InParam)
+			: Callback(InCallback), Param(InParam)
+		{
+		}
+
+		virtual uint32 Run() override
+		{
+			Result = Callback(Param);
+			return 0;
+		}
+
+		ecs_os_thread_callback_t Callback;
+		void* Param;
+		void* Result { nullptr };
+		FRunnableThread* Thread { nullptr };
+	};
+
+	struct FEcsOsTask
+	{
+		UE::Tasks::TTask<void*> Task;
+	};
+
+	// Every waiter parks on an event of its own, so a signal wakes exactly one of them, in the order they started
+	// waiting. Waiters register before they let go of the mutex, and an event stays triggered until waited on, so no
+	// wake-up is lost in between.
+	struct FEcsOsCond
+	{
+		FCriticalSection Lock;
+		TArray<FEvent*, TInlineAllocator<8>> Waiters;
+	};
+
+	void* OsMalloc(const ecs_size_t Size)
+	{
+		return FMemory::Malloc(Size);
+	}
+
+	void* OsCalloc(const ecs_size_t Size)
+	{
+		return FMemory::MallocZeroed(Size);
+	}
+
+	void* OsRealloc(void* Ptr, const ecs_size_t Size)
+	{
+		return FMemory::Realloc(Ptr, Size);
+	}
+
+	void OsFree(void* Ptr)
+	{
+		FMemory::Free(Ptr);
+	}
+
+	ecs_os_thread_t OsThreadNew(const ecs_os_thread_callback_t Callback, void* Param)
+	{
+		FEcsOsThread* Thread = new FEcsOsThread(Callback, Param);
+		Thread->Thread = FRunnableThread::Create(Thread, TEXT("FlecsWorker"));
+		return reinterpret_cast<ecs_os_thread_t>(Thread);
+	}
+
+	void* OsThreadJoin(const ecs_os_thread_t Handle)
+	{
+		FEcsOsThread* Thread = reinterpret_cast<FEcsOsThread*>(Handle);
+		Thread->Thread->WaitForCompletion();
+
+		void* Result = Thread->Result;
+		delete Thread->Thread;
+		delete Thread;
+		return Result;
+	}
+
+	ecs_os_thread_id_t OsThreadSelf()
+	{
+		return FPlatformTLS::GetCurrentThreadId();
+	}
+
+	ecs_os_thread_t OsTaskNew(const ecs_os_thread_callback_t Callback, void* Param)
+	{
+		FEcsOsTask* Task = new FEcsOsTask{ UE::Tasks::Launch(TEXT("FlecsTask"), [Callback, Param]() { return Callback(Param); }) };
+		return reinterpret_cast<ecs_os_thread_t>(Task);
+	}
+
+	void* OsTaskJoin(const ecs_os_thread_t Handle)
+	{
+		FEcsOsTask* Task = reinterpret_cast<FEcsOsTask*>(Handle);
+		void* Result = Task->Task.GetResult();
+		delete Task;
+		return Result;
+	}
+
+	int32 OsAtomicIncrement(int32* Value)
+	{
+		return FPlatformAtomics::InterlockedIncrement(Value);
+	}
+
+	int32 OsAtomicDecrement(int32* Value)
+	{
+		return FPlatformAtomics::InterlockedDecrement(Value);
+	}
+
+	// int64_t isn't int64 on every platform.
+	int64_t OsAtomicIncrement64(int64_t* Value)
+	{
+		return FPlatformAtomics::InterlockedIncrement(reinterpret_cast<int64*>(Value));
+	}
+
+	int64_t OsAtomicDecrement64(int64_t* Value)
+	{
+		return FPlatformAtomics::InterlockedDecrement(reinterpret_cast<int64*>(Value));
+	}
+
+	ecs_os_mutex_t OsMutexNew()
+	{
+		return reinterpret_cast<ecs_os_mutex_t>(new FCriticalSection());
+	}
+
+	void OsMutexFree(const ecs_os_mutex_t Mutex)
+	{
+		delete reinterpret_cast<FCriticalSection*>(Mutex);
+	}
+
+	void OsMutexLock(const ecs_os_mutex_t Mutex)
+	{
+		reinterpret_cast<FCriticalSection*>(Mutex)->Lock();
+	}
+
+	void OsMutexUnlock(const ecs_os_mutex_t Mutex)
+	{
+		reinterpret_cast<FCriticalSection*>(Mutex)->Unlock();
+	}
+
+	ecs_os_cond_t OsCondNew()
+	{
+		return reinterpret_cast<ecs_os_cond_t>(new FEcsOsCond());
+	}
+
+	void OsCondFree(const ecs_os_cond_t Cond)
+	{
+		delete reinterpret_cast<FEcsOsCond*>(Cond);
+	}
+
+	void OsCondSignal(const ecs_os_cond_t Handle)
+	{
+		FEcsOsCond* Cond = reinterpret_cast<FEcsOsCond*>(Handle);
+		FScopeLock ScopeLock(&Cond->Lock);
+		if(Cond->Waiters.IsEmpty()) { return; }
+
+		FEvent* Waiter = Cond->Waiters[0];
+		Cond->Waiters.RemoveAt(0);
+		Waiter->Trigger();
+	}
+
+	void OsCondBroadcast(const ecs_os_cond_t Handle)
+	{
+		FEcsOsCond* Cond = reinterpret_cast<FEcsOsCond*>(Handle);
+		FScopeLock ScopeLock(&Cond->Lock);
+		for(FEvent* Waiter : Cond->Waiters)
+		{
+			Waiter->Trigger();
+		}
+		Cond->Waiters.Reset();
+	}
+
+	void OsCondWait(const ecs_os_cond_t Handle, const ecs_os_mutex_t Mutex)
+	{
+		FEcsOsCond* Cond = reinterpret_cast<FEcsOsCond*>(Handle);
+		FEvent* Event = FPlatformProcess::GetSynchEventFromPool(false);
+		{
+			FScopeLock ScopeLock(&Cond->Lock);
+			Cond->Waiters.Add(Event);
+		}
+
+		OsMutexUnlock(Mutex);
+		Event->Wait();
+		FPlatformProcess::ReturnSynchEventToPool(Event);
+		OsMutexLock(Mutex);
+	}
+
+	void OsSleep(const int32 Seconds, const int32 Nanoseconds)
+	{
+		FPlatformProcess::SleepNoStats(static_cast<float>(Seconds + Nanoseconds * 1e-9));
+	}
+
+	uint64_t OsNow()
+	{
+		return static_cast<uint64_t>(FPlatformTime::Seconds() * 1e9);
+	}
+
+	void OsGetTime(ecs_time_t* OutTime)
+	{
+		const double Seconds = FPlatformTime::Seconds();
+		OutTime->sec = static_cast<uint32>(Seconds);
+		OutTime->nanosec = static_cast<uint32>((Seconds - OutTime->sec) * 1e9);
+	}
+
+	void OsLog(const int32 Level, const char* File, const int32 Line, const char* Message)
+	{
+		if(Level <= -3)
+		{
+			UE_LOG(LogTemp, Error, TEXT("flecs: %s (%s:%d)"), UTF8_TO_TCHAR(Message), File ? UTF8_TO_TCHAR(File) : TEXT(""), Line);
+		}
+		else if(Level == -2)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("flecs: %s"), UTF8_TO_TCHAR(Message));
+		}
+		else if(Level == 0 || Level == -1)
+		{
+			UE_LOG(LogTemp, Log, TEXT("flecs: %s"), UTF8_TO_TCHAR(Message));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("flecs: %s"), UTF8_TO_TCHAR(Message));
+		}
+	}
+
+	void OsAbort()
+	{
+		UE_LOG(LogTemp, Fatal, TEXT("flecs: aborted"));
+	}
+}
+
+bool FEcsOsApi::Install()
+{
+	// Starts from the platform defaults, so anything not routed here keeps working as before.
+	ecs_os_set_api_defaults();
+	ecs_os_api_t Api = ecs_os_get_api();
+
+	Api.malloc_ = OsMalloc;
+	Api.calloc_ = OsCalloc;
+	Api.realloc_ = OsRealloc;
+	Api.free_ = OsFree;
+
+	Api.thread_new_ = OsThreadNew;
+	Api.thread_join_ = OsThreadJoin;
+	Api.thread_self_ = OsThreadSelf;
+	Api.task_new_ = OsTaskNew;
+	Api.task_join_ = OsTaskJoin;
+
+	Api.ainc_ = OsAtomicIncrement;
+	Api.adec_ = OsAtomicDecrement;
+	Api.lainc_ = OsAtomicIncrement64;
+	Api.ladec_ = OsAtomicDecrement64;
+
+	Api.mutex_new_ = OsMutexNew;
+	Api.mutex_free_ = OsMutexFree;
+	Api.mutex_lock_ = OsMutexLock;
+	Api.mutex_unlock_ = OsMutexUnlock;
+
+	Api.cond_new_ = OsCondNew;
+	Api.cond_free_ = OsCondFree;
+	Api.cond_signal_ = OsCondSignal;
+	Api.cond_broadcast_ = OsCondBroadcast;
+	Api.cond_wait_ = OsCondWait;
+
+	Api.sleep_ = OsSleep;
+	Api.now_ = OsNow;
+	Api.get_time_ = OsGetTime;
+
+	Api.log_ = OsLog;
+	Api.abort_ = OsAbort;
+
+	ecs_os_set_api(&Api);
+
+	if(!IsInstalled())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("flecs: OS API already in use, engine threading and allocation not installed. Install it before creating any world."));
+		return false;
+	}
+
+	return true;
+}
+
+bool FEcsOsApi::IsInstalled()
+{
+	return ecs_os_get_api().malloc_ == &OsMalloc;
+}
+
+int32 FEcsOsApi::GetMaxTaskThreads()
+{
+	return FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+}
+
+void FEcsOsApi::SetTaskThreads(const flecs::world& World, const int32 NumTaskThreads)
+{
+	World.set_task_threads(FMath::Clamp(NumTaskThreads, 0, GetMaxTaskThreads()));
+}
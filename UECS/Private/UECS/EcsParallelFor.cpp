@@ -0,0 +1,237 @@
+#include "UECS/EcsParallelFor.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	// Every live parallel-for, so their stats and grain sizes can be reached from the console.
+	struct FParallelForRegistry
+	{
+		FCriticalSection Lock;
+		TArray<FEcsParallelFor*> Instances;
+	};
+
+	FParallelForRegistry& GetRegistry()
+	{
+		static FParallelForRegistry Registry;
+		return Registry;
+	}
+
+	void DumpStats(const TArray<FString>& Args)
+	{
+		FParallelForRegistry& Registry = GetRegistry();
+		FScopeLock ScopeLock(&Registry.Lock);
+
+		TArray<FEcsParallelFor::FThreadStats> Stats;
+		TArray<float> Utilization;
+		for(const FEcsParallelFor* ParallelFor : Registry.Instances)
+		{
+			ParallelFor->GetThreadStats(Stats);
+			ParallelFor->GetThreadUtilization(Utilization);
+
+			UE_LOG(LogTemp, Display, TEXT("%s, grain size %d:"), ParallelFor->GetName(), ParallelFor->GrainSize);
+			for(int32 IdxThread = 0; IdxThread < Stats.Num(); ++IdxThread)
+			{
+				UE_LOG(LogTemp, Display, TEXT("  Thread %d: %d entities in %d chunks (%d stolen), %.3f ms busy, %.0f%% utilized"),
+					IdxThread, Stats[IdxThread].NumItems, Stats[IdxThread].NumChunks, Stats[IdxThread].NumStolenChunks,
+					FPlatformTime::ToMilliseconds64(Stats[IdxThread].BusyCycles), Utilization[IdxThread] * 100.0f);
+			}
+		}
+	}
+
+	void SetGrainSize(const TArray<FString>& Args)
+	{
+		if(Args.Num() < 2)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Usage: ecs.ParallelFor.GrainSize <Name> <GrainSize>"));
+			return;
+		}
+
+		const int32 GrainSize = FMath::Max(FCString::Atoi(*Args[1]), 1);
+
+		FParallelForRegistry& Registry = GetRegistry();
+		FScopeLock ScopeLock(&Registry.Lock);
+		for(FEcsParallelFor* ParallelFor : Registry.Instances)
+		{
+			if(Args[0].Equals(ParallelFor->GetName(), ESearchCase::IgnoreCase)) { ParallelFor->GrainSize = GrainSize; }
+		}
+	}
+}
+
+static FAutoConsoleCommand CmdDumpParallelForStats(
+	TEXT("ecs.ParallelFor.Stats"),
+	TEXT("Logs per-thread chunk, steal and utilization stats of the last frame of every ECS parallel-for."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&DumpStats));
+
+static FAutoConsoleCommand CmdSetParallelForGrainSize(
+	TEXT("ecs.ParallelFor.GrainSize"),
+	TEXT("Sets the entities per chunk of an ECS parallel-for, by name. Args: <Name> <GrainSize>"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&SetGrainSize));
+
+FEcsParallelFor::FEcsParallelFor(const TCHAR* InName, const int32 InGrainSize)
+	: GrainSize(FMath::Max(InGrainSize, 1)), Name(InName)
+{
+	FParallelForRegistry& Registry = GetRegistry();
+	FScopeLock ScopeLock(&Registry.Lock);
+	Registry.Instances.Add(this);
+}
+
+FEcsParallelFor::~FEcsParallelFor()
+{
+	FParallelForRegistry& Registry = GetRegistry();
+	FScopeLock ScopeLock(&Registry.Lock);
+	Registry.Instances.RemoveSingleSwap(this);
+}
+
+void FEcsParallelFor::Reset(const int32 InNumItems, const int32 NumThreads)
+{
+	NumItems = FMath::Max(InNumItems, 0);
+	ChunkSize = FMath::Max(GrainSize, 1);
+
+	const int32 NumThreadStates = FMath::Max(NumThreads, 1);
+	if(Threads.Num() != NumThreadStates)
+	{
+		Threads.Empty(NumThreadStates);
+		Threads.SetNum(NumThreadStates);
+	}
+
+	const int64 NumChunks = FMath::DivideAndRoundUp(NumItems, ChunkSize);
+	for(int32 IdxThread = 0; IdxThread < NumThreadStates; ++IdxThread)
+	{
+		const uint32 Begin = static_cast<uint32>(NumChunks * IdxThread / NumThreadStates);
+		const uint32 End = static_cast<uint32>(NumChunks * (IdxThread + 1) / NumThreadStates);
+
+		// Launching the tasks that call Run orders these before any of them.
+		Threads[IdxThread].Range.store(PackRange(Begin, End), std::memory_order_relaxed);
+		Threads[IdxThread].Stats = {};
+	}
+}
+
+void FEcsParallelFor::Reset(const flecs::query_base& Query, const int32 NumThreads)
+{
+	ResolvedQuery = Query;
+	Tables.Reset();
+	TableEnds.Reset();
+
+	// Only steps from table to table, so no columns are marked dirty and no results are populated.
+	int32 NumRows = 0;
+	ecs_iter_t Iterator = ecs_query_iter(ecs_get_world(ResolvedQuery), ResolvedQuery);
+	while(ecs_query_next_table(&Iterator))
+	{
+		const int32 NumTableRows = ecs_table_count(Iterator.table);
+		if(0 == NumTableRows) { continue; }
+
+		NumRows += NumTableRows;
+
+		// A table matched more than once yields its rows once per match from the same narrowed iterator.
+		if(!Tables.IsEmpty() && Tables.Last() == Iterator.table)
+		{
+			TableEnds.Last() = NumRows;
+			continue;
+		}
+
+		Tables.Add(Iterator.table);
+		TableEnds.Add(NumRows);
+	}
+
+	Reset(NumRows, NumThreads);
+}
+
+bool FEcsParallelFor::InitTableIterator(flecs::world& Stage, const int32 IdxTable, ecs_iter_t& OutIterator) const
+{
+	OutIterator = ecs_query_iter(Stage.c_ptr(), ResolvedQuery);
+
+	// Queries whose non-$this terms don't match come back empty, without the variables to narrow down.
+	if(nullptr == OutIterator.variables) { return false; }
+
+	ecs_table_t* Table = Tables[IdxTable];
+	const ecs_table_range_t Range { Table, 0, ecs_table_count(Table) };
+	ecs_iter_set_var_as_range(&OutIterator, 0, &Range);
+
+	// Unlike ecs_iter_set_var, setting a range doesn't tell the query, which narrows its table list down in set_var.
+	OutIterator.set_var(&OutIterator);
+	return true;
+}
+
+bool FEcsParallelFor::Pop(const int32 IdxThread, int32& OutIdxChunk)
+{
+	std::atomic<uint64>& Range = Threads[IdxThread].Range;
+
+	uint64 Packed = Range.load(std::memory_order_acquire);
+	for(;;)
+	{
+		const uint32 Begin = static_cast<uint32>(Packed);
+		const uint32 End = static_cast<uint32>(Packed >> 32);
+		if(Begin >= End) { return false; }
+
+		if(Range.compare_exchange_weak(Packed, PackRange(Begin + 1, End), std::memory_order_acq_rel))
+		{
+			OutIdxChunk = static_cast<int32>(Begin);
+			return true;
+		}
+	}
+}
+
+bool FEcsParallelFor::Steal(const int32 IdxThread, int32& OutIdxChunk)
+{
+	const int32 NumThreads = Threads.Num();
+	for(int32 IdxVictimOffset = 1; IdxVictimOffset < NumThreads; ++IdxVictimOffset)
+	{
+		std::atomic<uint64>& VictimRange = Threads[(IdxThread + IdxVictimOffset) % NumThreads].Range;
+
+		uint64 Packed = VictimRange.load(std::memory_order_acquire);
+		for(;;)
+		{
+			const uint32 Begin = static_cast<uint32>(Packed);
+			const uint32 End = static_cast<uint32>(Packed >> 32);
+			if(Begin >= End) { break; }
+
+			// Half of what's left, rounded up, from the back; the victim keeps working on the front.
+			const uint32 NumStolen = (End - Begin + 1) / 2;
+			const uint32 NewEnd = End - NumStolen;
+			if(!VictimRange.compare_exchange_weak(Packed, PackRange(Begin, NewEnd), std::memory_order_acq_rel)) { continue; }
+
+			// Our own run is empty, and thieves never touch an empty run, so a plain store hands the rest over. Every
+			// chunk of a run is consumed before it goes empty, so this can't recreate a value a thief still expects.
+			FThreadState& State = Threads[IdxThread];
+			State.Range.store(PackRange(NewEnd + 1, End), std::memory_order_release);
+			State.Stats.NumStolenChunks += NumStolen;
+
+			OutIdxChunk = static_cast<int32>(NewEnd);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FEcsParallelFor::GetThreadStats(TArray<FThreadStats>& OutStats) const
+{
+	OutStats.Reset(Threads.Num());
+	for(const FThreadState& State : Threads)
+	{
+		OutStats.Add(State.Stats);
+	}
+}
+
+void FEcsParallelFor::GetThreadUtilization(TArray<float>& OutUtilization) const
+{
+	uint64 FirstCycle = MAX_uint64;
+	uint64 LastCycle = 0;
+	for(const FThreadState& State : Threads)
+	{
+		if(0 == State.Stats.NumChunks) { continue; }
+
+		FirstCycle = FMath::Min(FirstCycle, State.Stats.FirstCycle);
+		LastCycle = FMath::Max(LastCycle, State.Stats.LastCycle);
+	}
+
+	const double SpanCycles = LastCycle > FirstCycle ? static_cast<double>(LastCycle - FirstCycle) : 0.0;
+
+	OutUtilization.Reset(Threads.Num());
+	for(const FThreadState& State : Threads)
+	{
+		OutUtilization.Add(SpanCycles > 0.0 ? static_cast<float>(State.Stats.BusyCycles / SpanCycles) : 0.0f);
+	}
+}
@@ -0,0 +1,106 @@
+#include "UECS/EcsRenderState.h"
+
+#include "FlecsLibrary.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "UECS/flecs.h"
+#include "UECS/Components/BaseComponents.h"
+
+DECLARE_CYCLE_STAT(TEXT("RenderStateApply"), CS_RENDER_STATE_APPLY, STATGROUP_ECS)
+DECLARE_CYCLE_STAT(TEXT("RenderStateFlush"), CS_RENDER_STATE_FLUSH, STATGROUP_ECS)
+
+void FEcsRenderBuffer::Reset()
+{
+	ActorEntities.Reset();
+	ActorTransforms.Reset();
+	IsmBatches.Reset();
+}
+
+FEcsRenderState::FEcsRenderState(flecs::world& InWorld)
+	: World(InWorld)
+{
+}
+
+FEcsRenderState::~FEcsRenderState()
+{
+	Flush();
+}
+
+void FEcsRenderState::Submit()
+{
+	// The read buffer is about to become the write buffer, so whatever is still applying it has to finish first.
+	Flush();
+
+	const int32 IdxReadBuffer = IdxWriteBuffer;
+	IdxWriteBuffer = 1 - IdxWriteBuffer;
+	Buffers[IdxWriteBuffer].Reset();
+
+	if(Buffers[IdxReadBuffer].IsEmpty()) { return; }
+
+	const FEcsRenderBuffer* ReadBuffer = &Buffers[IdxReadBuffer];
+	ApplyTask = FFunctionGraphTask::CreateAndDispatchWhenReady([this, ReadBuffer]()
+	{
+		Apply(*ReadBuffer);
+	}, TStatId(), nullptr, ENamedThreads::GameThread);
+}
+
+void FEcsRenderState::Flush()
+{
+	if(!ApplyTask.IsValid()) { return; }
+
+	SCOPE_CYCLE_COUNTER(CS_RENDER_STATE_FLUSH)
+
+	// The task sits in the game thread's main queue, which a game thread wait has to process for it to ever run. Waiting
+	// on the local queue instead would never get to it.
+	const ENamedThreads::Type CurrentThread = IsInGameThread() ? ENamedThreads::GameThread : ENamedThreads::AnyThread;
+	FTaskGraphInterface::Get().WaitUntilTaskCompletes(ApplyTask, CurrentThread);
+	ApplyTask = nullptr;
+}
+
+void FEcsRenderState::Apply(const FEcsRenderBuffer& Buffer) const
+{
+	SCOPE_CYCLE_COUNTER(CS_RENDER_STATE_APPLY)
+
+	for(int32 IdxActor = 0; IdxActor < Buffer.ActorEntities.Num(); ++IdxActor)
+	{
+		const flecs::entity Entity(World, Buffer.ActorEntities[IdxActor]);
+		if(!Entity.is_alive()) { continue; }
+
+		const FActorComponent* ActorComponent = Entity.get<FActorComponent>();
+		if(nullptr == ActorComponent || !IsValid(ActorComponent->Actor)) { continue; }
+
+		ActorComponent->Actor->SetActorTransform(Buffer.ActorTransforms[IdxActor]);
+	}
+
+	TArray<int32> InstanceIds;
+	TArray<FTransform> Transforms;
+	for(const FEcsRenderBuffer::FIsmBatch& Batch : Buffer.IsmBatches)
+	{
+		const flecs::entity IsmEntity(World, Batch.IsmEntity);
+		if(!IsmEntity.is_alive()) { continue; }
+
+		const FInstancedStaticMesh* Ism = IsmEntity.get<FInstancedStaticMesh>();
+		if(nullptr == Ism || !IsValid(Ism->UnrealComponent)) { continue; }
+
+		// Instance indices are looked up now rather than at packing time, since removals swap other instances into the
+		// removed slots in between.
+		UInstancedStaticMeshComponent* Component = Ism->UnrealComponent;
+		const int32 NumInstances = Component->GetInstanceCount();
+		InstanceIds.Reset();
+		Transforms.Reset();
+		for(int32 IdxInstance = 0; IdxInstance < Batch.Entities.Num(); ++IdxInstance)
+		{
+			const flecs::entity Entity(World, Batch.Entities[IdxInstance]);
+			if(!Entity.is_alive()) { continue; }
+
+			const FInstancedStaticMeshMember* IsmMember = Entity.get<FInstancedStaticMeshMember>();
+			if(nullptr == IsmMember || IsmMember->IdxInIsm >= NumInstances) { continue; }
+
+			InstanceIds.Add(IsmMember->IdxInIsm);
+			Transforms.Add(Batch.Transforms[IdxInstance]);
+		}
+
+		if(InstanceIds.IsEmpty()) { continue; }
+
+		Component->UpdateInstances(InstanceIds, Transforms, Transforms, 0, {});
+	}
+}
@@ -0,0 +1,529 @@
+#include "UECS/StaticWorldCollision.h"
+
+#include "EngineUtils.h"
+#include "LandscapeProxy.h"
+#include "Async/MappedFileHandle.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "UECS/CollisionHelper.h"
+
+using namespace StaticWorldCollision;
+
+namespace
+{
+	// Heights of landscape holes. Cells touching one are skipped by the sweep.
+	constexpr float HoleHeight { -MAX_flt };
+
+	struct FBakedHull
+	{
+		FVector Center;
+		TArray<FVector3f> Vertices;
+		TArray<int32> Indices;
+		FBox3f Bounds;
+	};
+
+	template<typename ElementType>
+	bool BindSection(const uint8* Data, const int64 Size, const uint64 Offset, const int32 Num, TConstArrayView<ElementType>& OutView)
+	{
+		if(Num < 0 || Offset % alignof(ElementType) != 0) { return false; }
+		if(Offset + static_cast<uint64>(Num) * sizeof(ElementType) > static_cast<uint64>(Size)) { return false; }
+
+		OutView = MakeArrayView(reinterpret_cast<const ElementType*>(Data + Offset), Num);
+		return true;
+	}
+
+	template<typename ElementType>
+	uint64 AppendSection(TArray<uint8>& Blob, const TArray<ElementType>& Elements)
+	{
+		Blob.SetNumZeroed(Align(Blob.Num(), 16));
+		const uint64 Offset = Blob.Num();
+		Blob.Append(reinterpret_cast<const uint8*>(Elements.GetData()), Elements.Num() * sizeof(ElementType));
+		return Offset;
+	}
+
+	void AddBakedHull(TArray<FBakedHull>& BakedHulls, const TArray<FVector>& WorldVertices, const TConstArrayView<int32> Indices)
+	{
+		if(WorldVertices.Num() <= 0) { return; }
+
+		FBakedHull& Hull = BakedHulls.AddDefaulted_GetRef();
+		Hull.Center = FBox(WorldVertices).GetCenter();
+		Hull.Indices.Append(Indices.GetData(), Indices.Num());
+		Hull.Bounds = FBox3f(ForceInit);
+
+		Hull.Vertices.Reserve(WorldVertices.Num());
+		for(const FVector& Vertex : WorldVertices)
+		{
+			Hull.Vertices.Add(FVector3f(Vertex - Hull.Center));
+			Hull.Bounds += FVector3f(Vertex);
+		}
+	}
+
+	void BakeBodySetup(TArray<FBakedHull>& BakedHulls, const UBodySetup& BodySetup, const FTransform& ComponentTransform)
+	{
+		// Box corners ordered so that bit 0/1/2 of the index selects the +X/+Y/+Z side, with two triangles per face.
+		static const int32 BoxIndices[] = {
+			0, 2, 1, 1, 2, 3,  4, 5, 6, 5, 7, 6,
+			0, 1, 4, 1, 5, 4,  2, 6, 3, 3, 6, 7,
+			0, 4, 2, 2, 4, 6,  1, 3, 5, 3, 7, 5
+		};
+
+		TArray<FVector> WorldVertices;
+
+		for(const FKConvexElem& ConvexElem : BodySetup.AggGeom.ConvexElems)
+		{
+			const FTransform ElemTransform = ConvexElem.GetTransform() * ComponentTransform;
+
+			WorldVertices.Reset(ConvexElem.VertexData.Num());
+			for(const FVector& Vertex : ConvexElem.VertexData)
+			{
+				WorldVertices.Add(ElemTransform.TransformPosition(Vertex));
+			}
+
+			AddBakedHull(BakedHulls, WorldVertices, ConvexElem.IndexData);
+		}
+
+		for(const FKBoxElem& BoxElem : BodySetup.AggGeom.BoxElems)
+		{
+			const FTransform ElemTransform = BoxElem.GetTransform() * ComponentTransform;
+			const FVector HalfExtents = FVector(BoxElem.X, BoxElem.Y, BoxElem.Z) * 0.5f;
+
+			WorldVertices.Reset(8);
+			for(int32 IdxCorner = 0; IdxCorner < 8; ++IdxCorner)
+			{
+				const FVector Corner(
+					(IdxCorner & 1) ? HalfExtents.X : -HalfExtents.X,
+					(IdxCorner & 2) ? HalfExtents.Y : -HalfExtents.Y,
+					(IdxCorner & 4) ? HalfExtents.Z : -HalfExtents.Z);
+				WorldVertices.Add(ElemTransform.TransformPosition(Corner));
+			}
+
+			AddBakedHull(BakedHulls, WorldVertices, BoxIndices);
+		}
+	}
+
+	void BuildBvh(TArray<FBvhNode>& Nodes, TArray<int32>& Order, const TArray<FBakedHull>& BakedHulls, const int32 IdxNode, const int32 First, const int32 Count)
+	{
+		FBox3f Bounds(ForceInit);
+		FBox3f CentroidBounds(ForceInit);
+		for(int32 Idx = First; Idx < First + Count; ++Idx)
+		{
+			Bounds += BakedHulls[Order[Idx]].Bounds;
+			CentroidBounds += BakedHulls[Order[Idx]].Bounds.GetCenter();
+		}
+
+		Nodes[IdxNode].Min = Bounds.Min;
+		Nodes[IdxNode].Max = Bounds.Max;
+
+		if(Count <= LeafSize)
+		{
+			Nodes[IdxNode].First = First;
+			Nodes[IdxNode].Count = Count;
+			return;
+		}
+
+		// Median split along the widest axis of the centroids.
+		const FVector3f CentroidExtent = CentroidBounds.GetExtent();
+		const int32 Axis = CentroidExtent.X >= CentroidExtent.Y && CentroidExtent.X >= CentroidExtent.Z ? 0 : (CentroidExtent.Y >= CentroidExtent.Z ? 1 : 2);
+
+		MakeArrayView(Order.GetData() + First, Count).Sort([&BakedHulls, Axis](const int32 A, const int32 B)
+		{
+			return BakedHulls[A].Bounds.GetCenter()[Axis] < BakedHulls[B].Bounds.GetCenter()[Axis];
+		});
+
+		const int32 IdxChild = Nodes.AddDefaulted(2);
+		Nodes[IdxNode].First = IdxChild;
+		Nodes[IdxNode].Count = 0;
+
+		const int32 NumLeft = Count / 2;
+		BuildBvh(Nodes, Order, BakedHulls, IdxChild, First, NumLeft);
+		BuildBvh(Nodes, Order, BakedHulls, IdxChild + 1, First + NumLeft, Count - NumLeft);
+	}
+}
+
+FStaticWorldCollision::FStaticWorldCollision() = default;
+
+FStaticWorldCollision::~FStaticWorldCollision()
+{
+	Unload();
+}
+
+bool FStaticWorldCollision::Load(const FString& Filename)
+{
+	Unload();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if(MappedFile.IsValid())
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+		if(MappedRegion.IsValid() && Bind(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize())) { return true; }
+
+		MappedRegion.Reset();
+		MappedFile.Reset();
+	}
+
+	// Platforms without mapped file support still get the same in-place layout, just read into memory.
+	if(FFileHelper::LoadFileToArray(LoadedData, *Filename) && Bind(LoadedData.GetData(), LoadedData.Num())) { return true; }
+
+	Unload();
+	return false;
+}
+
+void FStaticWorldCollision::Unload()
+{
+	Hulls.Reset();
+	Header = nullptr;
+	Nodes = {};
+	HullRecords = {};
+	Heightfields = {};
+	Heights = {};
+
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	LoadedData.Empty();
+}
+
+bool FStaticWorldCollision::Bind(const uint8* Data, const int64 Size)
+{
+	// A failed attempt may have left hulls behind before the fallback binds the same file again.
+	Hulls.Reset();
+
+	if(nullptr == Data || Size < static_cast<int64>(sizeof(FHeader))) { return false; }
+
+	const FHeader* FileHeader = reinterpret_cast<const FHeader*>(Data);
+	if(FileHeader->Magic != Magic || FileHeader->Version != Version) { return false; }
+
+	TConstArrayView<FVector3f> Vertices;
+	TConstArrayView<int32> AdjacencyOffsets;
+	TConstArrayView<int32> Adjacency;
+
+	if(!BindSection(Data, Size, FileHeader->NodesOffset, FileHeader->NumNodes, Nodes)
+		|| !BindSection(Data, Size, FileHeader->HullsOffset, FileHeader->NumHulls, HullRecords)
+		|| !BindSection(Data, Size, FileHeader->VerticesOffset, FileHeader->NumVertices, Vertices)
+		|| !BindSection(Data, Size, FileHeader->AdjacencyOffsetsOffset, FileHeader->NumAdjacencyOffsets, AdjacencyOffsets)
+		|| !BindSection(Data, Size, FileHeader->AdjacencyOffset, FileHeader->NumAdjacency, Adjacency)
+		|| !BindSection(Data, Size, FileHeader->HeightfieldsOffset, FileHeader->NumHeightfields, Heightfields)
+		|| !BindSection(Data, Size, FileHeader->HeightsOffset, FileHeader->NumHeights, Heights))
+	{
+		return false;
+	}
+
+	auto IsValidRange = [](const int32 First, const int32 Num, const int32 Max)
+	{
+		return First >= 0 && Num >= 0 && First <= Max - Num;
+	};
+
+	// Leaves must stay within the hulls, and inner nodes must point forward to a pair of nodes, so a corrupt file can
+	// neither read out of bounds nor send GetHullsInBox around in circles.
+	for(int32 IdxNode = 0; IdxNode < Nodes.Num(); ++IdxNode)
+	{
+		const FBvhNode& Node = Nodes[IdxNode];
+		const bool bIsValidNode = Node.Count > 0
+			? IsValidRange(Node.First, Node.Count, HullRecords.Num())
+			: Node.Count == 0 && Node.First > IdxNode && IsValidRange(Node.First, 2, Nodes.Num());
+		if(!bIsValidNode) { return false; }
+	}
+
+	Hulls.Reserve(HullRecords.Num());
+	for(const FHull& Record : HullRecords)
+	{
+		if(Record.NumVertices <= 0
+			|| !IsValidRange(Record.FirstVertex, Record.NumVertices, Vertices.Num())
+			|| Record.NumAdjacencyOffsets != Record.NumVertices + 1
+			|| !IsValidRange(Record.FirstAdjacencyOffset, Record.NumAdjacencyOffsets, AdjacencyOffsets.Num())
+			|| !IsValidRange(Record.FirstAdjacency, Record.NumAdjacency, Adjacency.Num()))
+		{
+			return false;
+		}
+
+		// The support search walks the adjacency from vertex to vertex, so every offset has to stay within the hull's
+		// adjacency, in order, and every neighbour has to be one of its vertices.
+		const TConstArrayView<int32> HullAdjacencyOffsets = AdjacencyOffsets.Slice(Record.FirstAdjacencyOffset, Record.NumAdjacencyOffsets);
+		const TConstArrayView<int32> HullAdjacency = Adjacency.Slice(Record.FirstAdjacency, Record.NumAdjacency);
+		if(HullAdjacencyOffsets[0] < 0 || HullAdjacencyOffsets.Last() > HullAdjacency.Num()) { return false; }
+
+		for(int32 IdxOffset = 1; IdxOffset < HullAdjacencyOffsets.Num(); ++IdxOffset)
+		{
+			if(HullAdjacencyOffsets[IdxOffset] < HullAdjacencyOffsets[IdxOffset - 1]) { return false; }
+		}
+
+		for(const int32 IdxNeighbour : HullAdjacency)
+		{
+			if(IdxNeighbour < 0 || IdxNeighbour >= Record.NumVertices) { return false; }
+		}
+
+		const TSharedRef<FConvexHullData, ESPMode::ThreadSafe> Hull = MakeShared<FConvexHullData, ESPMode::ThreadSafe>();
+		Hull->Vertices = Vertices.Slice(Record.FirstVertex, Record.NumVertices);
+		Hull->AdjacencyOffsets = HullAdjacencyOffsets;
+		Hull->Adjacency = HullAdjacency;
+		Hull->UpdateBounds();
+		Hulls.Add(Hull);
+	}
+
+	// Sized in int64, since NumX * NumY of a corrupt heightfield can overflow int32 and come out small.
+	for(const FHeightfield& Heightfield : Heightfields)
+	{
+		if(Heightfield.NumX < 2 || Heightfield.NumY < 2) { return false; }
+
+		const int64 NumHeights = static_cast<int64>(Heightfield.NumX) * Heightfield.NumY;
+		if(Heightfield.FirstHeight < 0 || NumHeights > Heights.Num() - Heightfield.FirstHeight) { return false; }
+	}
+
+	Header = FileHeader;
+	return true;
+}
+
+void FStaticWorldCollision::GetHullsInBox(const FBox3f& Box, TArray<int32>& OutHulls) const
+{
+	if(Nodes.Num() <= 0) { return; }
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+
+	while(Stack.Num() > 0)
+	{
+		const FBvhNode& Node = Nodes[Stack.Pop(EAllowShrinking::No)];
+		if(!Box.Intersect(FBox3f(Node.Min, Node.Max))) { continue; }
+
+		if(Node.Count > 0)
+		{
+			for(int32 IdxHull = Node.First; IdxHull < Node.First + Node.Count; ++IdxHull)
+			{
+				OutHulls.Add(IdxHull);
+			}
+			continue;
+		}
+
+		Stack.Add(Node.First);
+		Stack.Add(Node.First + 1);
+	}
+}
+
+bool FStaticWorldCollision::Sweep(const FSupportShape& Shape, const FTransform& From, const FTransform& To, FConservativeAdvancementOutput& OutHit) const
+{
+	if(!IsLoaded()) { return false; }
+
+	const float Radius = FCollisionHelper::GetBoundingRadius(Shape, From);
+	FBox3f SweptBounds(FVector3f(From.GetLocation()), FVector3f(From.GetLocation()));
+	SweptBounds += FVector3f(To.GetLocation());
+	SweptBounds = SweptBounds.ExpandBy(Radius);
+
+	thread_local TArray<int32> CandidateHulls;
+	CandidateHulls.Reset();
+	GetHullsInBox(SweptBounds, CandidateHulls);
+
+	bool bHit = false;
+	OutHit = FConservativeAdvancementOutput {};
+	OutHit.Time = 1.0f;
+
+	for(const int32 IdxHull : CandidateHulls)
+	{
+		const FConvexHullRef& Hull = Hulls[IdxHull];
+		const FTransform HullTransform(FVector(HullRecords[IdxHull].Center));
+		const FSupportShape HullShape(FCollisionShape::MakeBox(FVector(Hull->Extents)), Hull, 0);
+
+		const FConservativeAdvancementOutput Output = FCollisionHelper::ConservativeAdvancement(Shape, From, To, HullShape, HullTransform, HullTransform);
+		if(!(Output.bCollided || Output.bStoppedShort) || (bHit && Output.Time >= OutHit.Time)) { continue; }
+
+		OutHit = Output;
+		bHit = true;
+	}
+
+	for(const FHeightfield& Heightfield : Heightfields)
+	{
+		bHit |= SweepHeightfield(Heightfield, Shape, From, To, SweptBounds, OutHit);
+	}
+
+	return bHit;
+}
+
+bool FStaticWorldCollision::SweepHeightfield(const FHeightfield& Heightfield, const FSupportShape& Shape, const FTransform& From, const FTransform& To,
+                                             const FBox3f& SweptBounds, FConservativeAdvancementOutput& InOutHit) const
+{
+	const int32 MinX = FMath::Max(FMath::FloorToInt32((SweptBounds.Min.X - Heightfield.Origin.X) / Heightfield.CellSize.X), 0);
+	const int32 MinY = FMath::Max(FMath::FloorToInt32((SweptBounds.Min.Y - Heightfield.Origin.Y) / Heightfield.CellSize.Y), 0);
+	const int32 MaxX = FMath::Min(FMath::FloorToInt32((SweptBounds.Max.X - Heightfield.Origin.X) / Heightfield.CellSize.X), Heightfield.NumX - 2);
+	const int32 MaxY = FMath::Min(FMath::FloorToInt32((SweptBounds.Max.Y - Heightfield.Origin.Y) / Heightfield.CellSize.Y), Heightfield.NumY - 2);
+
+	const bool bHadHit = InOutHit.bCollided || InOutHit.bStoppedShort;
+	bool bHit = false;
+
+	// Every triangle is swept through the same hull, re-pointed at its corners, rather than allocating one per triangle.
+	thread_local const TSharedRef<FConvexHullData, ESPMode::ThreadSafe> TriangleHull = MakeShared<FConvexHullData, ESPMode::ThreadSafe>();
+
+	for(int32 Y = MinY; Y <= MaxY; ++Y)
+	{
+		for(int32 X = MinX; X <= MaxX; ++X)
+		{
+			const int32 IdxHeight = Heightfield.FirstHeight + Y * Heightfield.NumX + X;
+			const float H00 = Heights[IdxHeight];
+			const float H10 = Heights[IdxHeight + 1];
+			const float H01 = Heights[IdxHeight + Heightfield.NumX];
+			const float H11 = Heights[IdxHeight + Heightfield.NumX + 1];
+			if(H00 == HoleHeight || H10 == HoleHeight || H01 == HoleHeight || H11 == HoleHeight) { continue; }
+
+			// Cells entirely above or below the sweep can't be touched.
+			if(FMath::Min(FMath::Min(H00, H10), FMath::Min(H01, H11)) > SweptBounds.Max.Z) { continue; }
+			if(FMath::Max(FMath::Max(H00, H10), FMath::Max(H01, H11)) < SweptBounds.Min.Z) { continue; }
+
+			// Corners relative to the cell's first sample, which is also the origin of the triangle hulls.
+			const FVector3f CellOrigin(Heightfield.Origin.X + X * Heightfield.CellSize.X, Heightfield.Origin.Y + Y * Heightfield.CellSize.Y, H00);
+			const FVector3f Corners[4] = {
+				FVector3f(0.0f, 0.0f, 0.0f),
+				FVector3f(Heightfield.CellSize.X, 0.0f, H10 - H00),
+				FVector3f(0.0f, Heightfield.CellSize.Y, H01 - H00),
+				FVector3f(Heightfield.CellSize.X, Heightfield.CellSize.Y, H11 - H00)
+			};
+			const FVector3f Triangles[2][3] = {
+				{ Corners[0], Corners[1], Corners[3] },
+				{ Corners[0], Corners[3], Corners[2] }
+			};
+
+			const FTransform CellTransform((FVector(CellOrigin)));
+			for(const FVector3f (&Triangle)[3] : Triangles)
+			{
+				TriangleHull->Vertices = MakeArrayView(Triangle, 3);
+				TriangleHull->UpdateBounds();
+
+				const FSupportShape TriangleShape(FCollisionShape::MakeBox(FVector(TriangleHull->Extents)), TriangleHull, 0);
+				const FConservativeAdvancementOutput Output = FCollisionHelper::ConservativeAdvancement(Shape, From, To, TriangleShape, CellTransform, CellTransform);
+				if(!(Output.bCollided || Output.bStoppedShort) || ((bHadHit || bHit) && Output.Time >= InOutHit.Time)) { continue; }
+
+				InOutHit = Output;
+				bHit = true;
+			}
+		}
+	}
+
+	return bHit;
+}
+
+bool FStaticWorldCollision::Bake(UWorld* World, const FString& Filename)
+{
+	if(nullptr == World) { return false; }
+
+	TArray<FBakedHull> BakedHulls;
+
+	for(TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt)
+	{
+		ActorIt->ForEachComponent<UStaticMeshComponent>(false, [&BakedHulls](const UStaticMeshComponent* Component)
+		{
+			if(Component->Mobility != EComponentMobility::Static || !Component->IsCollisionEnabled()) { return; }
+
+			const UStaticMesh* StaticMesh = Component->GetStaticMesh();
+			const UBodySetup* BodySetup = nullptr != StaticMesh ? StaticMesh->GetBodySetup() : nullptr;
+			if(nullptr == BodySetup) { return; }
+
+			if(const UInstancedStaticMeshComponent* InstancedComponent = Cast<UInstancedStaticMeshComponent>(Component))
+			{
+				for(int32 IdxInstance = 0; IdxInstance < InstancedComponent->GetInstanceCount(); ++IdxInstance)
+				{
+					FTransform InstanceTransform;
+					if(InstancedComponent->GetInstanceTransform(IdxInstance, InstanceTransform, true))
+					{
+						BakeBodySetup(BakedHulls, *BodySetup, InstanceTransform);
+					}
+				}
+				return;
+			}
+
+			BakeBodySetup(BakedHulls, *BodySetup, Component->GetComponentTransform());
+		});
+	}
+
+	TArray<FHeightfield> BakedHeightfields;
+	TArray<float> BakedHeights;
+
+	for(TActorIterator<ALandscapeProxy> LandscapeIt(World); LandscapeIt; ++LandscapeIt)
+	{
+		const FBox Bounds = LandscapeIt->GetComponentsBoundingBox(true);
+		if(!Bounds.IsValid) { continue; }
+
+		// Sample at the landscape's quad resolution.
+		const FVector Scale = LandscapeIt->GetActorScale3D();
+		FHeightfield& Heightfield = BakedHeightfields.AddDefaulted_GetRef();
+		Heightfield.Origin = FVector3f(Bounds.Min.X, Bounds.Min.Y, 0.0f);
+		Heightfield.CellSize = FVector2f(FMath::Abs(Scale.X), FMath::Abs(Scale.Y));
+		Heightfield.NumX = FMath::CeilToInt32(Bounds.GetSize().X / Heightfield.CellSize.X) + 1;
+		Heightfield.NumY = FMath::CeilToInt32(Bounds.GetSize().Y / Heightfield.CellSize.Y) + 1;
+		Heightfield.FirstHeight = BakedHeights.Num();
+
+		BakedHeights.Reserve(BakedHeights.Num() + Heightfield.NumX * Heightfield.NumY);
+		for(int32 Y = 0; Y < Heightfield.NumY; ++Y)
+		{
+			for(int32 X = 0; X < Heightfield.NumX; ++X)
+			{
+				const FVector Location(Heightfield.Origin.X + X * Heightfield.CellSize.X, Heightfield.Origin.Y + Y * Heightfield.CellSize.Y, 0.0f);
+				const TOptional<float> Height = LandscapeIt->GetHeightAtLocation(Location, EHeightfieldSource::Simple);
+				BakedHeights.Add(Height.IsSet() ? Height.GetValue() : HoleHeight);
+			}
+		}
+	}
+
+	TArray<int32> Order;
+	Order.Reserve(BakedHulls.Num());
+	for(int32 IdxHull = 0; IdxHull < BakedHulls.Num(); ++IdxHull)
+	{
+		Order.Add(IdxHull);
+	}
+
+	TArray<FBvhNode> BakedNodes;
+	if(BakedHulls.Num() > 0)
+	{
+		BakedNodes.AddDefaulted();
+		BuildBvh(BakedNodes, Order, BakedHulls, 0, 0, BakedHulls.Num());
+	}
+
+	// Hulls are written in BVH leaf order, so leaves can reference them as ranges.
+	TArray<FHull> HullRecords;
+	TArray<FVector3f> Vertices;
+	TArray<int32> AdjacencyOffsets;
+	TArray<int32> Adjacency;
+	TArray<int32> HullAdjacencyOffsets;
+	TArray<int32> HullAdjacency;
+
+	for(const int32 IdxHull : Order)
+	{
+		const FBakedHull& BakedHull = BakedHulls[IdxHull];
+		FConvexHullHelper::BuildAdjacency(BakedHull.Vertices.Num(), BakedHull.Indices, HullAdjacencyOffsets, HullAdjacency);
+
+		FHull& Record = HullRecords.AddZeroed_GetRef();
+		Record.Center = FVector3f(BakedHull.Center);
+		Record.FirstVertex = Vertices.Num();
+		Record.NumVertices = BakedHull.Vertices.Num();
+		Record.FirstAdjacencyOffset = AdjacencyOffsets.Num();
+		Record.NumAdjacencyOffsets = HullAdjacencyOffsets.Num();
+		Record.FirstAdjacency = Adjacency.Num();
+		Record.NumAdjacency = HullAdjacency.Num();
+
+		Vertices.Append(BakedHull.Vertices);
+		AdjacencyOffsets.Append(HullAdjacencyOffsets);
+		Adjacency.Append(HullAdjacency);
+	}
+
+	FHeader FileHeader;
+	FileHeader.NumNodes = BakedNodes.Num();
+	FileHeader.NumHulls = HullRecords.Num();
+	FileHeader.NumVertices = Vertices.Num();
+	FileHeader.NumAdjacencyOffsets = AdjacencyOffsets.Num();
+	FileHeader.NumAdjacency = Adjacency.Num();
+	FileHeader.NumHeightfields = BakedHeightfields.Num();
+	FileHeader.NumHeights = BakedHeights.Num();
+
+	TArray<uint8> Blob;
+	Blob.SetNumZeroed(sizeof(FHeader));
+	FileHeader.NodesOffset = AppendSection(Blob, BakedNodes);
+	FileHeader.HullsOffset = AppendSection(Blob, HullRecords);
+	FileHeader.VerticesOffset = AppendSection(Blob, Vertices);
+	FileHeader.AdjacencyOffsetsOffset = AppendSection(Blob, AdjacencyOffsets);
+	FileHeader.AdjacencyOffset = AppendSection(Blob, Adjacency);
+	FileHeader.HeightfieldsOffset = AppendSection(Blob, BakedHeightfields);
+	FileHeader.HeightsOffset = AppendSection(Blob, BakedHeights);
+	FMemory::Memcpy(Blob.GetData(), &FileHeader, sizeof(FHeader));
+
+	return FFileHelper::SaveArrayToFile(Blob, *Filename);
+}
@@ -1,8 +1,7 @@
 #include "UECS/Systems/CheckAtTargetSystem.h"
 
-#include "UECS/EcsComponentType.h"
 #include "UECS/flecs.h"
-#include "UECS/SystemReadWriteUsage.h"
+#include "UECS/UnrealEcsSystemScheduler.h"
 #include "UECS/Components/BaseComponents.h"
 #include "UECS/Components/MaxTargetDistance.h"
 #include "UECS/Components/TargetEntity.h"
@@ -10,7 +9,7 @@
 
 FCheckAtTargetSystem::FCheckAtTargetSystem(flecs::world& World)
 {
-	QueryCheckAtTarget = new flecs::query(World.query_builder<const FPosition, const FTargetEntity, const FMaxTargetDistance>()
+	QueryCheckAtTarget = new FQueryCheckAtTarget::FQuery(World.query_builder<const FPosition, const FTargetEntity, const FMaxTargetDistance>()
 		.term<FPosition>().in().self()
 		.term<FTargetEntity>().in().self()
 		.term<FMaxTargetDistance>().in().self()
@@ -36,28 +35,33 @@ void FCheckAtTargetSystem::Iter(const float DeltaTime, flecs::world& World) cons
 			const FVector TargetPosition = TargetEntity[IdxEntity].Value.get<FPosition>()->Value;
 			const float DistanceSquared = FVector::DistSquared(EntityPosition, TargetPosition);
 
-			if(DistanceSquared > TargetDistanceThresholdSquared)
+			// Only changes are queued; on a stage every add and remove is a command to merge later, even a redundant one.
+			const bool bAtTarget = DistanceSquared <= TargetDistanceThresholdSquared;
+			if(bAtTarget == Entity.has<FAtTarget>()) { continue; }
+
+			if(bAtTarget)
 			{
-				Entity.remove<FAtTarget>();
+				Entity.add<FAtTarget>();
 				continue;
 			}
 
-			Entity.add<FAtTarget>();
+			Entity.remove<FAtTarget>();
 		}
 	});
 }
 
-FSystemReadWriteUsage FCheckAtTargetSystem::GetSystemReadWriteUsage()
+void FCheckAtTargetSystem::Schedule(UnrealEcsSystemScheduler& Scheduler)
 {
-	return FSystemReadWriteUsage
+	Scheduler.AddStage(TEXT("CheckAtTarget"), GetSystemReadWriteUsage(), [this](const float DeltaTime, flecs::world& World)
 	{
-		.Reads = {
-			Position,
-			TargetEntity,
-			MaxTargetDistance
-		},
-		
-		.Writes ={
-		},
-	};
+		Iter(DeltaTime, World);
+	});
+}
+
+FSystemReadWriteUsage FCheckAtTargetSystem::GetSystemReadWriteUsage()
+{
+	// Radius and position of the target are read through get(), and the flag is added or removed per entity.
+	return FQueryCheckAtTarget::GetUsage()
+		.WithReads<FRadius>()
+		.WithWrites<FAtTarget>();
 }
@@ -1,22 +1,135 @@
 #include "UECS/Systems/PhysicsAndCollision/SystemGJKCA.h"
 
 #include "FlecsLibrary.h"
+#include "Hash/CityHash.h"
 #include "UECS/EcsComponentType.h"
 #include "UECS/CollisionHelper.h"
+#include "UECS/UnrealEcsSystemScheduler.h"
 #include "UECS/Components/AngularVelocity.h"
 #include "UECS/Components/BaseComponents.h"
 #include "UECS/Components/Stationary.h"
+#include "UECS/Components/PhysicsAndCollision/CcdMode.h"
 #include "UECS/Components/PhysicsAndCollision/CollisionEnabled.h"
 #include "UECS/Components/PhysicsAndCollision/CollisionSpatialGrid.h"
 #include "UECS/Components/PhysicsAndCollision/CollisionGridMember.h"
+#include "UECS/Components/PhysicsAndCollision/ConvexHullShape.h"
 #include "UECS/Components/PhysicsAndCollision/ICollisionHandler.h"
+#include "UECS/Components/PhysicsAndCollision/InverseMass.h"
 #include "UECS/Components/PhysicsAndCollision/NarrowPhaseCollisionCandidates.h"
 #include "UECS/Components/PhysicsAndCollision/NarrowPhaseEntityContacts.h"
 #include "UECS/Components/PhysicsAndCollision/OverlapCollision.h"
+#include "UECS/Components/PhysicsAndCollision/Sleeping.h"
 
 DECLARE_CYCLE_STAT(TEXT("SystemCollisionBroadPhase"), CS_SYSTEM_COLLISION_BROADPHASE, STATGROUP_ECS)
 DECLARE_CYCLE_STAT(TEXT("SystemCollisionNarrowPhase"), CS_SYSTEM_COLLISION_NARROWPHASE, STATGROUP_ECS)
+DECLARE_CYCLE_STAT(TEXT("SystemCollisionPairs"), CS_SYSTEM_COLLISION_PAIRS, STATGROUP_ECS)
 DECLARE_CYCLE_STAT(TEXT("SystemCollisionHashing"), CS_SYSTEM_COLLISION_HASHING, STATGROUP_ECS)
+DECLARE_CYCLE_STAT(TEXT("SystemCollisionSleep"), CS_SYSTEM_COLLISION_SLEEP, STATGROUP_ECS)
+DECLARE_CYCLE_STAT(TEXT("SystemCollisionContactSolver"), CS_SYSTEM_COLLISION_CONTACT_SOLVER, STATGROUP_ECS)
+DECLARE_DWORD_COUNTER_STAT(TEXT("CollisionAwakeEntities"), STAT_COLLISION_AWAKE_ENTITIES, STATGROUP_ECS)
+DECLARE_DWORD_COUNTER_STAT(TEXT("CollisionSleepingEntities"), STAT_COLLISION_SLEEPING_ENTITIES, STATGROUP_ECS)
+
+namespace
+{
+	// A ray is swept as a point.
+	FORCEINLINE FCollisionSweepQuery MakeRaycastSweep(const FCollisionRaycastQuery& Query)
+	{
+		return FCollisionSweepQuery {
+			.Shape = FSupportShape(FCollisionShape::MakeSphere(0.0f)),
+			.Start = FTransform(Query.Start),
+			.End = FTransform(Query.End),
+			.LayerMask = Query.LayerMask,
+			.IgnoreEntity = Query.IgnoreEntity
+		};
+	}
+
+	// Masks with a layer outside the layer matrix are clamped onto its last layer rather than shifting past the mask bits.
+	FORCEINLINE FCollisionFilter MakeCollisionFilter(const FCollisionMask* CollisionMask)
+	{
+		if(nullptr == CollisionMask) { return FCollisionFilter {}; }
+
+		uint8 Layer = CollisionMask->Layer;
+		if(Layer >= MaxCollisionLayers)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Collision layer %d is out of range, clamping to %d."), Layer, MaxCollisionLayers - 1);
+			Layer = MaxCollisionLayers - 1;
+		}
+
+		return FCollisionFilter { .Mask = CollisionMask->Mask, .Layer = Layer };
+	}
+
+	// Copies the filter of a grid member into its grid entry. The entry is only written if it still belongs to the entity,
+	// since the member may be mid-removal. Expects the collision world to be write locked.
+	FORCEINLINE void SetGridMemberFilter(const flecs::entity& Entity, FCollisionGridMember& GridMember, const FCollisionFilter& Filter)
+	{
+		GridMember.Filter = Filter;
+
+		FOctreeNode* OctreeNode = GridMember.OctreeNode;
+		if(nullptr == OctreeNode || !OctreeNode->Entities.IsValidIndex(GridMember.IndexInArray)) { return; }
+
+		FEntityPositionCache& GridEntry = OctreeNode->Entities[GridMember.IndexInArray];
+		if(GridEntry.Entity == Entity)
+		{
+			GridEntry.Filter = Filter;
+		}
+	}
+
+	FORCEINLINE bool IsAtRest(const FVelocity* Velocity, const FAngularVelocity* AngularVelocity, const uint64 IdxEntity,
+	                          const float LinearThresholdSquared, const float AngularThresholdSquared)
+	{
+		if(nullptr != Velocity && Velocity[IdxEntity].Value.SizeSquared() > LinearThresholdSquared) { return false; }
+		if(nullptr != AngularVelocity && AngularVelocity[IdxEntity].Value.SizeSquared() > AngularThresholdSquared) { return false; }
+
+		return true;
+	}
+
+	// Colours with fewer constraints than this per worker are solved on the calling thread.
+	constexpr int32 MinConstraintsPerSolverTask = 64;
+
+	// Distance between the bodies along the contact normal; negative while they overlap.
+	FORCEINLINE float GetSeparation(const FSolverBody& BodyA, const FSolverBody& BodyB, const FVector& Normal)
+	{
+		// Static bodies are shared between threads, so hull warm starts are only ever updated on local copies.
+		const FSupportShape ShapeA = BodyA.Shape;
+		const FSupportShape ShapeB = BodyB.Shape;
+		const FVector SupportA = FCollisionHelper::Support(ShapeA, BodyA.Transform, Normal);
+		const FVector SupportB = FCollisionHelper::Support(ShapeB, BodyB.Transform, -Normal);
+		return (SupportB - SupportA).Dot(Normal);
+	}
+
+	void SolveContactConstraint(FContactConstraint& Constraint, TArray<FSolverBody>& Bodies, const float DeltaTime, const float Slop, const float PositionCorrection)
+	{
+		FSolverBody& BodyA = Bodies[Constraint.IdxBodyA];
+		FSolverBody& BodyB = Bodies[Constraint.IdxBodyB];
+		const float InverseMassSum = BodyA.InverseMass + BodyB.InverseMass;
+		if(InverseMassSum <= 0.0f) { return; }
+
+		const FVector& Normal = Constraint.Normal;
+		const float Separation = GetSeparation(BodyA, BodyB, Normal);
+
+		// Position pass: push overlapping bodies apart, split by inverse mass.
+		if(Separation < -Slop)
+		{
+			const FVector Correction = Normal * ((-Separation - Slop) * PositionCorrection / InverseMassSum);
+			if(BodyA.IsDynamic()) { BodyA.Transform.AddToTranslation(-Correction * BodyA.InverseMass); }
+			if(BodyB.IsDynamic()) { BodyB.Transform.AddToTranslation(Correction * BodyB.InverseMass); }
+		}
+
+		// Velocity pass: remove the approaching part of the relative velocity, allowing bodies to close any remaining gap
+		// within the frame. The accumulated impulse is clamped so later iterations can relax but never pull.
+		const float NormalVelocity = (BodyB.Velocity - BodyA.Velocity).Dot(Normal);
+		const float Bias = FMath::Max(Separation, 0.0f) / DeltaTime;
+		const float Impulse = -(NormalVelocity + Bias) / InverseMassSum;
+
+		const float PreviousImpulse = Constraint.NormalImpulse;
+		Constraint.NormalImpulse = FMath::Max(PreviousImpulse + Impulse, 0.0f);
+		const FVector AppliedImpulse = Normal * (Constraint.NormalImpulse - PreviousImpulse);
+
+		// Static bodies are shared between the constraints of a colour, so they must never be written to.
+		if(BodyA.IsDynamic()) { BodyA.Velocity -= AppliedImpulse * BodyA.InverseMass; }
+		if(BodyB.IsDynamic()) { BodyB.Velocity += AppliedImpulse * BodyB.InverseMass; }
+	}
+}
 
 FSystemGJKCA::FSystemGJKCA(flecs::world& World)
 {
@@ -28,52 +141,99 @@ FSystemGJKCA::FSystemGJKCA(flecs::world& World)
 	.event(flecs::OnAdd).each([this](const flecs::iter& Iterator, uint64 IdxEntity, const FPosition& Position)
 	{
 		flecs::entity Entity = Iterator.entity(IdxEntity);
-		SpatialGrid.Add<FCollisionGridMember>(Entity, Position);
+		const FCollisionFilter Filter = MakeCollisionFilter(Entity.get<FCollisionMask>());
+		{
+			FWriteScopeLock WriteLock(CollisionWorldLock);
+			SpatialGrid.Add<FCollisionGridMember>(Entity, Position, ColliderTable.Allocate(), Filter);
+		}
 		Entity.add<FNarrowPhaseCollisionCandidates>();
 		Entity.add<FNarrowPhaseEntityContacts>();
+		Entity.add<FSleepState>();
 		// Print position
 		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, FString::Printf(TEXT("Position: %s"), *Position.Value.ToString()));
 	});
 
 	World.observer<const FCollisionGridMember>()
 		.term<FCollisionGridMember>().in().self()
-	.event(flecs::OnRemove).each([](const flecs::iter& Iterator, uint64 IdxEntity, const FCollisionGridMember& SpatialHashMember)
+	.event(flecs::OnRemove).each([this](const flecs::iter& Iterator, uint64 IdxEntity, const FCollisionGridMember& SpatialHashMember)
 	{
 		flecs::entity Entity = Iterator.entity(IdxEntity);
-		
-		FCollisionSpatialGrid* CollisionSpatialGrid = Iterator.world().get_mut<FCollisionSpatialGrid>();
-		if(nullptr != CollisionSpatialGrid)
 		{
-			CollisionSpatialGrid->Remove(SpatialHashMember);
-			return;
+			FWriteScopeLock WriteLock(CollisionWorldLock);
+			SpatialGrid.Remove(SpatialHashMember);
+			ColliderTable.Free(SpatialHashMember.ColliderId);
 		}
 
 		if(Entity.is_alive())
 		{
 			Entity.remove<FNarrowPhaseCollisionCandidates>();
 			Entity.remove<FNarrowPhaseEntityContacts>();
+			Entity.remove<FSleepState>();
+			Entity.remove<FSleeping>();
+		}
+	});
+
+	// Grid members that lose their transform or shape aren't reached by the collider table refresh any more, so their slot
+	// is cleared instead of keeping the last proxy written to it.
+	World.observer<const FTransformComponent, const FCollisionShape, const FCollisionGridMember>()
+		.term_at(3).filter()
+	.event(flecs::OnRemove).each([this](const FTransformComponent& Transform, const FCollisionShape& CollisionShape, const FCollisionGridMember& GridMember)
+	{
+		FWriteScopeLock WriteLock(CollisionWorldLock);
+		ColliderTable.Invalidate(GridMember.ColliderId);
+	});
+
+	// Keep the filter stored in the grid member and its grid entry in sync when the mask changes at runtime.
+	World.observer<const FCollisionMask, FCollisionGridMember>()
+		.term_at(2).filter()
+	.event(flecs::OnSet).each([this](const flecs::iter& Iterator, uint64 IdxEntity, const FCollisionMask& CollisionMask, FCollisionGridMember& GridMember)
+	{
+		const FCollisionFilter Filter = MakeCollisionFilter(&CollisionMask);
+
+		FWriteScopeLock WriteLock(CollisionWorldLock);
+		SetGridMemberFilter(Iterator.entity(IdxEntity), GridMember, Filter);
+	});
+
+	// Removing the mask puts the entity back on the default filter.
+	World.observer<const FCollisionMask, FCollisionGridMember>()
+		.term_at(2).filter()
+	.event(flecs::OnRemove).each([this](const flecs::iter& Iterator, uint64 IdxEntity, const FCollisionMask& CollisionMask, FCollisionGridMember& GridMember)
+	{
+		FWriteScopeLock WriteLock(CollisionWorldLock);
+		SetGridMemberFilter(Iterator.entity(IdxEntity), GridMember, FCollisionFilter {});
+	});
+
+	World.observer<const FCollisionHandler>()
+	.event(flecs::OnSet).each([this](const FCollisionHandler& CollisionHandler)
+	{
+		if(CollisionHandler.Handler.IsValid() && CollisionHandler.Handler->RegistrationId == INDEX_NONE)
+		{
+			CollisionHandler.Handler->RegistrationId = NextCollisionHandlerId++;
 		}
 	});
 
-	QueryChangedMembers = new flecs::query(
+	QueryChangedMembers = new FQueryChangedMembers::FQuery(
 		World.query_builder<const FPosition, FCollisionGridMember>()
 		          .term<FPosition>().in().self()
 		          .term<FCollisionGridMember>().in().self()
 		          .term<FStationary>().not_()
+		          .term<FSleeping>().not_()
 		          .build()
 	);
 	
-	QueryBroadPhase = new flecs::query(
-		World.query_builder<const FCollisionShape, const FPosition, const FVelocity, FNarrowPhaseCollisionCandidates>()
+	QueryBroadPhase = new FQueryBroadPhase::FQuery(
+		World.query_builder<const FCollisionShape, const FPosition, const FVelocity, FNarrowPhaseCollisionCandidates, const FCollisionGridMember>()
 		          .term_at(3).optional().self()
+		          .term_at(5).in().self()
 		          .term<FCollisionShape>().in().self()
 		          .term<FPosition>().in().self()
 		          .term<FCollisionEnabled>().in().self()
 		          .term<FStationary>().not_()
+		          .term<FSleeping>().not_()
 		          .build()
 	);
 
-	QueryNarrowPhase = new flecs::query(
+	QueryNarrowPhase = new FQueryNarrowPhase::FQuery(
 		World.query_builder<const FCollisionShape, const FTransformComponent, const FVelocity, const FAngularVelocity, FNarrowPhaseCollisionCandidates, FPosition, FNarrowPhaseEntityContacts>()
 		          .term<FCollisionShape>().in().self()
 		          .term<FTransformComponent>().in().self()
@@ -86,10 +246,11 @@ FSystemGJKCA::FSystemGJKCA(flecs::world& World)
 		          .term<FOverlapCollision>().in().self().optional()
 		          .term<FCollisionHandler>().in().self().optional()
 		          .term<FStationary>().not_()
+		          .term<FSleeping>().not_()
 		          .build()
 	);
 
-	QueryMovePath = new flecs::query(
+	QueryMovePath = new FQueryMovePath::FQuery(
 		World.query_builder<const FOneFrameMovementSequence, const FCollisionShape, const FVelocity, const FTransformComponent, const FAngularVelocity, FPosition, FNarrowPhaseCollisionCandidates, FNarrowPhaseEntityContacts>()
 				  .term<FOneFrameMovementSequence>().inout().self()
 				  .term<FCollisionShape>().in().self()
@@ -102,38 +263,145 @@ FSystemGJKCA::FSystemGJKCA(flecs::world& World)
 		          .term<FNarrowPhaseCollisionCandidates>().out().self()
 		          .term<FNarrowPhaseEntityContacts>().out().self()
 		          .term<FStationary>().not_()
+		          .term<FSleeping>().not_()
 		          .build()
 	);
 
-	QueryNarrowPhaseCollisionPairs = new flecs::query(
+	// Sleeping and stationary colliders stay in, as the frame after they stop moving is when their contacts end.
+	QueryNarrowPhaseCollisionPairs = new FQueryNarrowPhaseCollisionPairs::FQuery(
 		World.query_builder<const FPosition, FNarrowPhaseEntityContacts>()
 		          .term<FPosition>().in().self()
 		          .term<FNarrowPhaseEntityContacts>().in().self()
+		          .build()
+	);
+
+	QueryColliderTable = new FQueryColliderTable::FQuery(
+		World.query_builder<const FCollisionGridMember, const FTransformComponent, const FCollisionShape, const FVelocity, const FAngularVelocity, const FConvexHullShape>()
+		          .term_at(4).optional()
+		          .term_at(5).optional()
+		          .term_at(6).optional()
+		          .build()
+	);
+
+	QueryStateHash = new FQueryStateHash::FQuery(
+		World.query_builder<const FCollisionGridMember, const FPosition, const FVelocity>()
+		          .term_at(3).optional()
+		          .build()
+	);
+
+	QueryContactSolver = new FQueryContactSolver::FQuery(
+		World.query_builder<const FNarrowPhaseEntityContacts>()
+		          .term<FNarrowPhaseEntityContacts>().in().self()
+		          .term<FOverlapCollision>().not_()
+		          .term<FSleeping>().not_()
 		          .term<FStationary>().not_()
 		          .build()
 	);
 
+	// Overlap-only colliders report contacts but are never pushed around, so they never get a body.
+	QuerySolverBodies = new FQuerySolverBodies::FQuery(
+		World.query_builder<const FPosition, const FTransformComponent, const FCollisionShape, const FConvexHullShape, const FVelocity, const FInverseMass>()
+		          .term_at(4).optional()
+		          .term_at(5).optional()
+		          .term_at(6).optional()
+		          .term<FOverlapCollision>().not_()
+		          .build()
+	);
+
+	QuerySleepCandidates = new FQuerySleepCandidates::FQuery(
+		World.query_builder<const FNarrowPhaseEntityContacts, FSleepState, const FVelocity, const FAngularVelocity>()
+		          .term_at(3).optional()
+		          .term_at(4).optional()
+		          .term<FSleeping>().not_()
+		          .term<FStationary>().not_()
+		          .build()
+	);
+
+	QuerySleeping = new FQuerySleeping::FQuery(
+		World.query_builder<const FSleepState, const FVelocity, const FAngularVelocity>()
+		          .term_at(2).optional()
+		          .term_at(3).optional()
+		          .term<FSleeping>()
+		          .build()
+	);
+
 	SpatialGrid.PartitionSize = 1600.0f;
 }
 
 void FSystemGJKCA::Prep(int32 NumThreads)
 {
 	WorkerChangedMembers.Reset(NumThreads);
-	WorkerBroadPhase.Reset(NumThreads);
-	WorkerNarrowPhase.Reset(NumThreads);
-	WorkerMovePath.Reset(NumThreads);
-	WorkerNarrowPhaseCollisionPairs.Reset(NumThreads);
+	CollisionEvents.SetNum(NumThreads);
+	ConservativeAdvancementHistograms.SetNum(NumThreads);
+	NumWorkerThreads = FMath::Max(NumThreads, 1);
 	for(int32 IdxThread = 0; IdxThread < NumThreads; ++IdxThread)
 	{
 		WorkerChangedMembers.Add(QueryChangedMembers->worker(IdxThread, NumThreads));
-		WorkerBroadPhase.Add(QueryBroadPhase->worker(IdxThread, NumThreads));
-		WorkerNarrowPhase.Add(QueryNarrowPhase->worker(IdxThread, NumThreads));
-		WorkerMovePath.Add(QueryMovePath->worker(IdxThread, NumThreads));
-		WorkerNarrowPhaseCollisionPairs.Add(QueryNarrowPhaseCollisionPairs->worker(IdxThread, NumThreads));
 	}
+
+	// Nothing between the broadphase and the collision pairs changes which entities match, so all four are split up front.
+	ParallelBroadPhase.Reset(*QueryBroadPhase, NumThreads);
+	ParallelNarrowPhase.Reset(*QueryNarrowPhase, NumThreads);
+	ParallelMovePath.Reset(*QueryMovePath, NumThreads);
+	ParallelCollisionPairs.Reset(*QueryNarrowPhaseCollisionPairs, NumThreads);
 }
 
-void HemisphereBroadphase(float DeltaTime, const flecs::iter& Iterator, const FCollisionShape* CollisionShape, const FTransformComponent* Transform, const FVelocity* Velocity, FCollisionSpatialGrid& CollisionSpatialGrid, FNarrowPhaseCollisionCandidates* NarrowPhaseCollisionCandidates)
+void FSystemGJKCA::Schedule(UnrealEcsSystemScheduler& Scheduler, UWorld* World)
+{
+	// Hashing rewrites the grid under its lock and may draw debug bounds, so it gets the world to itself.
+	Scheduler.AddExclusiveStage(TEXT("CollisionHashing"), [this, World](const float DeltaTime, flecs::world& FlecsWorld)
+	{
+		Iter_Hashing(DeltaTime, FlecsWorld, World);
+	});
+
+	Scheduler.AddParallelStage(TEXT("CollisionBroadphase"), GetSystemReadWriteUsage(), [this](const float DeltaTime, flecs::world& FlecsWorld, const int32 IdxThread)
+	{
+		Iter_Broadphase(DeltaTime, FlecsWorld, IdxThread);
+	}, [this](float, const int32 NumThreads)
+	{
+		Prep(NumThreads);
+	}, [this]()
+	{
+		return ParallelBroadPhase.GetNumItems();
+	});
+
+	Scheduler.AddParallelStage(TEXT("CollisionNarrowPhase"), GetSystemReadWriteUsage(), [this](const float DeltaTime, flecs::world& FlecsWorld, const int32 IdxThread)
+	{
+		Iter_NarrowPhase(DeltaTime, FlecsWorld, IdxThread);
+	}, {}, [this]()
+	{
+		// Both passes balance by work stealing, so the slices that run cover every chunk; the count only sizes the fan-out.
+		return ParallelNarrowPhase.GetNumItems() + ParallelMovePath.GetNumItems();
+	});
+
+	// Shares the narrowphase's usage, so it only starts once every narrowphase worker is done with the contacts.
+	Scheduler.AddParallelStage(TEXT("CollisionPairs"), GetSystemReadWriteUsage(), [this](const float DeltaTime, flecs::world& FlecsWorld, const int32 IdxThread)
+	{
+		Iter_CollisionPairs(DeltaTime, FlecsWorld, IdxThread);
+	}, {}, [this]()
+	{
+		return ParallelCollisionPairs.GetNumItems();
+	});
+
+	// The colour count is only known once the contacts are in, so the solver fans out on its own within the stage.
+	Scheduler.AddExclusiveStage(TEXT("CollisionContactSolver"), [this](const float DeltaTime, flecs::world& FlecsWorld)
+	{
+		Iter_ContactSolver(DeltaTime, FlecsWorld);
+	});
+
+	// Handlers that aren't thread-safe may change the world.
+	Scheduler.AddExclusiveStage(TEXT("CollisionEvents"), [this](float, flecs::world&)
+	{
+		DispatchCollisionEvents();
+	});
+
+	Scheduler.AddExclusiveStage(TEXT("CollisionSleep"), [this](const float DeltaTime, flecs::world& FlecsWorld)
+	{
+		Iter_Sleep(DeltaTime, FlecsWorld);
+	});
+}
+
+void HemisphereBroadphase(float DeltaTime, const flecs::iter& Iterator, const FCollisionShape* CollisionShape, const FTransformComponent* Transform, const FVelocity* Velocity, const FCollisionGridMember* GridMember, FCollisionSpatialGrid& CollisionSpatialGrid, FNarrowPhaseCollisionCandidates* NarrowPhaseCollisionCandidates)
 {
 	thread_local TArray<FEntityPositionCache> EntitiesInHemisphere;
 	
@@ -149,16 +417,9 @@ void HemisphereBroadphase(float DeltaTime, const flecs::iter& Iterator, const FC
 		flecs::entity Entity = Iterator.entity(IdxEntity);
 		
 		EntitiesInHemisphere.SetNum(0, false);
-		CollisionSpatialGrid.GetEntitiesInHemisphere(Entity, MyPosition, Radius, TargetVelocity.Value.GetSafeNormal(), EntitiesInHemisphere);
-		
-		EntitiesInHemisphere.Sort([MyPosition](const FEntityPositionCache& A, const FEntityPositionCache& B)
-		{
-			const float DistanceA = (A.Position - MyPosition).SizeSquared();
-			const float DistanceB = (B.Position - MyPosition).SizeSquared();
-			
-			return DistanceA < DistanceB;
-		});
+		CollisionSpatialGrid.GetCollidableEntitiesInHemisphere(Entity, GridMember[IdxEntity].Filter, MyPosition, Radius, TargetVelocity.Value.GetSafeNormal(), EntitiesInHemisphere);
 
+		// Left unordered; the narrowphase orders candidates lazily as it sweeps them.
 		NarrowPhaseCollisionCandidates[IdxEntity].Entities = EntitiesInHemisphere;
 	}
 }
@@ -172,7 +433,8 @@ void FSystemGJKCA::DrawBounds(UWorld* World)
 	                              const FCollisionShape& CollisionShape,
 	                              const FPosition& Position,
 	                              const FVelocity& Velocity,
-	                              FNarrowPhaseCollisionCandidates& NarrowPhaseCollisionCandidates)
+	                              FNarrowPhaseCollisionCandidates& NarrowPhaseCollisionCandidates,
+	                              const FCollisionGridMember& GridMember)
 	{
 		switch(CollisionShape.ShapeType)
 		{
@@ -194,6 +456,12 @@ void FSystemGJKCA::Iter_Hashing(const float DeltaTime, flecs::world& FlecsWorld,
 {
 	{
 		SCOPE_CYCLE_COUNTER(CS_SYSTEM_COLLISION_HASHING)
+
+		// Callers driving the stages themselves may have skipped the sync point last frame. Their events are dispatched
+		// here, a frame late, rather than piling up in the worker buffers.
+		DispatchCollisionEvents();
+
+		FWriteScopeLock WriteLock(CollisionWorldLock);
 		
 		QueryChangedMembers->each(FlecsWorld, [this](const flecs::entity& Entity,
 			const FPosition& Position,
@@ -201,6 +469,42 @@ void FSystemGJKCA::Iter_Hashing(const float DeltaTime, flecs::world& FlecsWorld,
 		{
 			SpatialGrid.Change<FCollisionGridMember>(const_cast<flecs::entity&>(Entity), Position, SpatialHashMember);
 		});
+
+		// Refresh the dense collider table one archetype at a time, so the broadphase can gather candidates without component lookups.
+		QueryColliderTable->iter(FlecsWorld, [this](const flecs::iter& Iterator,
+			const FCollisionGridMember* GridMember,
+			const FTransformComponent* Transform,
+			const FCollisionShape* Shape,
+			const FVelocity* Velocity,
+			const FAngularVelocity* AngularVelocity,
+			const FConvexHullShape* ConvexHullShape)
+		{
+			const bool bOverlapOnly = Iterator.table().has<FOverlapCollision>();
+
+			for(const auto IdxEntity : Iterator)
+			{
+				const int32 ColliderId = GridMember[IdxEntity].ColliderId;
+				if(!ColliderTable.IsValidId(ColliderId)) { continue; }
+
+				FColliderProxy& Proxy = ColliderTable[ColliderId];
+				Proxy.Transform = Transform[IdxEntity].Value;
+				Proxy.Shape.Shape = Shape[IdxEntity];
+
+				// Keep the warm start vertex across frames unless the hull itself was swapped out. The proxy holds its own
+				// reference, so a freed hull can't come back at the same address and pass for the old one.
+				static const FConvexHullRef NoHull;
+				const FConvexHullRef& Hull = nullptr != ConvexHullShape ? ConvexHullShape[IdxEntity].Hull : NoHull;
+				if(Proxy.Shape.Hull != Hull)
+				{
+					Proxy.Shape.Hull = Hull;
+					Proxy.Shape.WarmStartVertex = 0;
+				}
+				Proxy.Velocity = nullptr != Velocity ? Velocity[IdxEntity].Value : FVector::ZeroVector;
+				Proxy.AngularVelocity = nullptr != AngularVelocity ? AngularVelocity[IdxEntity].Value : FVector::ZeroVector;
+				Proxy.Entity = Iterator.entity(IdxEntity);
+				Proxy.bOverlapOnly = bOverlapOnly;
+			}
+		});
 	}
 }
 
@@ -209,14 +513,28 @@ void FSystemGJKCA::Iter_Broadphase(const float DeltaTime, flecs::world& FlecsWor
 	{
 		SCOPE_CYCLE_COUNTER(CS_SYSTEM_COLLISION_BROADPHASE)
 		
-		WorkerBroadPhase[IdxThread].each(FlecsWorld, [DeltaTime, this](const flecs::entity& Entity,
-		                                                        const FCollisionShape& CollisionShape,
-		                                                        const FPosition& Position,
-		                                                        const FVelocity& Velocity,
-		                                                        FNarrowPhaseCollisionCandidates& NarrowPhaseCollisionCandidates)
+		auto BroadphaseFn = [DeltaTime, this](const flecs::entity& Entity,
+		                                      const FCollisionShape& CollisionShape,
+		                                      const FPosition& Position,
+		                                      const FVelocity& Velocity,
+		                                      FNarrowPhaseCollisionCandidates& NarrowPhaseCollisionCandidates,
+		                                      const FCollisionGridMember& GridMember)
 		{
-			FCollisionHelper::BoxBroadphase(DeltaTime, Entity, CollisionShape, Position, Velocity, SpatialGrid, NarrowPhaseCollisionCandidates.Entities);
-		});
+			// Movement sequences are swept as a single polyline, so their broadphase has to cover all of it.
+			const FOneFrameMovementSequence* MovementSequence = Entity.get<FOneFrameMovementSequence>();
+			if(nullptr != MovementSequence && MovementSequence->steps.Num() > 0)
+			{
+				FCollisionHelper::PolylineBroadphase(DeltaTime, Entity, Position, MovementSequence->steps, GridMember.Filter, SpatialGrid, NarrowPhaseCollisionCandidates.Entities);
+			}
+			else
+			{
+				FCollisionHelper::BoxBroadphase(DeltaTime, Entity, CollisionShape, Position, Velocity, GridMember.Filter, SpatialGrid, NarrowPhaseCollisionCandidates.Entities);
+			}
+
+			FCollisionHelper::GatherCandidates(ColliderTable, NarrowPhaseCollisionCandidates.Entities, NarrowPhaseCollisionCandidates.ColliderIds);
+		};
+
+		ParallelBroadPhase.Each(IdxThread, FlecsWorld, *QueryBroadPhase, BroadphaseFn);
 	}
 }
 
@@ -225,14 +543,14 @@ void FSystemGJKCA::Iter_NarrowPhase(const float DeltaTime, flecs::world& FlecsWo
 	{
 		SCOPE_CYCLE_COUNTER(CS_SYSTEM_COLLISION_NARROWPHASE)
 		
-		WorkerNarrowPhase[IdxThread].each(FlecsWorld, [DeltaTime, this](const flecs::entity& Entity,						
-		                                                     const FCollisionShape& CollisionShape,
-		                                                     const FTransformComponent& Transform,
-		                                                     const FVelocity& Velocity,
-		                                                     const FAngularVelocity& AngularVelocity,
-		                                                     FNarrowPhaseCollisionCandidates& NarrowPhaseCollisionCandidates,
-		                                                     FPosition& Position,
-															 FNarrowPhaseEntityContacts& NarrowPhaseContacts)
+		auto NarrowPhaseFn = [DeltaTime, IdxThread, this](const flecs::entity& Entity,
+		                                                  const FCollisionShape& CollisionShape,
+		                                                  const FTransformComponent& Transform,
+		                                                  const FVelocity& Velocity,
+		                                                  const FAngularVelocity& AngularVelocity,
+		                                                  FNarrowPhaseCollisionCandidates& NarrowPhaseCollisionCandidates,
+		                                                  FPosition& Position,
+		                                                  FNarrowPhaseEntityContacts& NarrowPhaseContacts)
 		{
 			float HitTime = 0.0f;
 			FCollisionHelper::NarrowPhase(
@@ -242,91 +560,777 @@ void FSystemGJKCA::Iter_NarrowPhase(const float DeltaTime, flecs::world& FlecsWo
 				Transform,
 				Velocity.Value,
 				AngularVelocity,
-				NarrowPhaseCollisionCandidates.Entities,
+				ColliderTable,
+				NarrowPhaseCollisionCandidates.ColliderIds,
+				NarrowPhaseCollisionCandidates.HullWarmStartVertex,
 				Position,
-				NarrowPhaseContacts.Contacts,
-				HitTime);
-		
-			Position.Value = Position.Value + Velocity.Value * DeltaTime * HitTime;
+				NarrowPhaseContacts,
+				HitTime,
+				ConservativeAdvancementHistograms[IdxThread],
+				!bDeterministic);
+
+			FVector Move = Velocity.Value * DeltaTime * HitTime;
+
+			// Static geometry has no entity to report contacts or events against; it only stops or deflects the move. Moves
+			// already cut short by a collider don't slide, so a slide can't carry the mover into what stopped it.
+			if(StaticWorldCollision.IsLoaded())
+			{
+				const FConvexHullShape* ConvexHullShape = Entity.get<FConvexHullShape>();
+				const FSupportShape Shape = nullptr != ConvexHullShape ? ConvexHullShape->MakeSupportShape(CollisionShape, NarrowPhaseCollisionCandidates.HullWarmStartVertex) : FSupportShape(CollisionShape);
+				const FTransform FinalTransform(Transform.Value.GetRotation() * (AngularVelocity.Value * DeltaTime).ToOrientationQuat(), Transform.Value.GetLocation() + Move, Transform.Value.GetScale3D());
+
+				SweepStaticWorld(Shape, Transform.Value, FinalTransform, FMath::IsNearlyEqual(HitTime, 1.0f), Move);
+			}
+
+			Position.Value += Move;
 
 			NarrowPhaseCollisionCandidates.Entities.Reset();
-		});
+			NarrowPhaseCollisionCandidates.ColliderIds.Reset();
+		};
+
+		ParallelNarrowPhase.Each(IdxThread, FlecsWorld, *QueryNarrowPhase, NarrowPhaseFn);
 
-		WorkerMovePath[IdxThread].each(FlecsWorld, [DeltaTime, this](const flecs::iter& Iterator,
-													 const size_t IdxEntity,
-													 const FOneFrameMovementSequence& MovementSequence,
-													 const FCollisionShape& CollisionShape,
-													 const FVelocity& Velocity,
-													 const FTransformComponent& Transform,
-													 const FAngularVelocity& AngularVelocity,
-													 FPosition& Position,
-													 FNarrowPhaseCollisionCandidates& NarrowPhaseCollisionCandidates,
-													 FNarrowPhaseEntityContacts& NarrowPhaseContacts)
+		auto MovePathFn = [DeltaTime, IdxThread, this](const flecs::iter& Iterator,
+		                                               const size_t IdxEntity,
+		                                               const FOneFrameMovementSequence& MovementSequence,
+		                                               const FCollisionShape& CollisionShape,
+		                                               const FVelocity& Velocity,
+		                                               const FTransformComponent& Transform,
+		                                               const FAngularVelocity& AngularVelocity,
+		                                               FPosition& Position,
+		                                               FNarrowPhaseCollisionCandidates& NarrowPhaseCollisionCandidates,
+		                                               FNarrowPhaseEntityContacts& NarrowPhaseContacts)
 		{
 			const flecs::entity Entity = Iterator.entity(IdxEntity);
 
-			// Print num contacts
-			for(int32 IdxStep = 0; IdxStep < MovementSequence.steps.Num(); ++IdxStep)
+			FPolylineSweepOutput SweepOutput;
+			FCollisionHelper::SweepPolyline(
+				DeltaTime,
+				Entity,
+				CollisionShape,
+				Transform,
+				MovementSequence.steps,
+				AngularVelocity,
+				ColliderTable,
+				NarrowPhaseCollisionCandidates.ColliderIds,
+				NarrowPhaseCollisionCandidates.HullWarmStartVertex,
+				NarrowPhaseContacts,
+				SweepOutput,
+				ConservativeAdvancementHistograms[IdxThread]
+			);
+
+			// The path is walked again up to where the dynamic sweep stopped it, and cut at the first static hit.
+			if(StaticWorldCollision.IsLoaded())
 			{
-				const FVector Step = MovementSequence.steps[IdxStep];
-				float HitTime = 0.0f;
-				FCollisionHelper::NarrowPhase(
-					DeltaTime,
-					Entity,
-					CollisionShape,
-					Transform,
-					Step,
-					AngularVelocity,
-					NarrowPhaseCollisionCandidates.Entities,
-					Position,
-					NarrowPhaseContacts.Contacts,
-					HitTime
-				);
-		
-				Position.Value += Velocity.Value * DeltaTime * HitTime;
+				const FConvexHullShape* ConvexHullShape = Entity.get<FConvexHullShape>();
+				const FSupportShape Shape = nullptr != ConvexHullShape ? ConvexHullShape->MakeSupportShape(CollisionShape, NarrowPhaseCollisionCandidates.HullWarmStartVertex) : FSupportShape(CollisionShape);
+
+				const int32 NumSegments = MovementSequence.steps.Num();
+				const int32 IdxLastSegment = SweepOutput.IdxSegment != INDEX_NONE ? SweepOutput.IdxSegment : NumSegments - 1;
+				const FQuat SegmentRotation = (AngularVelocity.Value * (DeltaTime / FMath::Max(NumSegments, 1))).ToOrientationQuat();
+
+				FTransform SegmentStart = Transform.Value;
+				SweepOutput.Displacement = FVector::ZeroVector;
+				for(int32 IdxSegment = 0; IdxSegment <= IdxLastSegment; ++IdxSegment)
+				{
+					const float SegmentTime = IdxSegment == SweepOutput.IdxSegment ? SweepOutput.Time : 1.0f;
+					const FTransform SegmentEnd(SegmentStart.GetRotation() * SegmentRotation, SegmentStart.GetLocation() + MovementSequence.steps[IdxSegment] * DeltaTime * SegmentTime, SegmentStart.GetScale3D());
+
+					FVector Move;
+					const bool bHitStatic = SweepStaticWorld(Shape, SegmentStart, SegmentEnd, false, Move);
+					SweepOutput.Displacement += Move;
+					if(bHitStatic) { break; }
+
+					SegmentStart = SegmentEnd;
+				}
 			}
 
+			Position.Value += SweepOutput.Displacement;
+
 			NarrowPhaseCollisionCandidates.Entities.Reset();
-		});
+			NarrowPhaseCollisionCandidates.ColliderIds.Reset();
+		};
+
+		ParallelMovePath.Each(IdxThread, FlecsWorld, *QueryMovePath, MovePathFn);
+	}
+}
+
+bool FSystemGJKCA::SweepStaticWorld(const FSupportShape& Shape, const FTransform& From, const FTransform& To, const bool bSlide, FVector& OutMove) const
+{
+	OutMove = To.GetLocation() - From.GetLocation();
+
+	FConservativeAdvancementOutput Hit;
+	if(!StaticWorldCollision.Sweep(Shape, From, To, Hit)) { return false; }
+
+	const FVector Remainder = OutMove * (1.0f - Hit.Time);
+	OutMove *= Hit.Time;
+
+	// Sweeps stopped short have no contact plane to back off from or slide along.
+	if(!Hit.bCollided) { return true; }
 
-		WorkerNarrowPhaseCollisionPairs[IdxThread].each(FlecsWorld, [this](const flecs::iter& Iterator,
+	// The normal points from the mover into the geometry.
+	const FVector& Normal = Hit.ContactNormal;
+	OutMove -= Normal * StaticContactOffset;
+
+	if(!bSlide) { return true; }
+
+	// Only the part of the remaining move heading into the surface is taken out.
+	const FVector Slide = Remainder - Normal * FMath::Max(Remainder.Dot(Normal), 0.0);
+	if(Slide.IsNearlyZero()) { return true; }
+
+	// The slide is swept once more, without sliding again, so it can't push the mover into another surface.
+	const FTransform SlideFrom(To.GetRotation(), From.GetLocation() + OutMove, To.GetScale3D());
+	const FTransform SlideTo(To.GetRotation(), SlideFrom.GetLocation() + Slide, To.GetScale3D());
+
+	FConservativeAdvancementOutput SlideHit;
+	if(!StaticWorldCollision.Sweep(Shape, SlideFrom, SlideTo, SlideHit))
+	{
+		OutMove += Slide;
+		return true;
+	}
+
+	OutMove += Slide * SlideHit.Time;
+	if(SlideHit.bCollided) { OutMove -= SlideHit.ContactNormal * StaticContactOffset; }
+
+	return true;
+}
+
+void FSystemGJKCA::Iter_CollisionPairs(const float DeltaTime, flecs::world& FlecsWorld, const int32 IdxThread)
+{
+	{
+		SCOPE_CYCLE_COUNTER(CS_SYSTEM_COLLISION_PAIRS)
+
+		TArray<FCollisionEvent>& ThreadCollisionEvents = CollisionEvents[IdxThread];
+
+		auto CollisionPairsFn = [&ThreadCollisionEvents](const flecs::iter& Iterator,
 			const size_t IdxEntity,
 			const FPosition& Position,
 			FNarrowPhaseEntityContacts& NarrowPhaseEntityContacts)
 		{
+			if(!NarrowPhaseEntityContacts.HasEvents()) { return; }
+
 			const flecs::entity Entity = Iterator.entity(IdxEntity);
-			for(auto& Candidate : NarrowPhaseEntityContacts.Contacts)
+			NarrowPhaseEntityContacts.ResolveEvents([&Entity, &ThreadCollisionEvents](FNarrowPhaseEntityContact& Contact)
 			{
-				// GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Iter_NarrowPhase"));
-				const flecs::entity& EntityHit = Candidate.EntityHit;
-				const bool bHasCollisionHandler = EntityHit.has<FCollisionHandler>();
-				if(!bHasCollisionHandler) { continue; }
-		
-				const FCollisionHandler* CollisionHandler = EntityHit.get<FCollisionHandler>();
-				CollisionHandler->Handler->Handle(Candidate, Entity);
+				// A destroyed entity can't be asked for its handler any more, so its end event goes to the one cached
+				// when the contact was last seen.
+				const flecs::entity& EntityHit = Contact.EntityHit;
+				if(EntityHit.is_alive())
+				{
+					const FCollisionHandler* CollisionHandler = EntityHit.get<FCollisionHandler>();
+					Contact.Handler = nullptr != CollisionHandler ? CollisionHandler->Handler : nullptr;
+				}
+				else if(Contact.Event != ENarrowPhaseContactEvent::End)
+				{
+					Contact.Handler = nullptr;
+				}
+
+				if(!Contact.Handler.IsValid()) { return; }
+
+				// Handlers that only subscribe to begin/end never see the steady-state persist events.
+				if(!EnumHasAnyFlags(Contact.Handler->GetSubscribedEvents(), Contact.Event)) { return; }
+
+				ThreadCollisionEvents.Add({ .Contact = Contact, .Entity = Entity, .Handler = Contact.Handler });
+			});
+		};
+
+		ParallelCollisionPairs.Each(IdxThread, FlecsWorld, *QueryNarrowPhaseCollisionPairs, CollisionPairsFn);
+
+		if(bDispatchThreadSafeHandlersOnWorkers && !bDeterministic)
+		{
+			DispatchCollisionEventBatches(ThreadCollisionEvents, true);
+		}
+	}
+}
+
+FConservativeAdvancementHistogram FSystemGJKCA::GetConservativeAdvancementHistogram() const
+{
+	FConservativeAdvancementHistogram Merged;
+	for(const FConservativeAdvancementHistogram& Histogram : ConservativeAdvancementHistograms)
+	{
+		Merged.Append(Histogram);
+	}
+
+	return Merged;
+}
+
+void FSystemGJKCA::ResetConservativeAdvancementHistogram()
+{
+	for(FConservativeAdvancementHistogram& Histogram : ConservativeAdvancementHistograms)
+	{
+		Histogram.Reset();
+	}
+}
+
+void FSystemGJKCA::SetLayersCollide(const int32 LayerA, const int32 LayerB, const bool bCollide)
+{
+	if(LayerA < 0 || LayerA >= MaxCollisionLayers || LayerB < 0 || LayerB >= MaxCollisionLayers)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SetLayersCollide: layers %d and %d must be in [0, %d)."), LayerA, LayerB, MaxCollisionLayers);
+		return;
+	}
+
+	FWriteScopeLock WriteLock(CollisionWorldLock);
+	SpatialGrid.LayerMatrix.SetLayersCollide(LayerA, LayerB, bCollide);
+}
+
+bool FSystemGJKCA::OverlapShape(const FCollisionOverlapQuery& Query, TArray<FCollisionQueryHit>& OutHits)
+{
+	FReadScopeLock ReadLock(CollisionWorldLock);
+	return OverlapShape_Locked(Query, OutHits);
+}
+
+bool FSystemGJKCA::SweepShape(const FCollisionSweepQuery& Query, FCollisionQueryHit& OutHit)
+{
+	FReadScopeLock ReadLock(CollisionWorldLock);
+	return SweepShape_Locked(Query, OutHit);
+}
+
+bool FSystemGJKCA::Raycast(const FCollisionRaycastQuery& Query, FCollisionQueryHit& OutHit)
+{
+	FReadScopeLock ReadLock(CollisionWorldLock);
+	return SweepShape_Locked(MakeRaycastSweep(Query), OutHit);
+}
+
+void FSystemGJKCA::OverlapShapes(const TConstArrayView<FCollisionOverlapQuery> Queries, TArray<FCollisionQueryHit>& OutHits, TArray<int32>& OutHitOffsets)
+{
+	FReadScopeLock ReadLock(CollisionWorldLock);
+
+	OutHits.Reset();
+	OutHitOffsets.Reset(Queries.Num() + 1);
+	OutHitOffsets.Add(0);
+
+	for(const FCollisionOverlapQuery& Query : Queries)
+	{
+		OverlapShape_Locked(Query, OutHits);
+		OutHitOffsets.Add(OutHits.Num());
+	}
+}
+
+void FSystemGJKCA::SweepShapes(const TConstArrayView<FCollisionSweepQuery> Queries, TArray<FCollisionQueryHit>& OutHits)
+{
+	FReadScopeLock ReadLock(CollisionWorldLock);
+
+	OutHits.SetNum(Queries.Num());
+	for(int32 IdxQuery = 0; IdxQuery < Queries.Num(); ++IdxQuery)
+	{
+		SweepShape_Locked(Queries[IdxQuery], OutHits[IdxQuery]);
+	}
+}
+
+void FSystemGJKCA::Raycasts(const TConstArrayView<FCollisionRaycastQuery> Queries, TArray<FCollisionQueryHit>& OutHits)
+{
+	FReadScopeLock ReadLock(CollisionWorldLock);
+
+	OutHits.SetNum(Queries.Num());
+	for(int32 IdxQuery = 0; IdxQuery < Queries.Num(); ++IdxQuery)
+	{
+		SweepShape_Locked(MakeRaycastSweep(Queries[IdxQuery]), OutHits[IdxQuery]);
+	}
+}
+
+bool FSystemGJKCA::OverlapShape_Locked(const FCollisionOverlapQuery& Query, TArray<FCollisionQueryHit>& OutHits)
+{
+	const FVector Extents(FCollisionHelper::GetBoundingRadius(Query.Shape, Query.Transform) + QueryCandidateMargin);
+	const FVector Location = Query.Transform.GetLocation();
+
+	// Queries may be shared between threads, so their hull warm starts are only updated on a local copy.
+	const FSupportShape QueryShape = Query.Shape;
+
+	thread_local TArray<FEntityPositionCache> Candidates;
+	Candidates.Reset();
+	SpatialGrid.GetQueryableEntitiesInBox(Query.IgnoreEntity, Query.LayerMask, FBox(Location - Extents, Location + Extents), Candidates);
+
+	bool bHit = false;
+	for(const FEntityPositionCache& Candidate : Candidates)
+	{
+		if(!ColliderTable.IsLiveId(Candidate.ColliderId)) { continue; }
+
+		// Work on a copy of the shape so the proxy's hull warm start isn't raced on.
+		const FColliderProxy& Proxy = ColliderTable[Candidate.ColliderId];
+		const FSupportShape CandidateShape = Proxy.Shape;
+
+		const FCollisionOutput Output = FCollisionHelper::GJK_Complex(QueryShape, Query.Transform, CandidateShape, Proxy.Transform);
+		if(!Output.bDidOverlap) { continue; }
+
+		OutHits.Add({ .Entity = Proxy.Entity.id(), .Time = 0.0f, .Point = Output.ClosestA, .Normal = Output.Normal });
+		bHit = true;
+	}
+
+	return bHit;
+}
+
+bool FSystemGJKCA::SweepShape_Locked(const FCollisionSweepQuery& Query, FCollisionQueryHit& OutHit)
+{
+	OutHit = FCollisionQueryHit {};
+
+	const FVector Extents(FCollisionHelper::GetBoundingRadius(Query.Shape, Query.Start) + QueryCandidateMargin);
+	const FVector Start = Query.Start.GetLocation();
+	const FVector End = Query.End.GetLocation();
+	const FBox Bounds(FVector::Min(Start, End) - Extents, FVector::Max(Start, End) + Extents);
+	const FSupportShape QueryShape = Query.Shape;
+
+	thread_local TArray<FEntityPositionCache> Candidates;
+	Candidates.Reset();
+	SpatialGrid.GetQueryableEntitiesInBox(Query.IgnoreEntity, Query.LayerMask, Bounds, Candidates);
+
+	float HitTime = 1.0f;
+	for(const FEntityPositionCache& Candidate : Candidates)
+	{
+		if(!ColliderTable.IsLiveId(Candidate.ColliderId)) { continue; }
+
+		const FColliderProxy& Proxy = ColliderTable[Candidate.ColliderId];
+		const FSupportShape CandidateShape = Proxy.Shape;
+
+		const FConservativeAdvancementOutput Output = FCollisionHelper::ConservativeAdvancement(QueryShape, Query.Start, Query.End, CandidateShape, Proxy.Transform, Proxy.Transform);
+		if(!Output.bCollided || (OutHit.IsHit() && Output.Time >= HitTime)) { continue; }
+
+		HitTime = Output.Time;
+		OutHit = { .Entity = Proxy.Entity.id(), .Time = Output.Time, .Point = Output.ContactPoint, .Normal = Output.ContactNormal };
+	}
+
+	return OutHit.IsHit();
+}
+
+void FSystemGJKCA::DispatchCollisionEvents()
+{
+	MergedCollisionEvents.Reset();
+	for(TArray<FCollisionEvent>& ThreadCollisionEvents : CollisionEvents)
+	{
+		MergedCollisionEvents.Append(MoveTemp(ThreadCollisionEvents));
+		ThreadCollisionEvents.Reset();
+	}
+
+	DispatchCollisionEventBatches(MergedCollisionEvents, false);
+}
+
+void FSystemGJKCA::DispatchCollisionEventBatches(TArray<FCollisionEvent>& Events, const bool bThreadSafeOnly)
+{
+	if(Events.Num() <= 0) { return; }
+	
+	// Group events by handler so each handler gets a single batch, with handlers in registration order. Within a batch,
+	// events are ordered by the entities involved rather than by which worker happened to find them. Only handlers that
+	// never went through an OnSet, and so have no registration id, fall back to their address.
+	Events.Sort([](const FCollisionEvent& A, const FCollisionEvent& B)
+	{
+		const int32 RegistrationIdA = A.Handler->RegistrationId;
+		const int32 RegistrationIdB = B.Handler->RegistrationId;
+		if(RegistrationIdA != RegistrationIdB) { return RegistrationIdA < RegistrationIdB; }
+		if(A.Handler.Get() != B.Handler.Get()) { return A.Handler.Get() < B.Handler.Get(); }
+		if(A.Entity.id() != B.Entity.id()) { return A.Entity.id() < B.Entity.id(); }
+		if(A.Contact.EntityHit.id() != B.Contact.EntityHit.id()) { return A.Contact.EntityHit.id() < B.Contact.EntityHit.id(); }
+		return A.Contact.Event < B.Contact.Event;
+	});
+
+	// Events for handlers that can't run here are compacted to the front of the array and kept for the sync point.
+	int32 NumDeferred = 0;
+	for(int32 IdxStart = 0; IdxStart < Events.Num();)
+	{
+		ICollisionHandler* Handler = Events[IdxStart].Handler.Get();
+
+		int32 IdxEnd = IdxStart + 1;
+		while(IdxEnd < Events.Num() && Events[IdxEnd].Handler.Get() == Handler) { ++IdxEnd; }
+
+		if(!bThreadSafeOnly || Handler->IsThreadSafe())
+		{
+			Handler->HandleBatch(TConstArrayView<FCollisionEvent>(Events.GetData() + IdxStart, IdxEnd - IdxStart));
+		}
+		else
+		{
+			for(int32 IdxEvent = IdxStart; IdxEvent < IdxEnd; ++IdxEvent, ++NumDeferred)
+			{
+				if(IdxEvent != NumDeferred) { Events[NumDeferred] = MoveTemp(Events[IdxEvent]); }
 			}
-		
-			NarrowPhaseEntityContacts.Contacts.Reset();
-		});
+		}
+
+		IdxStart = IdxEnd;
 	}
+
+	Events.SetNum(NumDeferred, EAllowShrinking::No);
 }
 
-FSystemReadWriteUsage FSystemGJKCA::GetSystemReadWriteUsage()
+void FSystemGJKCA::Iter_ContactSolver(const float DeltaTime, flecs::world& FlecsWorld)
+{
+	PrepContactSolver(DeltaTime, FlecsWorld);
+
+	TArray<UE::Tasks::FTask> SolverTasks;
+	for(int32 IdxIteration = 0; IdxIteration < NumContactSolverIterations; ++IdxIteration)
+	{
+		for(int32 IdxColor = 0; IdxColor < ContactColors.Num(); ++IdxColor)
+		{
+			// Small colours aren't worth the fan-out, so the calling thread covers every worker's share of them.
+			if(IdxColor == IdxSerialContactColor || ContactColors[IdxColor].Num() < NumWorkerThreads * MinConstraintsPerSolverTask)
+			{
+				for(int32 IdxThread = 0; IdxThread < NumWorkerThreads; ++IdxThread)
+				{
+					Iter_SolveContacts(IdxColor, IdxThread);
+				}
+				continue;
+			}
+
+			SolverTasks.Reset();
+			for(int32 IdxThread = 1; IdxThread < NumWorkerThreads; ++IdxThread)
+			{
+				SolverTasks.Add(UE::Tasks::Launch(TEXT("CollisionContactSolver"), [this, IdxColor, IdxThread]() { Iter_SolveContacts(IdxColor, IdxThread); }));
+			}
+			Iter_SolveContacts(IdxColor, 0);
+			UE::Tasks::Wait(SolverTasks);
+		}
+	}
+
+	FinishContactSolver();
+}
+
+void FSystemGJKCA::PrepContactSolver(const float DeltaTime, flecs::world& FlecsWorld)
+{
+	SCOPE_CYCLE_COUNTER(CS_SYSTEM_COLLISION_CONTACT_SOLVER)
+
+	ContactSolverDeltaTime = DeltaTime;
+	SolverBodies.Reset();
+	SolverContacts.Reset();
+	SolverBodyIndices.Reset();
+	SolverPairs.Reset();
+	ContactConstraints.Reset();
+	ContactColors.Reset();
+	IdxSerialContactColor = INDEX_NONE;
+
+	if(DeltaTime <= 0.0f) { return; }
+
+	// Contacts are collected first, noting the colliders they involve, so the bodies can be gathered in a single pass over
+	// the collider tables rather than looked up one entity at a time.
+	QueryContactSolver->iter(FlecsWorld, [this](const flecs::iter& Iterator, const FNarrowPhaseEntityContacts* NarrowPhaseContacts)
+	{
+		for(const auto IdxEntity : Iterator)
+		{
+			const FNarrowPhaseContactArray& Contacts = NarrowPhaseContacts[IdxEntity].GetResolvedContacts();
+			if(Contacts.Num() <= 0) { continue; }
+
+			const uint64 EntityA = Iterator.entity(IdxEntity).id();
+			SolverBodyIndices.FindOrAdd(EntityA, INDEX_NONE);
+
+			for(const FNarrowPhaseEntityContact& Contact : Contacts)
+			{
+				const uint64 EntityB = Contact.EntityHit.id();
+				SolverBodyIndices.FindOrAdd(EntityB, INDEX_NONE);
+
+				SolverContacts.Add({ .Normal = Contact.ContactNormal.GetSafeNormal(), .EntityA = EntityA, .EntityB = EntityB });
+			}
+		}
+	});
+
+	if(SolverContacts.Num() <= 0) { return; }
+
+	// Dead colliders and those without a body never show up here, so their contacts are dropped below.
+	QuerySolverBodies->iter(FlecsWorld, [this](const flecs::iter& Iterator, const FPosition* Position, const FTransformComponent* Transform,
+	                                           const FCollisionShape* Shape, const FConvexHullShape* ConvexHullShape, const FVelocity* Velocity,
+	                                           const FInverseMass* InverseMass)
+	{
+		// Sleeping and stationary colliders, and anything without a velocity, act as static geometry for this frame.
+		const bool bDynamic = nullptr != Velocity && !Iterator.table().has<FSleeping>() && !Iterator.table().has<FStationary>();
+
+		for(const auto IdxEntity : Iterator)
+		{
+			const flecs::entity Entity = Iterator.entity(IdxEntity);
+			int32* IdxBody = SolverBodyIndices.Find(Entity.id());
+			if(nullptr == IdxBody) { continue; }
+
+			*IdxBody = SolverBodies.Num();
+			FSolverBody& Body = SolverBodies.AddDefaulted_GetRef();
+			Body.Entity = Entity;
+			Body.Shape = nullptr != ConvexHullShape ? ConvexHullShape[IdxEntity].MakeSupportShape(Shape[IdxEntity]) : FSupportShape(Shape[IdxEntity]);
+			Body.Transform = Transform[IdxEntity].Value;
+			Body.Transform.SetLocation(Position[IdxEntity].Value);
+
+			if(bDynamic)
+			{
+				Body.Velocity = Velocity[IdxEntity].Value;
+				Body.InverseMass = nullptr != InverseMass ? FMath::Max(InverseMass[IdxEntity].Value, 0.0f) : 1.0f;
+			}
+		}
+	});
+
+	for(const FSolverContact& Contact : SolverContacts)
+	{
+		const int32 IdxBodyA = SolverBodyIndices.FindChecked(Contact.EntityA);
+		const int32 IdxBodyB = SolverBodyIndices.FindChecked(Contact.EntityB);
+		if(IdxBodyA == INDEX_NONE || IdxBodyB == INDEX_NONE) { continue; }
+
+		// Both sides of a pair usually report the contact; only the first one becomes a constraint.
+		const uint64 PairKey = (static_cast<uint64>(FMath::Min(IdxBodyA, IdxBodyB)) << 32) | static_cast<uint64>(FMath::Max(IdxBodyA, IdxBodyB));
+		bool bAlreadySolved = false;
+		SolverPairs.Add(PairKey, &bAlreadySolved);
+		if(bAlreadySolved) { continue; }
+
+		ContactConstraints.Add({ .Normal = Contact.Normal, .IdxBodyA = IdxBodyA, .IdxBodyB = IdxBodyB });
+	}
+
+	// Greedy colouring: each constraint takes the lowest colour unused by either of its dynamic bodies. Static bodies are
+	// only read, so they never force a new colour.
+	for(int32 IdxConstraint = 0; IdxConstraint < ContactConstraints.Num(); ++IdxConstraint)
+	{
+		const FContactConstraint& Constraint = ContactConstraints[IdxConstraint];
+		FSolverBody& BodyA = SolverBodies[Constraint.IdxBodyA];
+		FSolverBody& BodyB = SolverBodies[Constraint.IdxBodyB];
+
+		const uint64 UsedColors = (BodyA.IsDynamic() ? BodyA.ColorMask : 0) | (BodyB.IsDynamic() ? BodyB.ColorMask : 0);
+		if(UsedColors == MAX_uint64)
+		{
+			if(IdxSerialContactColor == INDEX_NONE) { IdxSerialContactColor = 64; }
+			ContactColors.SetNum(FMath::Max(ContactColors.Num(), IdxSerialContactColor + 1));
+			ContactColors[IdxSerialContactColor].Add(IdxConstraint);
+			continue;
+		}
+
+		const int32 IdxColor = static_cast<int32>(FMath::CountTrailingZeros64(~UsedColors));
+		BodyA.ColorMask |= 1ull << IdxColor;
+		BodyB.ColorMask |= 1ull << IdxColor;
+
+		ContactColors.SetNum(FMath::Max(ContactColors.Num(), IdxColor + 1));
+		ContactColors[IdxColor].Add(IdxConstraint);
+	}
+}
+
+void FSystemGJKCA::Iter_SolveContacts(const int32 IdxColor, const int32 IdxThread)
 {
-	return FSystemReadWriteUsage {
-		.Reads = {
-			EEcsComponentType::Position,
-			EEcsComponentType::CollisionShape,
-			EEcsComponentType::TransformComponent,
-			EEcsComponentType::Velocity,
-			EEcsComponentType::AngularVelocity,
-			EEcsComponentType::CollisionEnabled,
-			EEcsComponentType::NarrowPhaseCollisionCandidates,
-			EEcsComponentType::CollisionGridMember
-		},
-		.Writes = {
-			EEcsComponentType::Position,
-			EEcsComponentType::NarrowPhaseEntityContacts
+	SCOPE_CYCLE_COUNTER(CS_SYSTEM_COLLISION_CONTACT_SOLVER)
+
+	if(!ContactColors.IsValidIndex(IdxColor)) { return; }
+	if(IdxColor == IdxSerialContactColor && IdxThread != 0) { return; }
+
+	const TArray<int32>& Constraints = ContactColors[IdxColor];
+	const int32 NumThreads = IdxColor == IdxSerialContactColor ? 1 : NumWorkerThreads;
+	const int32 IdxStart = Constraints.Num() * IdxThread / NumThreads;
+	const int32 IdxEnd = Constraints.Num() * (IdxThread + 1) / NumThreads;
+
+	for(int32 Idx = IdxStart; Idx < IdxEnd; ++Idx)
+	{
+		SolveContactConstraint(ContactConstraints[Constraints[Idx]], SolverBodies, ContactSolverDeltaTime, ContactSlop, ContactPositionCorrection);
+	}
+}
+
+void FSystemGJKCA::FinishContactSolver()
+{
+	SCOPE_CYCLE_COUNTER(CS_SYSTEM_COLLISION_CONTACT_SOLVER)
+
+	for(FSolverBody& Body : SolverBodies)
+	{
+		if(!Body.IsDynamic() || !Body.Entity.is_alive()) { continue; }
+
+		// Written in place, so change detection and OnSet observers are told explicitly.
+		Body.Entity.get_mut<FPosition>()->Value = Body.Transform.GetLocation();
+		Body.Entity.modified<FPosition>();
+		Body.Entity.get_mut<FVelocity>()->Value = Body.Velocity;
+		Body.Entity.modified<FVelocity>();
+	}
+}
+
+void FSystemGJKCA::Iter_Sleep(const float DeltaTime, flecs::world& FlecsWorld)
+{
+	SCOPE_CYCLE_COUNTER(CS_SYSTEM_COLLISION_SLEEP)
+
+	const float LinearThresholdSquared = FMath::Square(SleepLinearVelocityThreshold);
+	const float AngularThresholdSquared = FMath::Square(SleepAngularVelocityThreshold);
+
+	IslandEntities.Reset();
+	IslandParents.Reset();
+	IslandNodeIdle.Reset();
+	IslandEdges.Reset();
+	IslandNodeIndices.Reset();
+	IslandsToWake.Reset();
+
+	// Sleeping entities whose velocity was changed from outside the collision pipeline wake their whole island.
+	int32 NumSleeping = 0;
+	QuerySleeping->iter(FlecsWorld, [this, &NumSleeping, LinearThresholdSquared, AngularThresholdSquared](const flecs::iter& Iterator,
+		const FSleepState* SleepState,
+		const FVelocity* Velocity,
+		const FAngularVelocity* AngularVelocity)
+	{
+		for(const auto IdxEntity : Iterator)
+		{
+			++NumSleeping;
+			if(IsAtRest(Velocity, AngularVelocity, IdxEntity, LinearThresholdSquared, AngularThresholdSquared)) { continue; }
+
+			IslandsToWake.AddUnique(SleepState[IdxEntity].IslandId);
+		}
+	});
+
+	// Every awake collider becomes an island node, linked to the colliders it touched during this frame's narrowphase.
+	QuerySleepCandidates->iter(FlecsWorld, [this, LinearThresholdSquared, AngularThresholdSquared](const flecs::iter& Iterator,
+		const FNarrowPhaseEntityContacts* NarrowPhaseContacts,
+		FSleepState* SleepState,
+		const FVelocity* Velocity,
+		const FAngularVelocity* AngularVelocity)
+	{
+		for(const auto IdxEntity : Iterator)
+		{
+			FSleepState& State = SleepState[IdxEntity];
+			State.IdleFrames = IsAtRest(Velocity, AngularVelocity, IdxEntity, LinearThresholdSquared, AngularThresholdSquared) ? State.IdleFrames + 1 : 0;
+
+			const flecs::entity Entity = Iterator.entity(IdxEntity);
+			const int32 IdxNode = IslandEntities.Add(Entity);
+			IslandParents.Add(IdxNode);
+			IslandNodeIdle.Add(State.IdleFrames >= SleepFrames);
+			IslandNodeIndices.Add(Entity.id(), IdxNode);
+
+			for(const FNarrowPhaseEntityContact& Contact : NarrowPhaseContacts[IdxEntity].GetResolvedContacts())
+			{
+				IslandEdges.Emplace(IdxNode, Contact.EntityHit);
+			}
 		}
+	});
+
+	for(const TPair<int32, flecs::entity>& Edge : IslandEdges)
+	{
+		const int32* IdxOther = IslandNodeIndices.Find(Edge.Value.id());
+		if(nullptr != IdxOther)
+		{
+			IslandParents[FindIslandRoot(Edge.Key)] = FindIslandRoot(*IdxOther);
+			continue;
+		}
+
+		// A moving collider touching a sleeping one wakes it up; resting ones can lie on top of it without doing so.
+		if(IslandNodeIdle[Edge.Key] || !Edge.Value.is_alive() || !Edge.Value.has<FSleeping>()) { continue; }
+
+		IslandsToWake.AddUnique(Edge.Value.get<FSleepState>()->IslandId);
+	}
+
+	// An island only falls asleep once every one of its members has been idle for long enough.
+	TArray<bool, TInlineAllocator<64>> IslandCanSleep;
+	IslandCanSleep.Init(true, IslandEntities.Num());
+	for(int32 IdxNode = 0; IdxNode < IslandEntities.Num(); ++IdxNode)
+	{
+		if(IslandNodeIdle[IdxNode]) { continue; }
+
+		IslandCanSleep[FindIslandRoot(IdxNode)] = false;
+	}
+
+	// Structural changes are applied once iteration is over, so the queries above never see their tables move.
+	int32 NumWoken = 0;
+	for(const int32 IslandId : IslandsToWake)
+	{
+		NumWoken += WakeIsland(IslandId);
+	}
+
+	TArray<int32, TInlineAllocator<64>> RootIslandIds;
+	RootIslandIds.Init(INDEX_NONE, IslandEntities.Num());
+	int32 NumFellAsleep = 0;
+	for(int32 IdxNode = 0; IdxNode < IslandEntities.Num(); ++IdxNode)
+	{
+		const int32 IdxRoot = FindIslandRoot(IdxNode);
+		if(!IslandCanSleep[IdxRoot]) { continue; }
+
+		if(RootIslandIds[IdxRoot] == INDEX_NONE)
+		{
+			RootIslandIds[IdxRoot] = NextIslandId++;
+			SleepingIslands.Add(RootIslandIds[IdxRoot]);
+		}
+
+		flecs::entity& Entity = IslandEntities[IdxNode];
+		SleepingIslands[RootIslandIds[IdxRoot]].Add(Entity);
+
+		Entity.get_mut<FSleepState>()->IslandId = RootIslandIds[IdxRoot];
+		if(FVelocity* Velocity = Entity.get_mut<FVelocity>()) { Velocity->Value = FVector::ZeroVector; }
+		if(FAngularVelocity* AngularVelocity = Entity.get_mut<FAngularVelocity>()) { AngularVelocity->Value = FVector::ZeroVector; }
+		Entity.add<FSleeping>();
+
+		++NumFellAsleep;
+	}
+
+	SET_DWORD_STAT(STAT_COLLISION_AWAKE_ENTITIES, IslandEntities.Num() - NumFellAsleep + NumWoken);
+	SET_DWORD_STAT(STAT_COLLISION_SLEEPING_ENTITIES, NumSleeping + NumFellAsleep - NumWoken);
+}
+
+void FSystemGJKCA::WakeEntity(const flecs::entity& Entity)
+{
+	if(!Entity.is_alive() || !Entity.has<FSleeping>()) { return; }
+
+	WakeIsland(Entity.get<FSleepState>()->IslandId);
+}
+
+int32 FSystemGJKCA::WakeIsland(const int32 IslandId)
+{
+	TArray<flecs::entity> Members;
+	if(!SleepingIslands.RemoveAndCopyValue(IslandId, Members)) { return 0; }
+
+	int32 NumWoken = 0;
+	for(flecs::entity& Member : Members)
+	{
+		if(!Member.is_alive()) { continue; }
+
+		FSleepState* SleepState = Member.get_mut<FSleepState>();
+		if(nullptr != SleepState)
+		{
+			SleepState->IdleFrames = 0;
+			SleepState->IslandId = INDEX_NONE;
+		}
+
+		Member.remove<FSleeping>();
+		++NumWoken;
+	}
+
+	return NumWoken;
+}
+
+int32 FSystemGJKCA::FindIslandRoot(int32 IdxNode)
+{
+	while(IslandParents[IdxNode] != IdxNode)
+	{
+		// Path halving keeps the trees shallow without a second pass.
+		IslandParents[IdxNode] = IslandParents[IslandParents[IdxNode]];
+		IdxNode = IslandParents[IdxNode];
+	}
+
+	return IdxNode;
+}
+
+uint64 FSystemGJKCA::HashCollisionState(flecs::world& FlecsWorld)
+{
+	struct FHashedCollider
+	{
+		uint64 Id;
+		FVector Position;
+		FVector Velocity;
 	};
+
+	TArray<FHashedCollider> Colliders;
+	QueryStateHash->iter(FlecsWorld, [&Colliders](const flecs::iter& Iterator, const FCollisionGridMember* GridMember, const FPosition* Position, const FVelocity* Velocity)
+	{
+		for(const auto IdxEntity : Iterator)
+		{
+			Colliders.Add({
+				.Id = Iterator.entity(IdxEntity).id(),
+				.Position = Position[IdxEntity].Value,
+				.Velocity = nullptr != Velocity ? Velocity[IdxEntity].Value : FVector::ZeroVector
+			});
+		}
+	});
+
+	Colliders.Sort([](const FHashedCollider& A, const FHashedCollider& B) { return A.Id < B.Id; });
+
+	// Bitwise, so even a last-bit difference shows up.
+	uint64 Hash = 0;
+	for(const FHashedCollider& Collider : Colliders)
+	{
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&Collider), sizeof(FHashedCollider), Hash);
+	}
+
+	return Hash;
+}
+
+FSystemReadWriteUsage FSystemGJKCA::GetSystemReadWriteUsage()
+{
+	// On top of the query terms, colliders are filtered and flagged through tags, the table reads mass and CCD settings
+	// per entity, and the contact solver writes velocities of the bodies it pushes apart.
+	return (FQueryBroadPhase::GetUsage()
+		| FQueryMovePath::GetUsage()
+		| FQueryNarrowPhase::GetUsage()
+		| FQueryChangedMembers::GetUsage()
+		| FQueryNarrowPhaseCollisionPairs::GetUsage()
+		| FQueryColliderTable::GetUsage()
+		| FQuerySleepCandidates::GetUsage()
+		| FQuerySleeping::GetUsage()
+		| FQueryContactSolver::GetUsage()
+		| FQuerySolverBodies::GetUsage())
+		.WithReads<FCollisionEnabled, FStationary, FInverseMass, FCcdMode>()
+		.WithWrites<FSleeping, FSleepState, FVelocity, FAngularVelocity>();
 }
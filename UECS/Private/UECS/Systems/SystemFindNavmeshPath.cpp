@@ -3,6 +3,7 @@
 #include "NavigationSystem.h"
 #include "NavMesh/RecastNavMesh.h"
 #include "UECS/DetourNavigation.h"
+#include "UECS/UnrealEcsSystemScheduler.h"
 #include "UECS/Components/BaseComponents.h"
 #include "UECS/Components/MovementInput.h"
 #include "UECS/Components/NavmeshPathRequest.h"
@@ -10,22 +11,18 @@
 
 SystemFindNavmeshPath::SystemFindNavmeshPath(flecs::world& World)
 {
-	QueryPathRequests   = new flecs::query(World.query<const FNavmeshAgent, const FNavmeshPathRequest>());
-	QueryNavmeshInput   = new flecs::query(World.query<const FNavmeshAgent, const FPosition, const FMovementInput, const FSpeed, FOneFrameMovementSequence>());
-	QueryEnqueueMovement = new flecs::query(World.query<FNavmeshPathResponse, FOneFrameMovementSequence, FPosition, FSpeed, FVelocity>());
+	QueryPathRequests    = new FQueryPathRequests::FQuery(World.query<const FNavmeshAgent, const FNavmeshPathRequest>());
+	QueryNavmeshInput    = new FQueryNavmeshInput::FQuery(World.query<const FNavmeshAgent, FPosition, FMovementInput, const FSpeed, FOneFrameMovementSequence>());
+	QueryEnqueueMovement = new FQueryEnqueueMovement::FQuery(World.query<FNavmeshPathResponse, FOneFrameMovementSequence, const FPosition, const FSpeed, const FVelocity>());
 }
 
-void SystemFindNavmeshPath::Prep(int32 NumThreads)
+void SystemFindNavmeshPath::Prep(const float DeltaTime, int32 NumThreads)
 {
-	WorkerPathRequests.Reset(NumThreads);
-	WorkerNavmeshInput.Reset(NumThreads);
-	WorkerEnqueueMovement.Reset(NumThreads);
-	for(int32 IdxThread = 0; IdxThread < NumThreads; ++IdxThread)
-	{
-		WorkerPathRequests.Add(QueryPathRequests->worker(IdxThread, NumThreads));
-		WorkerNavmeshInput.Add(QueryNavmeshInput->worker(IdxThread, NumThreads));
-		WorkerEnqueueMovement.Add(QueryEnqueueMovement->worker(IdxThread, NumThreads));
-	}
+	PathRequestSlicer.Advance(DeltaTime);
+
+	ParallelPathRequests.Reset(*QueryPathRequests, NumThreads);
+	ParallelNavmeshInput.Reset(*QueryNavmeshInput, NumThreads);
+	ParallelEnqueueMovement.Reset(*QueryEnqueueMovement, NumThreads);
 }
 
 void SystemFindNavmeshPath::Iter_FindPath(const float DeltaTime, flecs::world& World, UWorld* UnrealWorld, const int32 IdxThread) const
@@ -36,28 +33,39 @@ void SystemFindNavmeshPath::Iter_FindPath(const float DeltaTime, flecs::world& W
 	ARecastNavMesh* NavData = Cast<ARecastNavMesh>(NavSystem->GetMainNavData());
 	if(nullptr == NavData) { return; }
 
-	dtNavMesh* NavMesh = NavData->GetRecastMesh();
+	Iter_FindPath(DeltaTime, World, NavData->GetRecastMesh(), IdxThread);
+}
+
+void SystemFindNavmeshPath::Iter_FindPath(const float DeltaTime, flecs::world& World, dtNavMesh* NavMesh, const int32 IdxThread) const
+{
 	if(nullptr == NavMesh) { return; }
 
-	WorkerPathRequests[IdxThread].each([NavMesh](const flecs::iter& Iterator, size_t IdxEntity, const FNavmeshAgent& Agent, const FNavmeshPathRequest& Request)
+	auto FindPathFn = [this, NavMesh](const flecs::iter& Iterator, size_t IdxEntity, const FNavmeshAgent& Agent, const FNavmeshPathRequest& Request)
 	{
+		if(!PathRequestSlicer.IsInSlice(Iterator.entity(IdxEntity).id())) { return; }
+
 		const FDetourNavigation DetourNavigation(NavMesh);
 		
 		FNavmeshPathResponse Response;
 		Response.Status = DetourNavigation.FindPath(Request.Start, Request.End, Agent.Extents, Response.Points);
 
+		// Queued on the stage the query is iterated with, so the agent only changes tables once the segment is merged. The answered request goes in the same batch, so it isn't searched again next frame. Failed requests
+		// stay to be retried.
 		if(Response.Status != DT_FAILURE)
 		{
 			flecs::entity Entity = Iterator.entity(IdxEntity);
-			//Entity.set(Response);
+			Entity.set(Response);
+			Entity.remove<FNavmeshPathRequest>();
 		}
-	});
+	};
+
+	ParallelPathRequests.Each(IdxThread, World, *QueryPathRequests, FindPathFn);
 }
 
 void SystemFindNavmeshPath::Iter_EnqueueMovement(const float DeltaTime, flecs::world& World, UWorld* UnrealWorld, const int32 IdxThread) const
 {
-	WorkerEnqueueMovement[IdxThread].each([DeltaTime](const flecs::iter& Iterator, size_t Idx, FNavmeshPathResponse& Path,
-		FOneFrameMovementSequence& Movement, const FPosition& Position, const FSpeed& Speed, const FVelocity& Velocity)
+	auto EnqueueMovementFn = [DeltaTime](const flecs::iter& Iterator, size_t Idx, FNavmeshPathResponse& Path,
+	                                     FOneFrameMovementSequence& Movement, const FPosition& Position, const FSpeed& Speed, const FVelocity& Velocity)
 	{
 		// No path points? No movement.
 		auto& PathPoints = Path.Points;
@@ -125,9 +133,11 @@ void SystemFindNavmeshPath::Iter_EnqueueMovement(const float DeltaTime, flecs::w
 		if(IdxPathPoint >= NumPathPoints - 1)
 		{
 			flecs::entity Entity = Iterator.entity(Idx);
-			//Entity.remove<FNavmeshPathResponse>();
+			Entity.remove<FNavmeshPathResponse>();
 		}
-	});
+	};
+
+	ParallelEnqueueMovement.Each(IdxThread, World, *QueryEnqueueMovement, EnqueueMovementFn);
 }
 
 void SystemFindNavmeshPath::Iter_NavmeshInput(const float DeltaTime, flecs::world& World, UWorld* UnrealWorld, const int32 IdxThread) const
@@ -141,13 +151,13 @@ void SystemFindNavmeshPath::Iter_NavmeshInput(const float DeltaTime, flecs::worl
 	dtNavMesh* NavMesh = NavData->GetRecastMesh();
 	if(nullptr == NavMesh) { return; }
 	
-	WorkerNavmeshInput[IdxThread].each([this, NavMesh, DeltaTime](const flecs::iter& Iterator,
-	                                                              const size_t IdxEntity,
-	                                                              const FNavmeshAgent& Agent,
-	                                                              const FPosition& Position,
-	                                                              const FMovementInput& Input,
-	                                                              const FSpeed& Speed,
-	                                                              FOneFrameMovementSequence& Movement)
+	auto NavmeshInputFn = [this, NavMesh, DeltaTime](const flecs::iter& Iterator,
+	                                                 const size_t IdxEntity,
+	                                                 const FNavmeshAgent& Agent,
+	                                                 FPosition& Position,
+	                                                 FMovementInput& Input,
+	                                                 const FSpeed& Speed,
+	                                                 FOneFrameMovementSequence& Movement)
 	{
 		Movement.steps.Reset();
 		
@@ -162,10 +172,43 @@ void SystemFindNavmeshPath::Iter_NavmeshInput(const float DeltaTime, flecs::worl
 
 		const FVector FinalLocation = bDidHit ? End * HitTime : End;
 
-		const_cast<FPosition&>(Position).Value = FinalLocation;
-		const_cast<FMovementInput&>(Input).Input = FVector::ZeroVector;
+		Position.Value = FinalLocation;
+		Input.Input = FVector::ZeroVector;
 			
 		Movement.steps.Add(FinalLocation);
+	};
+
+	ParallelNavmeshInput.Each(IdxThread, World, *QueryNavmeshInput, NavmeshInputFn);
+}
+
+void SystemFindNavmeshPath::Schedule(UnrealEcsSystemScheduler& Scheduler, UWorld* UnrealWorld)
+{
+	// Prep counts every query up front, so the adaptive fan-out reads the counts it already dealt out.
+	Scheduler.AddParallelStage(TEXT("NavmeshFindPath"), GetSystemReadWriteUsage_FindPath(), [this, UnrealWorld](const float DeltaTime, flecs::world& World, const int32 IdxThread)
+	{
+		Iter_FindPath(DeltaTime, World, UnrealWorld, IdxThread);
+	}, [this](const float DeltaTime, const int32 NumThreads)
+	{
+		Prep(DeltaTime, NumThreads);
+	}, [this]()
+	{
+		return ParallelPathRequests.GetNumItems();
+	});
+
+	Scheduler.AddParallelStage(TEXT("NavmeshEnqueueMovement"), GetSystemReadWriteUsage_EnqueueMovement(), [this, UnrealWorld](const float DeltaTime, flecs::world& World, const int32 IdxThread)
+	{
+		Iter_EnqueueMovement(DeltaTime, World, UnrealWorld, IdxThread);
+	}, {}, [this]()
+	{
+		return ParallelEnqueueMovement.GetNumItems();
+	});
+
+	Scheduler.AddParallelStage(TEXT("NavmeshInput"), GetSystemReadWriteUsage_NavmeshInput(), [this, UnrealWorld](const float DeltaTime, flecs::world& World, const int32 IdxThread)
+	{
+		Iter_NavmeshInput(DeltaTime, World, UnrealWorld, IdxThread);
+	}, {}, [this]()
+	{
+		return ParallelNavmeshInput.GetNumItems();
 	});
 }
 
@@ -186,47 +229,17 @@ int32 SystemFindNavmeshPath::GetCount_NavmeshInput() const
 
 FSystemReadWriteUsage SystemFindNavmeshPath::GetSystemReadWriteUsage_FindPath()
 {
-	return FSystemReadWriteUsage {
-		.Reads = {
-			FNavmeshAgent::GetTypeId(),
-			FNavmeshPathRequest::GetTypeId(),
-		},
-		.Writes = {
-		}
-	};
+	// Found paths are handed to the agent as a response, and its request removed.
+	return FQueryPathRequests::GetUsage()
+		.WithWrites<FNavmeshPathResponse, FNavmeshPathRequest>();
 }
 
 FSystemReadWriteUsage SystemFindNavmeshPath::GetSystemReadWriteUsage_EnqueueMovement()
 {
-	return FSystemReadWriteUsage {
-		.Reads = {
-			FNavmeshAgent::GetTypeId(),
-			FNavmeshPathRequest::GetTypeId(),
-			FPosition::GetTypeId(),
-			FMovementInput::GetTypeId(),
-			FSpeed::GetTypeId()
-		},
-		.Writes = {
-			FOneFrameMovementSequence::GetTypeId(),
-			FNavmeshPathResponse::GetTypeId(),
-			FPosition::GetTypeId(),
-			FSpeed::GetTypeId(),
-			FVelocity::GetTypeId()
-		}
-	};
+	return FQueryEnqueueMovement::GetUsage();
 }
 
 FSystemReadWriteUsage SystemFindNavmeshPath::GetSystemReadWriteUsage_NavmeshInput()
 {
-	return FSystemReadWriteUsage {
-		.Reads = {
-			FNavmeshAgent::GetTypeId(),
-			FPosition::GetTypeId(),
-			FMovementInput::GetTypeId(),
-			FSpeed::GetTypeId()
-		},
-		.Writes = {
-			FOneFrameMovementSequence::GetTypeId(),
-		}
-	};
+	return FQueryNavmeshInput::GetUsage();
 }
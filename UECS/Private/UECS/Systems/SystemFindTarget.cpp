@@ -28,6 +28,8 @@ void FSystemFindTarget::CheckPotentialTargets(flecs::world& World) const
 		{
 			for(const auto Idx : Iterator)
 			{
+				if(!TimeSlicer.IsInSlice(Iterator.entity(Idx).id())) { continue; }
+
 				for(const AActor* SearchTarget : PotentialTarget[Idx].PotentialTargets)
 				{
 					if(!IsValid(SearchTarget)) { continue; }
@@ -105,6 +107,8 @@ void FSystemFindTarget::AsyncUnrealOverlapForTargets(flecs::world& World)
 			
 			for(const auto IdxEntity : Iterator)
 			{
+				if(!TimeSlicer.IsInSlice(Iterator.entity(IdxEntity).id())) { continue; }
+
 				const FCollisionShape AggroOverlapShape = FCollisionShape::MakeSphere(AggroSearch[IdxEntity].Radius);
 				FCollisionQueryParams QueryParams;
 				QueryParams.AddIgnoredActor(Actor->Actor);
@@ -129,6 +133,8 @@ void FSystemFindTarget::AsyncUnrealOverlapForTargets(flecs::world& World)
 
 void FSystemFindTarget::Iter(const float DeltaTime, flecs::world& World)
 {
+	TimeSlicer.Advance(DeltaTime);
+
 	AsyncUnrealOverlapForTargets(World);
 	CheckPotentialTargets(World);
 }
@@ -1,13 +1,14 @@
 #include "UECS/Systems/SystemIntegrateVelocity.h"
 
 #include "UECS/flecs.h"
+#include "UECS/UnrealEcsSystemScheduler.h"
 #include "UECS/Components/BaseComponents.h"
 
 void FSystemIntegrateVelocity::Initialize(UWorldSubsystem* InOwner, flecs::world* InEcsWorld)
 {
 	UnrealEcsSystem::Initialize(InOwner, InEcsWorld);
 
-	Query = new flecs::query
+	Query = new FQueryIntegrate::FQuery
 	(
 		InEcsWorld->query_builder<const FVelocity, FPosition>()
 			.term<FVelocity>().in()
@@ -30,4 +31,14 @@ void FSystemIntegrateVelocity::Iter(const float DeltaTime, flecs::world& World)
 void FSystemIntegrateVelocity::Schedule(UnrealEcsSystemScheduler* InScheduler)
 {
 	UnrealEcsSystem::Schedule(InScheduler);
+
+	InScheduler->AddStage(TEXT("IntegrateVelocity"), GetSystemReadWriteUsage(), [this](const float DeltaTime, flecs::world& World)
+	{
+		Iter(DeltaTime, World);
+	});
+}
+
+FSystemReadWriteUsage FSystemIntegrateVelocity::GetSystemReadWriteUsage()
+{
+	return FQueryIntegrate::GetUsage();
 }
@@ -1,20 +1,46 @@
 #include "UECS/Systems/SystemPackTransforms.h"
 
+#include "FlecsLibrary.h"
+#include "UECS/EcsRenderState.h"
 #include "UECS/Components/BaseComponents.h"
+#include "UECS/Components/FixedStepClock.h"
+#include "UECS/Components/PreviousPosition.h"
+#include "UECS/Components/RenderTransform.h"
 #include "UECS/Components/SyncTransformBackToUnreal.h"
 #include "UECS/Components/SyncTransformsFromUnrealToEcs.h"
 
+DECLARE_FLOAT_COUNTER_STAT(TEXT("PackTransforms skip ratio"), STAT_PackTransformsSkipRatio, STATGROUP_ECS)
+DECLARE_FLOAT_COUNTER_STAT(TEXT("PackTransforms actor skip ratio"), STAT_PackTransformsActorSkipRatio, STATGROUP_ECS)
+
 SystemPackTransforms::SystemPackTransforms(flecs::world& World)
 {
-	QueryTransforms = new flecs::query(World.query_builder<const FPosition, const FRotationComponent, const FScale, const FTransformComponent, FTransformComponent>()
+	// Interpolated entities get a render transform of their own, so the simulated pose is never overwritten.
+	World.observer<const FPreviousPosition>()
+		.event(flecs::OnAdd).each([](const flecs::iter& Iterator, uint64 IdxEntity, const FPreviousPosition& PreviousPosition)
+	{
+		Iterator.entity(IdxEntity).add<FRenderTransform>();
+	});
+
+	World.observer<const FPreviousPosition>()
+		.event(flecs::OnRemove).each([](const flecs::iter& Iterator, uint64 IdxEntity, const FPreviousPosition& PreviousPosition)
+	{
+		flecs::entity Entity = Iterator.entity(IdxEntity);
+		if(Entity.is_alive()) { Entity.remove<FRenderTransform>(); }
+	});
+
+	QueryTransforms = new flecs::query(World.query_builder<const FPosition, const FRotationComponent, const FScale, const FTransformComponent, FTransformComponent, const FPreviousPosition, FRenderTransform>()
 		.term_at(1).in().self()
 		.term_at(2).in().self()
 		.term_at(3).in().self()
 		.term_at(4).in().parent().optional().cascade()
 		.term_at(5).out().self()
+		.term_at(6).in().self().optional()
+		.term_at(7).out().self().optional()
 		.build());
 
-	QueryEcsToUnrealActors = new flecs::query(World.query_builder<FActorComponent, const FTransformComponent>()
+	// Only read, so the actor pass doesn't mark its own actor column dirty and can skip tables with ActorChangeFilter.
+	QueryEcsToUnrealActors = new flecs::query(World.query_builder<const FActorComponent, const FTransformComponent, const FRenderTransform>()
+		.term_at(3).in().self().optional()
 		.term<FActorComponent>().in()
 		.term<FTransformComponent>().in()
 		.term<FSyncTransformBackToUnreal>().in()
@@ -31,38 +57,51 @@ SystemPackTransforms::SystemPackTransforms(flecs::world& World)
 
 void SystemPackTransforms::Iter(const float DeltaTime, flecs::world& FlecsWorld) const
 {
-	QueryTransforms->iter(FlecsWorld, [](const flecs::iter& Iterator, const FPosition* Position, const FRotationComponent* Rotation, const FScale* Scale, const FTransformComponent* ParentTransform, FTransformComponent* Transform)
+	UpdateTransforms(FlecsWorld);
+
+	ActorChangeFilter.bEnabled = ChangeFilter.bEnabled;
+	ActorChangeFilter.BeginRun();
+
+	QueryEcsToUnrealActors->iter(FlecsWorld, [this](flecs::iter& Iterator, const FActorComponent* Actor, const FTransformComponent* Transform, const FRenderTransform* RenderTransform)
 	{
-		const bool bHasParentTransform = nullptr != ParentTransform;
-		
+		if(!ActorChangeFilter.ShouldProcess(Iterator)) { return; }
+
 		for(const auto IdxEntity : Iterator)
 		{
-			FVector EntityPosition = Position[IdxEntity].Value;
-			FQuat EntityRotation = Rotation[IdxEntity].Value;
-			FVector EntityScale = Scale[IdxEntity].value;
-			
-			if(bHasParentTransform)
-			{
-				EntityPosition += ParentTransform->Value.GetTranslation();
-				// Print offset position
-				GEngine->AddOnScreenDebugMessage(0, 5.0f, FColor::Red, FString::Printf(TEXT("Offset Position: %s"), *EntityPosition.ToString()));
-
-				// Print parent position
-				GEngine->AddOnScreenDebugMessage(1, 5.0f, FColor::Red, FString::Printf(TEXT("Parent Position: %s"), *ParentTransform->Value.GetTranslation().ToString()));
-			}
-			
-			Transform[IdxEntity].Value.SetComponents(EntityRotation, EntityPosition, EntityScale);
+			Actor[IdxEntity].Actor->SetActorTransform(nullptr != RenderTransform ? RenderTransform[IdxEntity].Value : Transform[IdxEntity].Value);
 		}
 	});
-	
-	QueryEcsToUnrealActors->iter(FlecsWorld, [](const flecs::iter& Iterator, FActorComponent* Actor, const FTransformComponent* Transform)
+
+	SET_FLOAT_STAT(STAT_PackTransformsActorSkipRatio, ActorChangeFilter.GetSkipRatio());
+
+	SyncActorsToEcs(FlecsWorld);
+}
+
+void SystemPackTransforms::Pack(const float DeltaTime, flecs::world& FlecsWorld, FEcsRenderState& RenderState) const
+{
+	UpdateTransforms(FlecsWorld);
+
+	ActorChangeFilter.bEnabled = ChangeFilter.bEnabled;
+	ActorChangeFilter.BeginRun();
+
+	FEcsRenderBuffer& Buffer = RenderState.GetWriteBuffer();
+	QueryEcsToUnrealActors->iter(FlecsWorld, [this, &Buffer](flecs::iter& Iterator, const FActorComponent* Actor, const FTransformComponent* Transform, const FRenderTransform* RenderTransform)
 	{
+		if(!ActorChangeFilter.ShouldProcess(Iterator)) { return; }
+
+		// Actors are only resolved from their entities on the game thread.
 		for(const auto IdxEntity : Iterator)
 		{
-			Actor[IdxEntity].Actor->SetActorTransform(Transform[IdxEntity].Value);
+			Buffer.ActorEntities.Emplace(Iterator.entity(IdxEntity).id());
+			Buffer.ActorTransforms.Emplace(nullptr != RenderTransform ? RenderTransform[IdxEntity].Value : Transform[IdxEntity].Value);
 		}
 	});
 
+	SET_FLOAT_STAT(STAT_PackTransformsActorSkipRatio, ActorChangeFilter.GetSkipRatio());
+}
+
+void SystemPackTransforms::SyncActorsToEcs(flecs::world& FlecsWorld) const
+{
 	QueryActorsToEcs->iter(FlecsWorld,[](const flecs::iter& Iterator, const FActorComponent* Actor, FPosition* Position, FRotationComponent* Rotation, FScale* Scale)
 	{
 		for(const auto IdxEntity : Iterator)
@@ -73,5 +112,60 @@ void SystemPackTransforms::Iter(const float DeltaTime, flecs::world& FlecsWorld)
 			Scale[IdxEntity].value = Transform.GetScale3D();
 		}
 	});
-	
+}
+
+void SystemPackTransforms::UpdateTransforms(flecs::world& FlecsWorld) const
+{
+	const FFixedStepClock* FixedStepClock = FlecsWorld.get<FFixedStepClock>();
+	const float Alpha = nullptr != FixedStepClock ? FixedStepClock->Alpha : 1.0f;
+	const bool bAlphaChanged = Alpha != LastAlpha;
+	LastAlpha = Alpha;
+
+	ChangeFilter.BeginRun();
+
+	QueryTransforms->iter(FlecsWorld, [this, Alpha, bAlphaChanged](flecs::iter& Iterator, const FPosition* Position, const FRotationComponent* Rotation, const FScale* Scale,
+	                                                               const FTransformComponent* ParentTransform, FTransformComponent* Transform, const FPreviousPosition* PreviousPosition,
+	                                                               FRenderTransform* RenderTransform)
+	{
+		const bool bHasParentTransform = nullptr != ParentTransform;
+		const bool bInterpolate = nullptr != PreviousPosition && nullptr != RenderTransform;
+
+		// Interpolated entities move with the clock's alpha even when none of their columns were written.
+		if(!ChangeFilter.ShouldProcess(Iterator, bInterpolate && bAlphaChanged)) { return; }
+		
+		for(const auto IdxEntity : Iterator)
+		{
+			FVector EntityPosition = Position[IdxEntity].Value;
+			FQuat EntityRotation = Rotation[IdxEntity].Value;
+			FVector EntityScale = Scale[IdxEntity].value;
+			FVector ParentOffset = FVector::ZeroVector;
+			
+			if(bHasParentTransform)
+			{
+				ParentOffset = ParentTransform->Value.GetTranslation();
+				EntityPosition += ParentOffset;
+
+				// On-screen messages are game thread only, and Pack may run on a worker.
+				if(IsInGameThread())
+				{
+					// Print offset position
+					GEngine->AddOnScreenDebugMessage(0, 5.0f, FColor::Red, FString::Printf(TEXT("Offset Position: %s"), *EntityPosition.ToString()));
+
+					// Print parent position
+					GEngine->AddOnScreenDebugMessage(1, 5.0f, FColor::Red, FString::Printf(TEXT("Parent Position: %s"), *ParentOffset.ToString()));
+				}
+			}
+			
+			// The simulation sweeps from this transform, so it has to stay at the simulated pose.
+			Transform[IdxEntity].Value.SetComponents(EntityRotation, EntityPosition, EntityScale);
+
+			if(bInterpolate)
+			{
+				const FVector RenderPosition = FMath::Lerp(PreviousPosition[IdxEntity].Value, Position[IdxEntity].Value, Alpha) + ParentOffset;
+				RenderTransform[IdxEntity].Value.SetComponents(EntityRotation, RenderPosition, EntityScale);
+			}
+		}
+	});
+
+	SET_FLOAT_STAT(STAT_PackTransformsSkipRatio, ChangeFilter.GetSkipRatio());
 }
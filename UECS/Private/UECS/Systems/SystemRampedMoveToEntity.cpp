@@ -2,7 +2,6 @@
 
 #include "FlecsLibrary.h"
 
-#include "UECS/EcsComponentType.h"
 #include "UECS/Components/RampedMoveToEntity.h"
 #include "UECS/Components/BaseComponents.h"
 
@@ -10,7 +9,7 @@ DECLARE_CYCLE_STAT(TEXT("SystemRampedMoveToEntity"), CS_SYSTEM_MOVE_TO_ENTITY, S
 
 FSystemRampedMoveToEntity::FSystemRampedMoveToEntity(flecs::world& World)
 {
-	QueryRampedMove = new flecs::query(
+	QueryRampedMove = new FQueryRampedMove::FQuery(
 		World.query_builder<const FPosition, FVelocity, FRampedMoveToEntity>()
 			.term<FPosition>().in().self()
 			.term<FVelocity>().inout().self()
@@ -49,15 +48,5 @@ void FSystemRampedMoveToEntity::Iter(const float DeltaTime, flecs::world& World)
 
 FSystemReadWriteUsage FSystemRampedMoveToEntity::GetSystemReadWriteUsage()
 {
-	return {
-		.Reads = {
-			EEcsComponentType::Position,
-			EEcsComponentType::Velocity,
-			EEcsComponentType::RampedMoveToEntity
-		},
-		.Writes = {
-			EEcsComponentType::Velocity,
-			EEcsComponentType::RampedMoveToEntity
-		} 
-	};
+	return FQueryRampedMove::GetUsage();
 }
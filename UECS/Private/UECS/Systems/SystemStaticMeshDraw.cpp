@@ -1,6 +1,11 @@
 #include "UECS/Systems/SystemStaticMeshDraw.h"
+#include "FlecsLibrary.h"
+#include "UECS/EcsRenderState.h"
 #include "Components/InstancedStaticMeshComponent.h"
 #include "UECS/Components/BaseComponents.h"
+#include "UECS/Components/RenderTransform.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("StaticMeshDraw skip ratio"), STAT_StaticMeshDrawSkipRatio, STATGROUP_ECS)
 
 SystemStaticMeshDraw::SystemStaticMeshDraw(flecs::world& World)
 {
@@ -36,7 +41,7 @@ SystemStaticMeshDraw::SystemStaticMeshDraw(flecs::world& World)
 
 	World.observer<const FInstancedStaticMeshMember, FTransformComponent, FInstancedStaticMesh>()
 		.term_at(1).in().self()
-		.term_at(2).in().self()
+		.term_at(2).inout().self()
 		.term_at(3).inout().up(flecs::IsA)
 		.event(flecs::OnRemove)
 		.instanced()
@@ -65,6 +70,8 @@ SystemStaticMeshDraw::SystemStaticMeshDraw(flecs::world& World)
 			// Perform a RemoveAtSwap and remove old entity.
 			const FTransform EndTransform = EndEntity.get<FTransformComponent>()->Value;
 			Transform.Value = EndTransform;
+			// Written through the observer's reference, which change detection can't see.
+			CurrentEntity.modified<FTransformComponent>();
 			Ism.ChildEntities.RemoveAtSwap(IdxSwap);
 					
 			RemovedInstanceIds.Add(IdxOldInIsm);
@@ -75,19 +82,26 @@ SystemStaticMeshDraw::SystemStaticMeshDraw(flecs::world& World)
 		Ism.UnrealComponent->RemoveInstances(RemovedInstanceIds);
 	});
 
-	QueryIsmChanged = new flecs::query(World.query_builder<const FInstancedStaticMeshMember, const FTransformComponent, FInstancedStaticMesh>()
+	// The ISM is only read here, so it's an in term: an inout one would mark the prefab's column dirty on every run and
+	// keep ChangeFilter from ever skipping a table.
+	QueryIsmChanged = new flecs::query(World.query_builder<const FInstancedStaticMeshMember, const FTransformComponent, const FInstancedStaticMesh, const FRenderTransform>()
+		.term_at(4).in().self().optional()
 		.term<FFlag_Changed>().in().self()
 		.term<FTransformComponent>().in().self()
 		.term<FInstancedStaticMeshMember>().in().self()
-		.term<FInstancedStaticMesh>().inout().up(flecs::IsA)
+		.term<FInstancedStaticMesh>().in().up(flecs::IsA)
 		.instanced()
 		.build());
 }
 
 void SystemStaticMeshDraw::Iter(const float DeltaTime, flecs::world& FlecsWorld) const
 {
-	QueryIsmChanged->iter(FlecsWorld, [&](const flecs::iter& Iterator, const FInstancedStaticMeshMember* IsmMember, const FTransformComponent* Transform, FInstancedStaticMesh* Ism)
+	ChangeFilter.BeginRun();
+
+	QueryIsmChanged->iter(FlecsWorld, [&](flecs::iter& Iterator, const FInstancedStaticMeshMember* IsmMember, const FTransformComponent* Transform, const FInstancedStaticMesh* Ism, const FRenderTransform* RenderTransform)
 	{
+		if(!ChangeFilter.ShouldProcess(Iterator)) { return; }
+
 		const auto NumEntitiesMatched = Iterator.count();
 
 		if(UNLIKELY(NumEntitiesMatched <= 0) || !Ism->UnrealComponent->IsValidLowLevelFast()) { return; }
@@ -105,9 +119,51 @@ void SystemStaticMeshDraw::Iter(const float DeltaTime, flecs::world& FlecsWorld)
 					
 			const int32 IdxOldInIsm = IsmMember[IdxEntity].IdxInIsm;
 			UpdatedInstanceIds.Emplace(IdxOldInIsm);
-			UpdatedInstanceTransforms.Emplace(Transform[IdxEntity].Value);
+			UpdatedInstanceTransforms.Emplace(nullptr != RenderTransform ? RenderTransform[IdxEntity].Value : Transform[IdxEntity].Value);
 		}
 
 		Ism->UnrealComponent->UpdateInstances(UpdatedInstanceIds, UpdatedInstanceTransforms, UpdatedInstanceTransforms, 0, {});
 	});
+
+	SET_FLOAT_STAT(STAT_StaticMeshDrawSkipRatio, ChangeFilter.GetSkipRatio());
+}
+
+void SystemStaticMeshDraw::Pack(const float DeltaTime, flecs::world& FlecsWorld, FEcsRenderState& RenderState) const
+{
+	ChangeFilter.BeginRun();
+
+	// The flag churn moves entities between tables, which must not happen under the iteration, so it's queued until the
+	// end of it, or of the scheduler segment when packing on a stage.
+	FlecsWorld.defer_begin();
+
+	FEcsRenderBuffer& Buffer = RenderState.GetWriteBuffer();
+	QueryIsmChanged->iter(FlecsWorld, [this, &Buffer](flecs::iter& Iterator, const FInstancedStaticMeshMember* IsmMember, const FTransformComponent* Transform, const FInstancedStaticMesh* Ism, const FRenderTransform* RenderTransform)
+	{
+		if(!ChangeFilter.ShouldProcess(Iterator)) { return; }
+
+		const auto NumEntitiesMatched = Iterator.count();
+		if(UNLIKELY(NumEntitiesMatched <= 0)) { return; }
+
+		// The component itself is only looked at when the batch is applied on the game thread.
+		const flecs::entity IsmSource = Iterator.src(3);
+
+		FEcsRenderBuffer::FIsmBatch& Batch = Buffer.IsmBatches.AddDefaulted_GetRef();
+		Batch.IsmEntity = 0 != IsmSource.id() ? IsmSource.id() : Iterator.entity(0).id();
+		Batch.Entities.Reserve(NumEntitiesMatched);
+		Batch.Transforms.Reserve(NumEntitiesMatched);
+
+		for(const auto IdxEntity : Iterator)
+		{
+			flecs::entity CurrentEntity = Iterator.entity(IdxEntity);
+			CurrentEntity.remove<FFlag_Change>();
+			CurrentEntity.add<FFlag_Changed>();
+
+			Batch.Entities.Emplace(CurrentEntity.id());
+			Batch.Transforms.Emplace(nullptr != RenderTransform ? RenderTransform[IdxEntity].Value : Transform[IdxEntity].Value);
+		}
+	});
+
+	FlecsWorld.defer_end();
+
+	SET_FLOAT_STAT(STAT_StaticMeshDrawSkipRatio, ChangeFilter.GetSkipRatio());
 }
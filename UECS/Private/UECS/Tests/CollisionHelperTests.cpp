@@ -0,0 +1,57 @@
+#include "Misc/AutomationTest.h"
+#include "UECS/CollisionHelper.h"
+#include "UECS/Components/AngularVelocity.h"
+#include "UECS/Components/BaseComponents.h"
+#include "UECS/Components/PhysicsAndCollision/ColliderTable.h"
+#include "UECS/Components/PhysicsAndCollision/NarrowPhaseEntityContacts.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEcsPolylineStopsAtColliderTest, "UECS.Collision.PolylineStopsAtPlainCollider",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEcsPolylineStopsAtColliderTest::RunTest(const FString& Parameters)
+{
+	flecs::world World;
+	const flecs::entity Mover = World.entity();
+	const flecs::entity Wall = World.entity();
+
+	// A resting sphere without FOverlapCollision, in the way of the second step.
+	FColliderTable ColliderTable;
+	const int32 WallId = ColliderTable.Allocate();
+	FColliderProxy& WallProxy = ColliderTable[WallId];
+	WallProxy.Transform = FTransform(FVector(350.0f, 0.0f, 0.0f));
+	WallProxy.Shape = FSupportShape(FCollisionShape::MakeSphere(50.0f));
+	WallProxy.Entity = Wall;
+
+	// A slot left empty, as for a grid member without a transform, is passed over.
+	const TArray<int32> Candidates = { ColliderTable.Allocate(), WallId };
+
+	const FCollisionShape MoverShape = FCollisionShape::MakeSphere(50.0f);
+	const FTransformComponent MoverTransform { .Value = FTransform::Identity };
+	const FAngularVelocity MoverAngularVelocity {};
+	const FVector Steps[] = { FVector(200.0f, 0.0f, 0.0f), FVector(200.0f, 0.0f, 0.0f) };
+
+	FNarrowPhaseEntityContacts Contacts;
+	FPolylineSweepOutput Output;
+	FConservativeAdvancementHistogram Histogram;
+	int32 HullWarmStartVertex = 0;
+	const bool bClear = FCollisionHelper::SweepPolyline(1.0f, Mover, MoverShape, MoverTransform, Steps, MoverAngularVelocity, ColliderTable, Candidates, HullWarmStartVertex, Contacts, Output, Histogram);
+
+	TestFalse(TEXT("Polyline is blocked"), bClear);
+	TestEqual(TEXT("Blocked in the second segment"), Output.IdxSegment, 1);
+
+	// The spheres touch once the mover's centre reaches X = 250.
+	TestTrue(TEXT("Mover stops at the collider"), Output.Displacement.X > 240.0f && Output.Displacement.X <= 251.0f);
+
+	TestEqual(TEXT("One contact"), Contacts.Contacts.Num(), 1);
+	if(Contacts.Contacts.Num() == 1)
+	{
+		TestTrue(TEXT("Contact is with the collider"), Contacts.Contacts[0].EntityHit == Wall);
+		TestTrue(TEXT("Contact is blocking"), Contacts.Contacts[0].bIsBlockingHit);
+	}
+
+	return true;
+}
+
+#endif
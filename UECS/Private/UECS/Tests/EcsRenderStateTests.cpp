@@ -0,0 +1,50 @@
+#include <atomic>
+
+#include "Misc/AutomationTest.h"
+#include "UECS/EcsRenderState.h"
+#include "UECS/UnrealEcsSystemScheduler.h"
+#include "UECS/flecs.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEcsRenderStateApplyTimingTest, "UECS.RenderState.ApplyRunsOutsideSchedulerRun",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEcsRenderStateApplyTimingTest::RunTest(const FString& Parameters)
+{
+	if(!TestTrue(TEXT("Runs on the game thread"), IsInGameThread())) { return false; }
+
+	flecs::world World;
+	FEcsRenderState RenderState(World);
+
+	// An entity that was never created, so Apply has something to look at but nothing to move.
+	RenderState.GetWriteBuffer().ActorEntities.Add(World.entity().id() + 1000);
+	RenderState.GetWriteBuffer().ActorTransforms.Add(FTransform::Identity);
+	RenderState.Submit();
+
+	TestTrue(TEXT("Apply pending after Submit"), RenderState.IsApplyPending());
+
+	// Stages long enough that a queued game thread task would get its turn if the scheduler's waits processed it.
+	UnrealEcsSystemScheduler Scheduler(World, 4);
+	std::atomic<int32> NumPendingInStages { 0 };
+	Scheduler.AddParallelStage(TEXT("RenderStateTiming"), {}, [&RenderState, &NumPendingInStages](const float DeltaTime, flecs::world& StageWorld, const int32 IdxThread)
+	{
+		FPlatformProcess::Sleep(0.005f);
+		if(RenderState.IsApplyPending()) { ++NumPendingInStages; }
+	});
+
+	for(int32 IdxFrame = 0; IdxFrame < 4; ++IdxFrame)
+	{
+		Scheduler.Run(1.0f / 30.0f);
+	}
+
+	TestEqual(TEXT("Stages that saw Apply pending"), NumPendingInStages.load(), 4 * Scheduler.GetNumThreads());
+	TestTrue(TEXT("Apply still pending after Run"), RenderState.IsApplyPending());
+
+	RenderState.Flush();
+	TestFalse(TEXT("Apply done after Flush"), RenderState.IsApplyPending());
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Detour/DetourNavMesh.h"
+#include "Detour/DetourNavMeshBuilder.h"
+#include "UECS/UnrealEcsSystemScheduler.h"
+#include "UECS/Components/BaseComponents.h"
+#include "UECS/Components/NavmeshPathRequest.h"
+#include "UECS/Components/NavmeshPathResponse.h"
+#include "UECS/Systems/SystemFindNavmeshPath.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Single flat quad spanning [-1000, 1000] on both horizontal axes at height 0, so every request inside it has a path.
+	dtNavMesh* CreateFlatNavMesh()
+	{
+		const unsigned short Verts[] = { 0, 1, 0,  0, 1, 200,  200, 1, 200,  200, 1, 0 };
+		const unsigned short Polys[] = { 0, 1, 2, 3,  0xffff, 0xffff, 0xffff, 0xffff };
+		const unsigned short PolyFlags[] = { 1 };
+		const unsigned char PolyAreas[] = { 0 };
+
+		dtNavMeshCreateParams Params;
+		FMemory::Memzero(Params);
+		Params.verts = Verts;
+		Params.vertCount = 4;
+		Params.polys = Polys;
+		Params.polyFlags = PolyFlags;
+		Params.polyAreas = PolyAreas;
+		Params.polyCount = 1;
+		Params.nvp = 4;
+		Params.bmin[0] = -1000.0f; Params.bmin[1] = -10.0f; Params.bmin[2] = -1000.0f;
+		Params.bmax[0] = 1000.0f; Params.bmax[1] = 10.0f; Params.bmax[2] = 1000.0f;
+		Params.walkableHeight = 100.0f;
+		Params.walkableRadius = 30.0f;
+		Params.walkableClimb = 20.0f;
+		Params.cs = 10.0f;
+		Params.ch = 10.0f;
+		Params.buildBvTree = true;
+
+		unsigned char* Data = nullptr;
+		int32 DataSize = 0;
+		if(!dtCreateNavMeshData(&Params, &Data, &DataSize)) { return nullptr; }
+
+		dtNavMesh* NavMesh = dtAllocNavMesh();
+		if(dtStatusFailed(NavMesh->init(Data, DataSize, DT_TILE_FREE_DATA)))
+		{
+			dtFree(Data, DT_ALLOC_PERM_NAVMESH);
+			dtFreeNavMesh(NavMesh);
+			return nullptr;
+		}
+
+		return NavMesh;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEcsFindPathMergeTest, "UECS.Navmesh.FindPathMergesEveryResponse",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEcsFindPathMergeTest::RunTest(const FString& Parameters)
+{
+	dtNavMesh* NavMesh = CreateFlatNavMesh();
+	if(!TestNotNull(TEXT("Navmesh"), NavMesh)) { return false; }
+
+	// Adaptive stages would otherwise run this small scene on a single slice, whatever the thread count.
+	IConsoleVariable* MinSliceCostUs = IConsoleManager::Get().FindConsoleVariable(TEXT("ecs.Scheduler.MinSliceCostUs"));
+	const float PreviousMinSliceCostUs = nullptr != MinSliceCostUs ? MinSliceCostUs->GetFloat() : 0.0f;
+	if(nullptr != MinSliceCostUs) { MinSliceCostUs->Set(0.0f); }
+
+	constexpr int32 NumAgents = 256;
+
+	for(const int32 NumThreads : { 2, 4, 8 })
+	{
+		// The system's queries outlive the world's teardown, so the world goes first.
+		flecs::world* World = new flecs::world();
+		TUniquePtr<SystemFindNavmeshPath> System = MakeUnique<SystemFindNavmeshPath>(*World);
+
+		for(int32 IdxAgent = 0; IdxAgent < NumAgents; ++IdxAgent)
+		{
+			const float Offset = (IdxAgent % 16) * 100.0f - 800.0f;
+			World->entity()
+				.set<FNavmeshAgent>({ .Extents = FVector(100.0f) })
+				.set<FNavmeshPathRequest>({ .Start = FVector(Offset, -800.0f, 0.0f), .End = FVector(-Offset, 800.0f, 0.0f) });
+		}
+
+		UnrealEcsSystemScheduler Scheduler(*World, NumThreads);
+		Scheduler.AddParallelStage(TEXT("NavmeshFindPath"), SystemFindNavmeshPath::GetSystemReadWriteUsage_FindPath(), [&System, NavMesh](const float DeltaTime, flecs::world& StageWorld, const int32 IdxThread)
+		{
+			System->Iter_FindPath(DeltaTime, StageWorld, NavMesh, IdxThread);
+		}, [&System](const float DeltaTime, const int32 InNumThreads)
+		{
+			System->Prep(DeltaTime, InNumThreads);
+		}, [&System]()
+		{
+			return System->GetCount_PathRequests();
+		});
+
+		Scheduler.Run(1.0f / 30.0f);
+
+		int32 NumResponses = 0;
+		World->each([&NumResponses](const FNavmeshPathResponse& Response)
+		{
+			++NumResponses;
+		});
+
+		TestEqual(FString::Printf(TEXT("Responses merged with %d threads"), NumThreads), NumResponses, NumAgents);
+		TestEqual(FString::Printf(TEXT("Requests left with %d threads"), NumThreads), System->GetCount_PathRequests(), 0);
+
+		delete World;
+		System.Reset();
+	}
+
+	if(nullptr != MinSliceCostUs) { MinSliceCostUs->Set(PreviousMinSliceCostUs); }
+
+	dtFreeNavMesh(NavMesh);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "UECS/UnrealEcsSystemScheduler.h"
+#include "UECS/Components/AngularVelocity.h"
+#include "UECS/Components/BaseComponents.h"
+#include "UECS/Components/PhysicsAndCollision/CollisionEnabled.h"
+#include "UECS/Systems/PhysicsAndCollision/SystemGJKCA.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Two rows of spheres closing in on each other, slightly staggered so most of them hit off-centre. Runs NumFrames
+	// frames of the collision system on NumThreads threads and returns the final collision state hash.
+	uint64 SimulateCollisionsAndHash(const int32 NumThreads, const int32 NumFrames)
+	{
+		// The system's observers outlive the world's teardown, so the world goes first.
+		flecs::world* World = new flecs::world();
+		TUniquePtr<FSystemGJKCA> System = MakeUnique<FSystemGJKCA>(*World);
+		System->bDeterministic = true;
+
+		for(int32 IdxRow = 0; IdxRow < 2; ++IdxRow)
+		{
+			for(int32 IdxCollider = 0; IdxCollider < 64; ++IdxCollider)
+			{
+				const FVector Location(IdxCollider * 120.0f, IdxRow * 400.0f + (IdxCollider % 3) * 15.0f, 0.0f);
+				const FVector Velocity(0.0f, IdxRow == 0 ? 300.0f : -300.0f, 0.0f);
+
+				World->entity()
+					.set<FPosition>({ .Value = Location })
+					.set<FTransformComponent>({ .Value = FTransform(Location) })
+					.set<FVelocity>({ .Value = Velocity })
+					.set<FAngularVelocity>({})
+					.set<FCollisionShape>(FCollisionShape::MakeSphere(50.0f))
+					.add<FCollisionEnabled>();
+			}
+		}
+
+		UnrealEcsSystemScheduler Scheduler(*World, NumThreads);
+		System->Schedule(Scheduler, nullptr);
+
+		for(int32 IdxFrame = 0; IdxFrame < NumFrames; ++IdxFrame)
+		{
+			Scheduler.Run(1.0f / 30.0f);
+
+			// Nothing else in the scene moves the transforms the narrowphase sweeps from.
+			World->each([](const FPosition& Position, FTransformComponent& Transform)
+			{
+				Transform.Value.SetLocation(Position.Value);
+			});
+		}
+
+		const uint64 Hash = System->HashCollisionState(*World);
+
+		delete World;
+		System.Reset();
+
+		return Hash;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEcsCollisionDeterminismTest, "UECS.Collision.DeterministicAcrossThreadCounts",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEcsCollisionDeterminismTest::RunTest(const FString& Parameters)
+{
+	// Adaptive stages would otherwise run this small scene on a single slice, whatever the thread count.
+	IConsoleVariable* MinSliceCostUs = IConsoleManager::Get().FindConsoleVariable(TEXT("ecs.Scheduler.MinSliceCostUs"));
+	const float PreviousMinSliceCostUs = nullptr != MinSliceCostUs ? MinSliceCostUs->GetFloat() : 0.0f;
+	if(nullptr != MinSliceCostUs) { MinSliceCostUs->Set(0.0f); }
+
+	constexpr int32 NumFrames = 30;
+	const uint64 SingleThreadHash = SimulateCollisionsAndHash(1, NumFrames);
+
+	for(const int32 NumThreads : { 2, 4, 8 })
+	{
+		TestEqual(FString::Printf(TEXT("Collision state hash with %d threads"), NumThreads), SimulateCollisionsAndHash(NumThreads, NumFrames), SingleThreadHash);
+	}
+
+	if(nullptr != MinSliceCostUs) { MinSliceCostUs->Set(PreviousMinSliceCostUs); }
+
+	return true;
+}
+
+#endif
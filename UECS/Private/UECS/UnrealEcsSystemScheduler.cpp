@@ -0,0 +1,283 @@
+#include "UECS/UnrealEcsSystemScheduler.h"
+
+#include <atomic>
+
+#include "FlecsLibrary.h"
+#include "HAL/IConsoleManager.h"
+#include "UECS/flecs.h"
+
+DECLARE_CYCLE_STAT(TEXT("SystemScheduler"), CS_SYSTEM_SCHEDULER, STATGROUP_ECS)
+DECLARE_CYCLE_STAT(TEXT("SystemSchedulerMerge"), CS_SYSTEM_SCHEDULER_MERGE, STATGROUP_ECS)
+
+static float GMinSliceCostUs = 50.0f;
+static FAutoConsoleVariableRef CVarMinSliceCostUs(
+	TEXT("ecs.Scheduler.MinSliceCostUs"),
+	GMinSliceCostUs,
+	TEXT("Estimated work, in microseconds, an adaptive ECS stage needs per task before it fans out to another one."));
+
+// Weight of the newest frame in the per-item cost of adaptive stages.
+static constexpr double CostSmoothing = 0.2;
+
+UnrealEcsSystemScheduler::UnrealEcsSystemScheduler(flecs::world& InWorld, const int32 InNumThreads)
+	: World(InWorld), NumThreads(FMath::Max(InNumThreads, 1))
+{
+}
+
+void UnrealEcsSystemScheduler::AddStage(const TCHAR* Name, const FSystemReadWriteUsage& Usage, FStageFunction Function)
+{
+	Stages.Add({
+		.Name = Name,
+		.Usage = Usage,
+		.Function = [Function = MoveTemp(Function)](const float DeltaTime, flecs::world& InWorld, int32) { Function(DeltaTime, InWorld); }
+	});
+	bIsBuilt = false;
+}
+
+void UnrealEcsSystemScheduler::AddParallelStage(const TCHAR* Name, const FSystemReadWriteUsage& Usage, FParallelStageFunction Function, FPrepFunction Prep, FWorkCountFunction WorkCount)
+{
+	Stages.Add({
+		.Name = Name,
+		.Usage = Usage,
+		.Function = MoveTemp(Function),
+		.Prep = MoveTemp(Prep),
+		.WorkCount = MoveTemp(WorkCount),
+		.bParallel = true
+	});
+	bIsBuilt = false;
+}
+
+void UnrealEcsSystemScheduler::AddExclusiveStage(const TCHAR* Name, FStageFunction Function)
+{
+	Stages.Add({
+		.Name = Name,
+		.Function = [Function = MoveTemp(Function)](const float DeltaTime, flecs::world& InWorld, int32) { Function(DeltaTime, InWorld); },
+		.bExclusive = true
+	});
+	bIsBuilt = false;
+}
+
+void UnrealEcsSystemScheduler::SetStageFrameInterval(const TCHAR* Name, const int32 FrameInterval)
+{
+	for(FStage& Stage : Stages)
+	{
+		if(FCString::Strcmp(Stage.Name, Name) != 0) { continue; }
+
+		Stage.FrameInterval = FMath::Max(FrameInterval, 1);
+		Stage.FramesSinceRun = 0;
+	}
+}
+
+void UnrealEcsSystemScheduler::SetNumThreads(const int32 InNumThreads)
+{
+	const int32 NewNumThreads = FMath::Max(InNumThreads, 1);
+	if(NewNumThreads == NumThreads) { return; }
+
+	NumThreads = NewNumThreads;
+	bIsBuilt = false;
+}
+
+void UnrealEcsSystemScheduler::Reset()
+{
+	Stages.Reset();
+	StageTasks.Reset();
+	bIsBuilt = false;
+}
+
+void UnrealEcsSystemScheduler::Build()
+{
+	// Exclusive stages split the graph into segments; edges never need to cross one.
+	int32 IdxSegmentStart = 0;
+	NumFlecsStages = 1;
+	for(int32 IdxStage = 0; IdxStage < Stages.Num(); ++IdxStage)
+	{
+		FStage& Stage = Stages[IdxStage];
+		Stage.Dependencies.Reset();
+
+		if(Stage.bExclusive)
+		{
+			IdxSegmentStart = IdxStage + 1;
+			continue;
+		}
+
+		// Every task gets a command queue of its own, so none of them is ever shared between threads.
+		Stage.IdxFirstFlecsStage = NumFlecsStages;
+		NumFlecsStages += Stage.bParallel ? NumThreads : 1;
+
+		for(int32 IdxEarlier = IdxSegmentStart; IdxEarlier < IdxStage; ++IdxEarlier)
+		{
+			if(Stages[IdxEarlier].Usage.Conflicts(Stage.Usage))
+			{
+				Stage.Dependencies.Add(IdxEarlier);
+			}
+		}
+	}
+
+	// Stages can only be changed outside readonly mode, and growing only keeps them from being torn down every time the
+	// graph is rebuilt.
+	if(World.get_stage_count() < NumFlecsStages)
+	{
+		World.set_stage_count(NumFlecsStages);
+	}
+
+	bIsBuilt = true;
+}
+
+void UnrealEcsSystemScheduler::Run(const float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(CS_SYSTEM_SCHEDULER)
+
+	if(!bIsBuilt) { Build(); }
+
+	StageTasks.Reset(Stages.Num());
+	int32 IdxSegmentStart = 0;
+
+	TArray<UE::Tasks::FTask, TInlineAllocator<16>> Prerequisites;
+	TArray<UE::Tasks::FTask, TInlineAllocator<16>> WorkerTasks;
+
+	for(int32 IdxStage = 0; IdxStage < Stages.Num(); ++IdxStage)
+	{
+		FStage& Stage = Stages[IdxStage];
+
+		// Sitting out leaves an empty task behind, which later stages skip over.
+		Stage.ElapsedSinceRun += DeltaTime;
+		if(++Stage.FramesSinceRun < Stage.FrameInterval)
+		{
+			StageTasks.AddDefaulted();
+			continue;
+		}
+
+		const float StageDeltaTime = Stage.ElapsedSinceRun;
+		Stage.FramesSinceRun = 0;
+		Stage.ElapsedSinceRun = 0.0f;
+
+		if(Stage.bExclusive)
+		{
+			WaitForStages(IdxSegmentStart, IdxStage);
+			EndSegment();
+			Stage.Function(StageDeltaTime, World, 0);
+
+			StageTasks.AddDefaulted();
+			IdxSegmentStart = IdxStage + 1;
+			continue;
+		}
+
+		if(!bIsInSegment)
+		{
+			World.readonly_begin();
+			bIsInSegment = true;
+		}
+
+		Prerequisites.Reset();
+		for(const int32 IdxDependency : Stage.Dependencies)
+		{
+			if(StageTasks[IdxDependency].IsValid()) { Prerequisites.Add(StageTasks[IdxDependency]); }
+		}
+
+		if(!Stage.bParallel)
+		{
+			StageTasks.Add(UE::Tasks::Launch(Stage.Name, [&Stage, StageDeltaTime, this]()
+			{
+				flecs::world StageWorld = World.get_stage(Stage.IdxFirstFlecsStage);
+				Stage.Function(StageDeltaTime, StageWorld, 0);
+			}, Prerequisites));
+			continue;
+		}
+
+		// Adaptive stages only know their fan-out once their dependencies are done, so a single task decides it.
+		if(Stage.WorkCount)
+		{
+			StageTasks.Add(UE::Tasks::Launch(Stage.Name, [&Stage, StageDeltaTime, this]() { RunAdaptiveStage(Stage, StageDeltaTime); }, Prerequisites));
+			continue;
+		}
+
+		if(Stage.Prep)
+		{
+			const UE::Tasks::FTask PrepTask = UE::Tasks::Launch(Stage.Name, [&Stage, StageDeltaTime, this]() { Stage.Prep(StageDeltaTime, NumThreads); }, Prerequisites);
+			Prerequisites.Reset();
+			Prerequisites.Add(PrepTask);
+		}
+
+		WorkerTasks.Reset();
+		for(int32 IdxThread = 0; IdxThread < NumThreads; ++IdxThread)
+		{
+			WorkerTasks.Add(UE::Tasks::Launch(Stage.Name, [&Stage, StageDeltaTime, IdxThread, this]()
+			{
+				flecs::world StageWorld = World.get_stage(Stage.IdxFirstFlecsStage + IdxThread);
+				Stage.Function(StageDeltaTime, StageWorld, IdxThread);
+			}, Prerequisites));
+		}
+
+		// Later stages depend on the whole fan-out through this join.
+		StageTasks.Add(UE::Tasks::Launch(Stage.Name, []() {}, WorkerTasks, UE::Tasks::ETaskPriority::Normal, UE::Tasks::EExtendedTaskPriority::Inline));
+	}
+
+	WaitForStages(IdxSegmentStart, Stages.Num());
+	EndSegment();
+}
+
+void UnrealEcsSystemScheduler::RunAdaptiveStage(FStage& Stage, const float DeltaTime)
+{
+	if(Stage.Prep) { Stage.Prep(DeltaTime, NumThreads); }
+
+	const int32 NumItems = Stage.WorkCount();
+	const int32 NumSlices = GetNumSlices(Stage, NumItems);
+
+	std::atomic<uint64> BusyCycles { 0 };
+	auto RunSlice = [&Stage, &BusyCycles, DeltaTime, this](const int32 IdxThread)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		flecs::world StageWorld = World.get_stage(Stage.IdxFirstFlecsStage + IdxThread);
+		Stage.Function(DeltaTime, StageWorld, IdxThread);
+
+		BusyCycles.fetch_add(FPlatformTime::Cycles64() - StartCycles, std::memory_order_relaxed);
+	};
+
+	TArray<UE::Tasks::FTask, TInlineAllocator<16>> SliceTasks;
+	for(int32 IdxThread = 1; IdxThread < NumSlices; ++IdxThread)
+	{
+		SliceTasks.Add(UE::Tasks::Launch(Stage.Name, [&RunSlice, IdxThread]() { RunSlice(IdxThread); }));
+	}
+
+	// This task takes the first slice itself rather than idling until the others are done.
+	RunSlice(0);
+	UE::Tasks::Wait(SliceTasks);
+
+	if(NumItems <= 0) { return; }
+
+	const double CyclesPerItem = static_cast<double>(BusyCycles.load(std::memory_order_relaxed)) / NumItems;
+	Stage.CyclesPerItem = Stage.CyclesPerItem < 0.0 ? CyclesPerItem : FMath::Lerp(Stage.CyclesPerItem, CyclesPerItem, CostSmoothing);
+}
+
+int32 UnrealEcsSystemScheduler::GetNumSlices(const FStage& Stage, const int32 NumItems) const
+{
+	if(NumItems <= 0) { return 1; }
+
+	// Nothing measured yet; fan out fully once to find out what an item costs.
+	if(Stage.CyclesPerItem < 0.0) { return NumThreads; }
+
+	const double MinSliceCycles = FMath::Max(GMinSliceCostUs, 0.0f) * 1e-6 / FPlatformTime::GetSecondsPerCycle64();
+	if(MinSliceCycles <= 0.0) { return NumThreads; }
+
+	const double EstimatedCycles = Stage.CyclesPerItem * NumItems;
+	return FMath::Clamp(static_cast<int32>(EstimatedCycles / MinSliceCycles), 1, FMath::Min(NumThreads, NumItems));
+}
+
+void UnrealEcsSystemScheduler::EndSegment()
+{
+	if(!bIsInSegment) { return; }
+
+	SCOPE_CYCLE_COUNTER(CS_SYSTEM_SCHEDULER_MERGE)
+
+	// Leaving readonly mode merges every stage's queue into the world.
+	World.readonly_end();
+	bIsInSegment = false;
+}
+
+void UnrealEcsSystemScheduler::WaitForStages(const int32 IdxBegin, const int32 IdxEnd) const
+{
+	for(int32 IdxStage = IdxBegin; IdxStage < IdxEnd; ++IdxStage)
+	{
+		if(StageTasks[IdxStage].IsValid()) { StageTasks[IdxStage].Wait(); }
+	}
+}
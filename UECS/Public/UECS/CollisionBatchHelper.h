@@ -0,0 +1,101 @@
+#pragma once
+
+#include "UECS/ConvexHull.h"
+
+// Number of candidates swept per SIMD batch. Matches the lane count of VectorRegister4Float.
+static constexpr int32 CollisionBatchWidth = 4;
+
+// A sphere-swept segment. Spheres have a zero half segment, capsules carry their scaled half axis.
+struct FSweptSegment
+{
+	FVector3f HalfSegment { FVector3f::ZeroVector };
+	FVector3f Displacement { FVector3f::ZeroVector };
+	float Radius { 0.0f };
+};
+
+// Candidate sphere-swept segments transposed into SoA lanes. Centers are stored relative to the mover's origin so the
+// lanes keep their precision in single floats.
+struct alignas(16) FSweptSegmentLanes
+{
+	float CenterX[CollisionBatchWidth];
+	float CenterY[CollisionBatchWidth];
+	float CenterZ[CollisionBatchWidth];
+
+	float HalfSegmentX[CollisionBatchWidth];
+	float HalfSegmentY[CollisionBatchWidth];
+	float HalfSegmentZ[CollisionBatchWidth];
+
+	float DisplacementX[CollisionBatchWidth];
+	float DisplacementY[CollisionBatchWidth];
+	float DisplacementZ[CollisionBatchWidth];
+
+	float Radius[CollisionBatchWidth];
+
+	int32 Count { 0 };
+
+	FORCEINLINE bool IsFull() const { return Count >= CollisionBatchWidth; }
+
+	FORCEINLINE void Reset()
+	{
+		// Unused lanes are zeroed rather than masked so the kernel never reads garbage.
+		FMemory::Memzero(this, sizeof(FSweptSegmentLanes));
+	}
+
+	FORCEINLINE int32 Add(const FVector3f& Center, const FSweptSegment& Segment)
+	{
+		check(!IsFull());
+
+		const int32 IdxLane = Count++;
+		CenterX[IdxLane] = Center.X;
+		CenterY[IdxLane] = Center.Y;
+		CenterZ[IdxLane] = Center.Z;
+		HalfSegmentX[IdxLane] = Segment.HalfSegment.X;
+		HalfSegmentY[IdxLane] = Segment.HalfSegment.Y;
+		HalfSegmentZ[IdxLane] = Segment.HalfSegment.Z;
+		DisplacementX[IdxLane] = Segment.Displacement.X;
+		DisplacementY[IdxLane] = Segment.Displacement.Y;
+		DisplacementZ[IdxLane] = Segment.Displacement.Z;
+		Radius[IdxLane] = Segment.Radius;
+
+		return IdxLane;
+	}
+};
+
+struct alignas(16) FSweptSegmentBatchOutput
+{
+	float Time[CollisionBatchWidth];
+
+	// Contact normal, pointing from the mover towards the candidate.
+	float NormalX[CollisionBatchWidth];
+	float NormalY[CollisionBatchWidth];
+	float NormalZ[CollisionBatchWidth];
+
+	// Contact point on the mover, relative to the mover's origin.
+	float PointX[CollisionBatchWidth];
+	float PointY[CollisionBatchWidth];
+	float PointZ[CollisionBatchWidth];
+
+	// Closest point queries each lane ran before it hit, missed or ran out of iterations.
+	int32 NumIterations[CollisionBatchWidth];
+
+	// Bit per lane. Lanes in UnresolvedMask hit the iteration cap and should be re-swept by the scalar path.
+	int32 HitMask { 0 };
+	int32 UnresolvedMask { 0 };
+
+	FORCEINLINE FVector GetNormal(const int32 IdxLane) const { return FVector(NormalX[IdxLane], NormalY[IdxLane], NormalZ[IdxLane]); }
+	FORCEINLINE FVector GetPoint(const int32 IdxLane) const { return FVector(PointX[IdxLane], PointY[IdxLane], PointZ[IdxLane]); }
+};
+
+struct FCollisionBatchHelper
+{
+	static constexpr int32 MaxIterations { 16 };
+	static constexpr float ContactTolerance { 0.01f };
+
+	// Builds a sphere-swept segment for shapes whose sweep can be batched. Spheres always qualify; capsules only when
+	// they aren't rotating, as the batched kernel only advances along relative linear motion. Hulls never do.
+	static bool MakeSweptSegment(const FSupportShape& SupportShape, const FTransform& Transform, const FVector& Velocity,
+	                             const FVector& AngularVelocity, float DeltaTime, FSweptSegment& OutSegment);
+
+	// Conservative advancement of the mover against up to CollisionBatchWidth candidates at once.
+	static void SweepSegments(const FSweptSegment& Mover, const FSweptSegmentLanes& Lanes, FSweptSegmentBatchOutput& Output);
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+static constexpr int32 MaxCollisionLayers = 32;
+
+// Which layers may collide with which. Symmetric, every pair enabled by default.
+struct FCollisionLayerMatrix
+{
+	uint32 Rows[MaxCollisionLayers];
+
+	FCollisionLayerMatrix()
+	{
+		for(int32 IdxLayer = 0; IdxLayer < MaxCollisionLayers; ++IdxLayer)
+		{
+			Rows[IdxLayer] = MAX_uint32;
+		}
+	}
+
+	FORCEINLINE void SetLayersCollide(const int32 LayerA, const int32 LayerB, const bool bCollide)
+	{
+		check(LayerA >= 0 && LayerA < MaxCollisionLayers && LayerB >= 0 && LayerB < MaxCollisionLayers);
+
+		if(bCollide)
+		{
+			Rows[LayerA] |= 1u << LayerB;
+			Rows[LayerB] |= 1u << LayerA;
+		}
+		else
+		{
+			Rows[LayerA] &= ~(1u << LayerB);
+			Rows[LayerB] &= ~(1u << LayerA);
+		}
+	}
+
+	FORCEINLINE bool CanLayersCollide(const int32 LayerA, const int32 LayerB) const
+	{
+		return (Rows[LayerA] & (1u << LayerB)) != 0;
+	}
+};
+
+// Per-entity collision layer and the set of layers it accepts contacts from. Kept small so it can live in grid entries.
+struct FCollisionFilter
+{
+	uint32 Mask { MAX_uint32 };
+	uint8 Layer { 0 };
+
+	FORCEINLINE bool CanCollide(const FCollisionFilter& Other, const FCollisionLayerMatrix& LayerMatrix) const
+	{
+		return (Mask & (1u << Other.Layer)) != 0
+			&& (Other.Mask & (1u << Layer)) != 0
+			&& LayerMatrix.CanLayersCollide(Layer, Other.Layer);
+	}
+};
@@ -1,6 +1,11 @@
 #pragma once
 
-struct FNarrowPhaseEntityContact;
+#include "UECS/ConvexHull.h"
+
+struct FNarrowPhaseEntityContacts;
+struct FColliderProxy;
+struct FColliderTable;
+struct FCollisionFilter;
 struct FAngularVelocity;
 struct FTransformComponent;
 struct FEntityPositionCache;
@@ -13,56 +18,115 @@ namespace flecs
 	struct entity;
 }
 
-struct FConservativeAdvancementOutput
+// Precision the GJK and conservative advancement kernels run in. Single runs on transforms rebased onto an origin next
+// to the pair being tested, so it keeps its precision far from the world origin.
+enum class ECollisionKernelPrecision : uint8
+{
+	Double,
+	Single
+};
+
+template<typename T>
+struct TConservativeAdvancementOutput
 {
 	float Time { 0.0f };
 	bool bInitialOverlap { false };
 	bool bCollided { false };
-	FVector ContactPoint {};
-	FVector ContactNormal {};
+
+	// Set when the sweep ran out of iterations before reaching a contact. Time is then the last safe time, and there is
+	// no contact to report; callers only clamp the move to it.
+	bool bStoppedShort { false };
+	int32 NumIterations { 0 };
+	UE::Math::TVector<T> ContactPoint {};
+	UE::Math::TVector<T> ContactNormal {};
 };
 
-struct FCollisionOutput
+using FConservativeAdvancementOutput = TConservativeAdvancementOutput<double>;
+
+struct FPolylineSweepOutput
+{
+	// Segment holding the earliest hit, or INDEX_NONE when the whole polyline is clear.
+	int32 IdxSegment { INDEX_NONE };
+
+	// Time of the hit within IdxSegment.
+	float Time { 1.0f };
+
+	// Distance travelled along the polyline up to the hit, or to its end.
+	FVector Displacement { FVector::ZeroVector };
+};
+
+// Distribution of conservative advancement iteration counts, in power-of-two buckets: 0, 1, 2-3, 4-7, ... The last
+// bucket also collects sweeps that hit the iteration cap.
+struct FConservativeAdvancementHistogram
+{
+	static constexpr int32 NumBuckets { 7 };
+
+	uint32 Buckets[NumBuckets] {};
+
+	FORCEINLINE void Add(const int32 NumIterations)
+	{
+		const int32 IdxBucket = NumIterations <= 0 ? 0 : 1 + static_cast<int32>(FMath::FloorLog2(static_cast<uint32>(NumIterations)));
+		++Buckets[FMath::Min(IdxBucket, NumBuckets - 1)];
+	}
+
+	FORCEINLINE void Append(const FConservativeAdvancementHistogram& Other)
+	{
+		for(int32 IdxBucket = 0; IdxBucket < NumBuckets; ++IdxBucket)
+		{
+			Buckets[IdxBucket] += Other.Buckets[IdxBucket];
+		}
+	}
+
+	FORCEINLINE void Reset() { FMemory::Memzero(Buckets); }
+};
+
+template<typename T>
+struct TCollisionOutput
 {
 	bool bDidOverlap { false };
 	float Distance { 0.0f };
-	FVector ClosestA {};
-	FVector ClosestB {};
-	FVector Normal {};
+	UE::Math::TVector<T> ClosestA {};
+	UE::Math::TVector<T> ClosestB {};
+	UE::Math::TVector<T> Normal {};
 };
 
-struct FSimplex
+using FCollisionOutput = TCollisionOutput<double>;
+
+template<typename T>
+struct TSimplex
 {
+	using FVec = UE::Math::TVector<T>;
+
 	union
 	{
 		struct
 		{
-			FVector A;
-			FVector A1;
-			FVector A2;
+			FVec A;
+			FVec A1;
+			FVec A2;
 
-			FVector B;
-			FVector B1;
-			FVector B2;
+			FVec B;
+			FVec B1;
+			FVec B2;
 
-			FVector C;
-			FVector C1;
-			FVector C2;
+			FVec C;
+			FVec C1;
+			FVec C2;
 
-			FVector D;
-			FVector D1;
-			FVector D2;
+			FVec D;
+			FVec D1;
+			FVec D2;
 		};
-		FVector Points[12];
+		FVec Points[12];
 	};
 
 	int32 Count { 0 };
 
-	FSimplex(): A(), A1(), A2(), B(), B1(), B2(), C(), C1(), C2(), D(), D1(), D2()
+	TSimplex(): A(), A1(), A2(), B(), B1(), B2(), C(), C1(), C2(), D(), D1(), D2()
 	{
 	}
 
-	FORCEINLINE void ShufflePoints(const FVector& SupportA, const FVector& SupportB, const FVector& Support)
+	FORCEINLINE void ShufflePoints(const FVec& SupportA, const FVec& SupportB, const FVec& Support)
 	{
 		for (int i = 8; i >= 0; --i)
 		{
@@ -75,29 +139,41 @@ struct FSimplex
 	}
 };
 
+using FSimplex = TSimplex<double>;
+
 struct FCollisionHelper
 {
+	// Sweeps still advancing after this many GJK queries stop short at the last safe time instead of looping on.
+	static constexpr int32 MaxConservativeAdvancementIterations { 32 };
+
 	static FTransform LerpTransform(const FTransform& Start, const FTransform& End, float Alpha);
 
 	static float ApproximateDistanceFromOrigin(const TArray<FVector>& Simplex);
 
-	static FVector Support(const FCollisionShape& Shape, const FTransform& Transform, const FVector& Direction);
+	static FVector Support(const FSupportShape& SupportShape, const FTransform& Transform, const FVector& Direction);
 
-	FORCEINLINE static FVector Support(const FCollisionShape& ShapeA, const FTransform& TransformA, const FCollisionShape& ShapeB,
+	FORCEINLINE static FVector Support(const FSupportShape& ShapeA, const FTransform& TransformA, const FSupportShape& ShapeB,
 	                                   const FTransform& TransformB, const FVector& Direction)
 	{
 		const FVector NormalizedDirection = Direction.GetSafeNormal();
 		return Support(ShapeA, TransformA, NormalizedDirection) - Support(ShapeB, TransformB, -NormalizedDirection);
 	}
 
-	static float GetBoundingRadius(const FCollisionShape& Shape, const FTransform& Transform)
+	template<typename T>
+	static float GetBoundingRadius(const FSupportShape& SupportShape, const UE::Math::TTransform<T>& Transform)
 	{
+		if(SupportShape.Hull.IsValid())
+		{
+			return SupportShape.Hull->BoundingRadius * Transform.GetMaximumAxisScale();
+		}
+
+		const FCollisionShape& Shape = SupportShape.Shape;
 		switch(Shape.ShapeType)
 		{
 		case ECollisionShape::Box:
 			{
-				const FVector Extents = Shape.GetExtent();
-				const FVector ScaledExtents = Extents * Transform.GetScale3D();
+				const UE::Math::TVector<T> Extents(Shape.GetExtent());
+				const UE::Math::TVector<T> ScaledExtents = Extents * Transform.GetScale3D();
 				return ScaledExtents.Size();
 			}
 		case ECollisionShape::Sphere:
@@ -148,19 +224,60 @@ struct FCollisionHelper
 
 	static TTuple<FVector, FVector> GetLocalPoints(FSimplex Simplex, const FVector& Point);
 
-	static FCollisionOutput GJK_Complex(const FCollisionShape& ShapeA, const FTransform& TransformA, const FCollisionShape& ShapeB, const FTransform& TransformB);
+	static FCollisionOutput GJK_Complex(const FSupportShape& ShapeA, const FTransform& TransformA, const FSupportShape& ShapeB, const FTransform& TransformB);
+	static FCollisionOutput GJK_Complex(ECollisionKernelPrecision Precision, const FSupportShape& ShapeA, const FTransform& TransformA, const FSupportShape& ShapeB, const FTransform& TransformB);
+
+	static ECollisionKernelPrecision GetKernelPrecision();
+
+	static FCollisionOutput GJK_Simple(const FSupportShape& ShapeA, const FTransform& TransformA, const FSupportShape& ShapeB, const FTransform& TransformB);
 
-	static FCollisionOutput GJK_Simple(const FCollisionShape& ShapeA, const FTransform& TransformA, const FCollisionShape& ShapeB, const FTransform& TransformB);
+	// Runs in the precision selected by ecs.Collision.KernelPrecision.
+	static FConservativeAdvancementOutput ConservativeAdvancement(const FSupportShape& ShapeA,
+	                                                              const FTransform& TransformFromA,
+	                                                              const FTransform& TransformToA,
+	                                                              const FSupportShape& ShapeB,
+	                                                              const FTransform& TransformFromB,
+	                                                              const FTransform& TransformToB);
 
-	static FConservativeAdvancementOutput ConservativeAdvancement(const FCollisionShape& ShapeA,
+	static FConservativeAdvancementOutput ConservativeAdvancement(ECollisionKernelPrecision Precision,
+	                                                              const FSupportShape& ShapeA,
 	                                                              const FTransform& TransformFromA,
 	                                                              const FTransform& TransformToA,
-	                                                              const FCollisionShape& ShapeB,
+	                                                              const FSupportShape& ShapeB,
 	                                                              const FTransform& TransformFromB,
 	                                                              const FTransform& TransformToB);
 
-	static void BoxBroadphase(float DeltaTime, const flecs::entity& Entity, const FCollisionShape& CollisionShape, const FPosition& Position, const FVelocity& Velocity, FCollisionSpatialGrid& CollisionSpatialGrid, TArray<FEntityPositionCache>& CollisionCandidates);
+	// Single closest-point query at the start of the step. Reports a contact when the approach speed along the separating
+	// normal could close the current gap within the step, with the time at which it would do so.
+	static FConservativeAdvancementOutput SpeculativeContact(const FSupportShape& ShapeA,
+	                                                         const FTransform& TransformFromA,
+	                                                         const FTransform& TransformToA,
+	                                                         const FSupportShape& ShapeB,
+	                                                         const FTransform& TransformFromB,
+	                                                         const FTransform& TransformToB);
+
+	static void BoxBroadphase(float DeltaTime, const flecs::entity& Entity, const FCollisionShape& CollisionShape, const FPosition& Position, const FVelocity& Velocity, const FCollisionFilter& Filter, FCollisionSpatialGrid& CollisionSpatialGrid, TArray<FEntityPositionCache>& CollisionCandidates);
+	// Like BoxBroadphase, but the box bounds a whole movement polyline. Each step is a velocity held for DeltaTime.
+	static void PolylineBroadphase(float DeltaTime, const flecs::entity& Entity, const FPosition& Position, TConstArrayView<FVector> Steps, const FCollisionFilter& Filter, FCollisionSpatialGrid& CollisionSpatialGrid, TArray<FEntityPositionCache>& CollisionCandidates);
+	// Looks up the collider table ids of the candidates, one per candidate and in the same order. Candidates without a
+	// live proxy get INDEX_NONE, which the narrowphase skips.
+	static void GatherCandidates(const FColliderTable& ColliderTable, const TArray<FEntityPositionCache>& CollisionCandidates, TArray<int32>& OutColliderIds);
+	// Sweeps the candidates, given as collider table ids, nearest-first, stopping at the first blocking hit. The ids are
+	// reordered in place.
+	// InOutHullWarmStartVertex warm starts the mover's hull, if it has one, and receives the vertex its last query ended on.
 	static bool NarrowPhase(const float DeltaTime, const flecs::entity& Entity, const FCollisionShape& CollisionShape,
 	                        const FTransformComponent& Transform, const FVector& Velocity, const FAngularVelocity& AngularVelocity,
-	                        const TArray<FEntityPositionCache>& CollisionCandidates, FPosition& Position, TSet<FNarrowPhaseEntityContact>& NarrowPhaseEntityContacts, float& OutTime);
+	                        const FColliderTable& ColliderTable, TArray<int32>& CollisionCandidates, int32& InOutHullWarmStartVertex, FPosition& Position,
+	                        FNarrowPhaseEntityContacts& NarrowPhaseEntityContacts, float& OutTime, FConservativeAdvancementHistogram& Histogram,
+	                        bool bAllowBatching = true);
+
+	// Sweeps the mover along a polyline of steps as one query against the same gathered candidates. Each segment moves by
+	// its step times DeltaTime and spans an equal share of the frame, over which the candidates advance along their own
+	// velocities. Stops at the first segment with a hit, clamping the move like NarrowPhase does. Hits only count as
+	// blocking when neither the mover nor the candidate is an FOverlapCollision. Returns true if the polyline is clear.
+	static bool SweepPolyline(const float DeltaTime, const flecs::entity& Entity, const FCollisionShape& CollisionShape,
+	                          const FTransformComponent& Transform, TConstArrayView<FVector> Steps, const FAngularVelocity& AngularVelocity,
+	                          const FColliderTable& ColliderTable, const TArray<int32>& CollisionCandidates, int32& InOutHullWarmStartVertex,
+	                          FNarrowPhaseEntityContacts& NarrowPhaseEntityContacts, FPolylineSweepOutput& Output,
+	                          FConservativeAdvancementHistogram& Histogram);
 };
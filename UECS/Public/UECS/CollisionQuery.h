@@ -0,0 +1,51 @@
+#pragma once
+
+#include "UECS/ConvexHull.h"
+#include "UECS/flecs.h"
+
+// Inputs of the gameplay-facing collision queries on FSystemGJKCA. Queries only see entities in the collision grid, as of
+// the last Iter_Hashing.
+
+struct FCollisionOverlapQuery
+{
+	FSupportShape Shape {};
+	FTransform Transform { FTransform::Identity };
+
+	// Layers the query accepts hits from.
+	uint32 LayerMask { MAX_uint32 };
+
+	// Usually the querying entity itself.
+	flecs::entity IgnoreEntity;
+};
+
+struct FCollisionSweepQuery
+{
+	FSupportShape Shape {};
+	FTransform Start { FTransform::Identity };
+	FTransform End { FTransform::Identity };
+	uint32 LayerMask { MAX_uint32 };
+	flecs::entity IgnoreEntity;
+};
+
+struct FCollisionRaycastQuery
+{
+	FVector Start { FVector::ZeroVector };
+	FVector End { FVector::ZeroVector };
+	uint32 LayerMask { MAX_uint32 };
+	flecs::entity IgnoreEntity;
+};
+
+struct FCollisionQueryHit
+{
+	// Id of the entity hit, zero for a miss. Kept as a bare id so batches of hits stay small; resolve it through the
+	// world when more than the hit data is needed.
+	flecs::entity_t Entity { 0 };
+
+	// Fraction of the way from start to end. Always zero for overlaps.
+	float Time { 0.0f };
+
+	FVector Point { FVector::ZeroVector };
+	FVector Normal { FVector::ZeroVector };
+
+	FORCEINLINE bool IsHit() const { return 0 != Entity; }
+};
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "UECS/EcsComponentType.h"
+
 struct FAngularVelocity
 {
 	FVector Value { FVector::ZeroVector };
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::AngularVelocity; }
 };
@@ -18,7 +18,11 @@ struct FFlag_CollisionEnabled {};
 
 struct FCollisionMask
 {
-	int32 Mask { 0 };
+	// Layer this entity lives on, in [0, MaxCollisionLayers). Larger values are clamped to the last layer.
+	uint8 Layer { 0 };
+
+	// Layers this entity accepts contacts from.
+	uint32 Mask { MAX_uint32 };
 };
 
 struct FActorComponent
@@ -30,7 +34,7 @@ struct FPosition
 {
 	FVector Value;
 	
-	FORCEINLINE static int32 GetTypeId()
+	FORCEINLINE static constexpr int32 GetTypeId()
 	{
 		return EEcsComponentType::Position;
 	}
@@ -52,7 +56,7 @@ struct FVelocity
 
 	void Add(const FVector& OtherVelocity) { Value += OtherVelocity; }
 
-	FORCEINLINE static int32 GetTypeId() { return EEcsComponentType::Velocity; }
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::Velocity; }
 };
 
 struct FSpeed
@@ -60,14 +64,14 @@ struct FSpeed
 	float max;
 	float linearAcceleration;
 	
-	FORCEINLINE static int32 GetTypeId() { return EEcsComponentType::Speed; }
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::Speed; }
 };
 
 struct FOneFrameMovementSequence
 {
 	TArray<FVector, TInlineAllocator<8>> steps;
 
-	FORCEINLINE static int32 GetTypeId()
+	FORCEINLINE static constexpr int32 GetTypeId()
 	{
 		return EEcsComponentType::OneFrameMovementSequence;
 	}
@@ -76,6 +80,8 @@ struct FOneFrameMovementSequence
 struct FRadius
 {
 	float Value;
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::Radius; }
 };
 
 struct FHunger
@@ -110,13 +116,15 @@ struct FInstancedStaticMeshMember
 struct FTransformComponent
 {
 	FTransform Value; 
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::TransformComponent; }
 };
 
 struct FNavmeshAgent
 {
 	FVector Extents;
 	
-	FORCEINLINE static int32 GetTypeId() { return EEcsComponentType::NavmeshAgent; }
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::NavmeshAgent; }
 };
 
 struct FOverlapComponent
@@ -21,4 +21,24 @@ struct FEcsSystemTickDebt
 
 		return (NumTicks / TargetNumTicks) > 0;
 	}
+
+	// Drops owed ticks beyond MaxTicks and returns how many were dropped. Catching up on all of them after a slow frame
+	// would only make the next frame slower still.
+	FORCEINLINE int32 ClampTicks(const int32 MaxTicks)
+	{
+		const int32 NumDropped = FMath::Max(NumTicks - MaxTicks, 0);
+		NumTicks -= NumDropped;
+		return NumDropped;
+	}
+
+	FORCEINLINE bool ConsumeTick()
+	{
+		if(NumTicks <= 0) { return false; }
+
+		--NumTicks;
+		return true;
+	}
+
+	// How far into the next tick the leftover debt is, in [0, 1).
+	FORCEINLINE float GetAlpha() const { return FMath::Clamp(Debt / TickInterval, 0.0f, 1.0f); }
 };
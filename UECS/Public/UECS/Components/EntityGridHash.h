@@ -18,7 +18,7 @@ struct FOctreeNode
 
     FOctreeNode(const FBox& InBounds, const int32 InDepth, const int64 InHash) : Bounds(InBounds), Depth(InDepth), Hash(InHash) {}
 	template<typename TSpatialHashMember>
-	FOctreeNode* Add(const FVector& Position, flecs::entity& Entity)
+	FOctreeNode* Add(const FVector& Position, flecs::entity& Entity, const int32 ColliderId = INDEX_NONE, const FCollisionFilter& Filter = {})
     {
     	if(IsLeaf)
     	{
@@ -26,21 +26,23 @@ struct FOctreeNode
     		{
     			Subdivide();
     			FOctreeNode* ChildNode = GetChild(Position);
-    			return ChildNode->Add<TSpatialHashMember>(Position, Entity);
+    			return ChildNode->Add<TSpatialHashMember>(Position, Entity, ColliderId, Filter);
     		}
 
     		TSpatialHashMember SpatialHashMember;
     		SpatialHashMember.Hash = Hash;
     		SpatialHashMember.IndexInArray = Entities.Num();
     		SpatialHashMember.OctreeNode = this;
+    		SpatialHashMember.ColliderId = ColliderId;
+    		SpatialHashMember.Filter = Filter;
     		Entity.set<TSpatialHashMember>(SpatialHashMember);
     		
-    		Entities.Add(FEntityPositionCache { .Entity = Entity, .Position = Position });
+    		Entities.Add(FEntityPositionCache { .Entity = Entity, .Position = Position, .ColliderId = ColliderId, .Filter = Filter });
 
     		return this;
     	}
     	
-    	return GetChild(Position)->Add<TSpatialHashMember>(Position, Entity);
+    	return GetChild(Position)->Add<TSpatialHashMember>(Position, Entity, ColliderId, Filter);
     }
 
 	template<typename TSpatialHashMember>
@@ -58,7 +60,7 @@ struct FOctreeNode
     	OldNode->Remove<TSpatialHashMember>(SpatialHashMember.IndexInArray);
 
     	FOctreeNode* NewNode = GetChild(Position);
-    	NewNode->Add<TSpatialHashMember>(Position, Entity);
+    	NewNode->Add<TSpatialHashMember>(Position, Entity, SpatialHashMember.ColliderId, SpatialHashMember.Filter);
     }
 
 	template<typename TSpatialHashMember>
@@ -137,6 +139,30 @@ struct FOctreeNode
     	}
     }
 
+	template<typename PredicateType>
+	void GetEntitiesInBox(const FBox& Box, TArray<FEntityPositionCache>& OutEntities, const PredicateType& Predicate)
+    {
+	    if(IsLeaf)
+	    {
+		    for(const auto& Entity : Entities)
+		    {
+			    if(Box.IsInside(Entity.Position) && Predicate(Entity))
+			    {
+				    OutEntities.Add(Entity);
+			    }
+		    }
+	    	return;
+	    }
+
+    	for(int32 IdxChild = 0; IdxChild < 8; ++IdxChild)
+    	{
+    		if(Children[IdxChild]->Bounds.Intersect(Box))
+    		{
+    			Children[IdxChild]->GetEntitiesInBox(Box, OutEntities, Predicate);
+    		}
+    	}
+    }
+
 	void GetEntities(const FVector& Position, TArray<FEntityPositionCache>& OutEntities)
     {
     	if(IsLeaf)
@@ -417,7 +443,7 @@ struct FEntityGridHash
 	}
 
 	template<typename TSpatialHashMember>
-	FORCEINLINE void Add(flecs::entity& Entity, const FPosition& Position)
+	FORCEINLINE void Add(flecs::entity& Entity, const FPosition& Position, const int32 ColliderId = INDEX_NONE, const FCollisionFilter& Filter = {})
 	{
 		const FVector EntityPosition = Position.Value;
 		const int64 Key = GetGridKey(EntityPosition);
@@ -434,7 +460,7 @@ struct FEntityGridHash
 			OctreeNode = Grid.Find(Key);
 		}
 
-		(*OctreeNode)->Add<TSpatialHashMember>(EntityPosition, Entity);
+		(*OctreeNode)->Add<TSpatialHashMember>(EntityPosition, Entity, ColliderId, Filter);
 	}
 
 	template<typename TSpatialHashMember>
@@ -486,7 +512,7 @@ struct FEntityGridHash
 		// }
 
 		FOctreeNode* NewOctreeNode = (*NewOctreeRootNode)->GetChild(EntityPosition);
-		NewOctreeNode->Add<TSpatialHashMember>(EntityPosition, Entity);
+		NewOctreeNode->Add<TSpatialHashMember>(EntityPosition, Entity, SpatialHashMember.ColliderId, SpatialHashMember.Filter);
 	}
 
 	template<typename TSpatialHashMember>
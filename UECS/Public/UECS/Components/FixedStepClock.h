@@ -0,0 +1,12 @@
+#pragma once
+
+// World singleton kept up to date by FEcsFixedStepDriver.
+struct FFixedStepClock
+{
+	float FixedDeltaTime { 1.0f / 60.0f };
+
+	// How far the frame is between the last two fixed steps, for blending FPreviousPosition into FPosition.
+	float Alpha { 1.0f };
+
+	uint64 NumSteps { 0 };
+};
@@ -1,3 +1,8 @@
 #pragma once
 
-struct FAtTarget {};
+#include "UECS/EcsComponentType.h"
+
+struct FAtTarget
+{
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::AtTarget; }
+};
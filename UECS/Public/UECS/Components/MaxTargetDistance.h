@@ -1,6 +1,10 @@
 #pragma once
 
+#include "UECS/EcsComponentType.h"
+
 struct FMaxTargetDistance
 {
 	float Value { 100.0f };
-};
\ No newline at end of file
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::MaxTargetDistance; }
+};
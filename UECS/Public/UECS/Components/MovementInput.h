@@ -4,7 +4,7 @@ struct FMovementInput
 {
 	FVector Input;
 	
-	FORCEINLINE static int32 GetTypeId()
+	FORCEINLINE static constexpr int32 GetTypeId()
 	{
 		return EEcsComponentType::MovementInput;
 	}
@@ -4,7 +4,7 @@ struct FNavmeshPathRequest
 {
 	FVector Start;
 	FVector End;
-	FORCEINLINE static int32 GetTypeId()
+	FORCEINLINE static constexpr int32 GetTypeId()
 	{
 		return EEcsComponentType::NavmeshPathRequest;
 	}
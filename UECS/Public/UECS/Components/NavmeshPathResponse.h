@@ -5,5 +5,5 @@ struct FNavmeshPathResponse
 	TArray<FVector> Points;
 	dtStatus Status;
 	
-	FORCEINLINE static int32 GetTypeId() { return EEcsComponentType::NavmeshPathResponse; }
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::NavmeshPathResponse; }
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "UECS/EcsComponentType.h"
+
+enum class ECcdMode : uint8
+{
+	// Iterated GJK until time of impact. Exact enough for fast movers, but costs several GJK queries per pair.
+	Conservative,
+
+	// A single closest-point query per pair, reporting a contact whose allowed approach is the current gap. Cheap, but
+	// only suitable for bodies that move a fraction of their size per frame.
+	Speculative
+};
+
+// Selects the continuous collision mode of an entity. Entities without it use conservative advancement.
+struct FCcdMode
+{
+	ECcdMode Mode { ECcdMode::Conservative };
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::CcdMode; }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "UECS/flecs.h"
+#include "UECS/ConvexHull.h"
+
+// Everything the narrowphase needs to know about a candidate, gathered so it can be read without touching flecs.
+struct FColliderProxy
+{
+	FTransform Transform { FTransform::Identity };
+	FVector Velocity { FVector::ZeroVector };
+	FVector AngularVelocity { FVector::ZeroVector };
+	FSupportShape Shape {};
+	flecs::entity Entity;
+
+	// Set for FOverlapCollision colliders, whose hits are reported but never block.
+	bool bOverlapOnly { false };
+};
+
+// Dense, frame-wide table of collider proxies. Ids are handed out when an entity joins the collision grid and stored in
+// its grid entries, so the broadphase can gather candidate data with a single indexed read.
+struct FColliderTable
+{
+	TArray<FColliderProxy> Proxies;
+	TArray<int32> FreeIds;
+
+	FORCEINLINE int32 Allocate()
+	{
+		if(FreeIds.Num() > 0)
+		{
+			return FreeIds.Pop(EAllowShrinking::No);
+		}
+
+		return Proxies.AddDefaulted();
+	}
+
+	FORCEINLINE void Free(const int32 ColliderId)
+	{
+		if(!Proxies.IsValidIndex(ColliderId)) { return; }
+
+		Invalidate(ColliderId);
+		FreeIds.Add(ColliderId);
+	}
+
+	// Clears the slot while keeping the id allocated, for colliders the per-frame refresh no longer reaches.
+	FORCEINLINE void Invalidate(const int32 ColliderId)
+	{
+		if(!Proxies.IsValidIndex(ColliderId)) { return; }
+
+		Proxies[ColliderId] = FColliderProxy {};
+	}
+
+	FORCEINLINE bool IsValidId(const int32 ColliderId) const { return Proxies.IsValidIndex(ColliderId); }
+
+	// Whether the slot holds a proxy refreshed for a live collider, rather than an empty or invalidated one.
+	FORCEINLINE bool IsLiveId(const int32 ColliderId) const { return Proxies.IsValidIndex(ColliderId) && 0 != Proxies[ColliderId].Entity.id(); }
+
+	FORCEINLINE FColliderProxy& operator[](const int32 ColliderId) { return Proxies[ColliderId]; }
+	FORCEINLINE const FColliderProxy& operator[](const int32 ColliderId) const { return Proxies[ColliderId]; }
+};
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "UECS/EcsComponentType.h"
+
 struct FCollisionEnabled
 {
-	
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::CollisionEnabled; }
 };
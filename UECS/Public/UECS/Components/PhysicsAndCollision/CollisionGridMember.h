@@ -1,5 +1,9 @@
 #pragma once
 
+#include "UECS/EcsComponentType.h"
 #include "UECS/Components/SpatialHashMember.h"
 
-struct FCollisionGridMember : FGridMember {};
\ No newline at end of file
+struct FCollisionGridMember : FGridMember
+{
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::CollisionGridMember; }
+};
\ No newline at end of file
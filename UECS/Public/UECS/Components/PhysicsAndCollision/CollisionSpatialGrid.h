@@ -1,5 +1,99 @@
 #pragma once
 
+#include "UECS/CollisionFilter.h"
 #include "UECS/Components/EntityGridHash.h"
 
-struct FCollisionSpatialGrid : FEntityGridHash {};
+struct FCollisionSpatialGrid : FEntityGridHash
+{
+	FCollisionLayerMatrix LayerMatrix;
+
+	// Same as GetEntitiesInBox, but entries that can't collide with Filter are rejected before they're emitted.
+	FORCEINLINE void GetCollidableEntitiesInBox(const flecs::entity& MyEntity, const FCollisionFilter& Filter, const FBox& Box, TArray<FEntityPositionCache>& OutEntities)
+	{
+		const FIntVector2 TopLeft = GetGridCoords(Box.Min);
+		const FIntVector2 BottomRight = GetGridCoords(Box.Max);
+
+		auto Predicate = [this, &MyEntity, &Filter](const FEntityPositionCache& Cache)
+		{
+			return Cache.Entity != MyEntity && Filter.CanCollide(Cache.Filter, LayerMatrix);
+		};
+		
+		for(int32 Y = TopLeft.Y; Y <= BottomRight.Y; ++Y)
+		{
+			for(int32 X = TopLeft.X; X <= BottomRight.X; ++X)
+			{
+				const int64 Key = GetGridKey(X, Y);
+				
+				FOctreeNode** OctreeNode = Grid.Find(Key);
+				if(nullptr == OctreeNode) { continue; }
+				
+				(*OctreeNode)->GetEntitiesInBox(Box, OutEntities, Predicate);
+			}
+		}
+	}
+
+	// Entries in Box on a layer in LayerMask. Used by gameplay queries, which have no filter of their own to be accepted by.
+	FORCEINLINE void GetQueryableEntitiesInBox(const flecs::entity& IgnoreEntity, const uint32 LayerMask, const FBox& Box, TArray<FEntityPositionCache>& OutEntities)
+	{
+		const FIntVector2 TopLeft = GetGridCoords(Box.Min);
+		const FIntVector2 BottomRight = GetGridCoords(Box.Max);
+
+		auto Predicate = [&IgnoreEntity, LayerMask](const FEntityPositionCache& Cache)
+		{
+			return Cache.Entity != IgnoreEntity && (LayerMask & (1u << Cache.Filter.Layer)) != 0;
+		};
+
+		for(int32 Y = TopLeft.Y; Y <= BottomRight.Y; ++Y)
+		{
+			for(int32 X = TopLeft.X; X <= BottomRight.X; ++X)
+			{
+				FOctreeNode** OctreeNode = Grid.Find(GetGridKey(X, Y));
+				if(nullptr == OctreeNode) { continue; }
+
+				(*OctreeNode)->GetEntitiesInBox(Box, OutEntities, Predicate);
+			}
+		}
+	}
+
+	// Same as GetEntitiesInHemisphere, but entries that can't collide with Filter are rejected before they're emitted.
+	FORCEINLINE void GetCollidableEntitiesInHemisphere(const flecs::entity& InEntity, const FCollisionFilter& Filter, const FVector& Position, const float Radius, const FVector& Normal, TArray<FEntityPositionCache>& OutEntities)
+	{
+		const float RadiusSquared = Radius * Radius;
+		const FVector RadiusVec(Radius, Radius, Radius);
+		const FBox SphereBox(Position - RadiusVec, Position + RadiusVec);
+    
+		const FIntVector2 TopLeft = GetGridCoords(SphereBox.Min);
+		const FIntVector2 BottomRight = GetGridCoords(SphereBox.Max);
+
+		auto Predicate = [this, &InEntity, &Filter, &Position, &Normal, RadiusSquared](const FEntityPositionCache& Cache)
+		{
+			if(Cache.Entity == InEntity || !Filter.CanCollide(Cache.Filter, LayerMatrix)) { return false; }
+
+			const FVector Direction = Cache.Position - Position;
+			return Direction.SquaredLength() < RadiusSquared && FVector::DotProduct(Direction, Normal) >= 0;
+		};
+
+		for(int32 Y = TopLeft.Y; Y <= BottomRight.Y; ++Y)
+		{
+			for(int32 X = TopLeft.X; X <= BottomRight.X; ++X)
+			{
+				const int64 Key = GetGridKey(X, Y);
+
+				FOctreeNode** OctreeNode = Grid.Find(Key);
+				if(nullptr == OctreeNode) { continue; }
+				
+				(*OctreeNode)->GetEntitiesInBox(SphereBox, OutEntities, Predicate);
+			}
+		}
+
+		// Children are only known to the ECS, so they're rejected after the cheap tests.
+		const int32 NumEntities = OutEntities.Num();
+		for(int32 IdxEntity = NumEntities - 1; IdxEntity >= 0; --IdxEntity)
+		{
+			if(OutEntities[IdxEntity].Entity.parent() == InEntity)
+			{
+				OutEntities.RemoveAt(IdxEntity, 1, EAllowShrinking::No);
+			}
+		}
+	}
+};
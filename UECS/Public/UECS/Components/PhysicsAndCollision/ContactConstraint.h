@@ -0,0 +1,38 @@
+#pragma once
+
+#include "UECS/flecs.h"
+#include "UECS/ConvexHull.h"
+
+// Working copy of a collider taking part in the contact solver. Static colliders have a zero inverse mass.
+struct FSolverBody
+{
+	FTransform Transform { FTransform::Identity };
+	FVector Velocity { FVector::ZeroVector };
+	FSupportShape Shape {};
+	flecs::entity Entity;
+	float InverseMass { 0.0f };
+
+	// Colours already used by constraints touching this body.
+	uint64 ColorMask { 0 };
+
+	FORCEINLINE bool IsDynamic() const { return InverseMass > 0.0f; }
+};
+
+// Blocking contact between two colliders, held until their solver bodies have been gathered.
+struct FSolverContact
+{
+	FVector Normal { FVector::ZeroVector };
+	uint64 EntityA { 0 };
+	uint64 EntityB { 0 };
+};
+
+struct FContactConstraint
+{
+	// Points from body A towards body B.
+	FVector Normal { FVector::ZeroVector };
+	int32 IdxBodyA { INDEX_NONE };
+	int32 IdxBodyB { INDEX_NONE };
+
+	// Accumulated normal impulse, clamped so the solver can only ever push bodies apart.
+	float NormalImpulse { 0.0f };
+};
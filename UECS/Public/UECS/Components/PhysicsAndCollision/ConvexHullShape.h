@@ -0,0 +1,19 @@
+#pragma once
+
+#include "UECS/ConvexHull.h"
+#include "UECS/EcsComponentType.h"
+
+// Overrides the support function of an entity's FCollisionShape with a convex hull. The FCollisionShape should hold the
+// hull's bounding box so the broadphase and anything that doesn't know about hulls stay conservative.
+struct FConvexHullShape
+{
+	FConvexHullRef Hull;
+
+	// The warm start vertex lives with the caller, e.g. in FNarrowPhaseCollisionCandidates, so this stays read-only.
+	FORCEINLINE FSupportShape MakeSupportShape(const FCollisionShape& Shape, const int32 WarmStartVertex = 0) const
+	{
+		return FSupportShape(Shape, Hull, WarmStartVertex);
+	}
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::ConvexHullShape; }
+};
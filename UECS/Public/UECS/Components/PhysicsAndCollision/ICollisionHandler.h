@@ -1,20 +1,52 @@
 #pragma once
 
-struct FNarrowPhaseEntityContact;
+#include "UECS/Components/PhysicsAndCollision/NarrowPhaseEntityContacts.h"
 
 namespace flecs
 {
 	struct entity;
 }
 
+struct ICollisionHandler;
+
+// A contact event waiting to be dispatched. Entity is the mover whose sweep produced the contact.
+struct FCollisionEvent
+{
+	FNarrowPhaseEntityContact Contact;
+	flecs::entity Entity;
+	TSharedPtr<ICollisionHandler> Handler { nullptr };
+};
+
 struct ICollisionHandler
 {
+	// Contact.EntityHit is the entity this handler is attached to. For end events it may already have been destroyed, in
+	// which case only its id is left.
 	virtual void Handle(const FNarrowPhaseEntityContact& Contact, const flecs::entity& OtherEntity) = 0;
 
+	// Called once per handler with every event collected for it. Override to process contacts in bulk.
+	virtual void HandleBatch(TConstArrayView<FCollisionEvent> Events)
+	{
+		for(const FCollisionEvent& Event : Events)
+		{
+			Handle(Event.Contact, Event.Entity);
+		}
+	}
+
+	// Contact events this handler wants. Handlers that only care about begin/end skip the per-frame persist calls.
+	virtual ENarrowPhaseContactEvent GetSubscribedEvents() const { return ENarrowPhaseContactEvent::All; }
+
+	// Thread-safe handlers are dispatched straight from the worker that found the contacts. They must not make
+	// structural changes to the world. Every other handler is dispatched on the calling thread at the sync point.
+	virtual bool IsThreadSafe() const { return false; }
+
 	virtual ~ICollisionHandler() = default;
+
+	// Order in which the collision system first saw this handler set through an FCollisionHandler. Batches are dispatched
+	// in this order, which unlike the handler's address is the same on every run.
+	int32 RegistrationId { INDEX_NONE };
 };
 
 struct FCollisionHandler
 {
 	TSharedPtr<ICollisionHandler> Handler { nullptr };
-};
\ No newline at end of file
+};
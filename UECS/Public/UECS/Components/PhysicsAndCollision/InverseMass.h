@@ -0,0 +1,11 @@
+#pragma once
+
+#include "UECS/EcsComponentType.h"
+
+// Inverse mass used by the contact solver. Colliders without it are treated as unit mass; zero makes a collider immovable.
+struct FInverseMass
+{
+	float Value { 1.0f };
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::InverseMass; }
+};
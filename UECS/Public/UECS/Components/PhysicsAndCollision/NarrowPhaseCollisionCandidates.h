@@ -1,8 +1,19 @@
 #pragma once
 
+#include "UECS/EcsComponentType.h"
 #include "UECS/EntityPositionCache.h"
+#include "UECS/Components/PhysicsAndCollision/ColliderTable.h"
 
 struct FNarrowPhaseCollisionCandidates
 {
 	TArray<FEntityPositionCache> Entities {};
+
+	// Collider table ids of Entities, in the same order. INDEX_NONE where the entry has no live proxy.
+	TArray<int32> ColliderIds {};
+
+	// Support vertex the entity's last hull query ended on, used to warm start the next frame. Only the narrowphase worker
+	// processing the entity writes it.
+	int32 HullWarmStartVertex { 0 };
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::NarrowPhaseCollisionCandidates; }
 };
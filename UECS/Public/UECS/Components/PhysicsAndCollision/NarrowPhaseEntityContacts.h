@@ -1,7 +1,20 @@
 #pragma once
 
+#include "UECS/EcsComponentType.h"
 #include "UECS/flecs.h"
 
+enum class ENarrowPhaseContactEvent : uint8
+{
+	None    = 0,
+	Begin   = 1 << 0,
+	Persist = 1 << 1,
+	End     = 1 << 2,
+	All     = Begin | Persist | End
+};
+ENUM_CLASS_FLAGS(ENarrowPhaseContactEvent)
+
+struct ICollisionHandler;
+
 struct FNarrowPhaseEntityContact
 {
 	FVector ContactPoint {};
@@ -9,6 +22,10 @@ struct FNarrowPhaseEntityContact
 	flecs::entity EntityHit;
 	float Time { 0.0f };
 	bool bIsBlockingHit { false };
+	ENarrowPhaseContactEvent Event { ENarrowPhaseContactEvent::None };
+
+	// Handler of EntityHit as of the last begin or persist event, so the end event still reaches it once EntityHit is gone.
+	TSharedPtr<ICollisionHandler> Handler;
 
 	bool operator==(const FNarrowPhaseEntityContact& Other) const
 	{
@@ -16,9 +33,63 @@ struct FNarrowPhaseEntityContact
 	}
 };
 
-FORCEINLINE uint32 GetTypeHash(const FNarrowPhaseEntityContact& Contact) { return Contact.EntityHit.id(); }
+using FNarrowPhaseContactArray = TArray<FNarrowPhaseEntityContact, TInlineAllocator<4>>;
 
 struct FNarrowPhaseEntityContacts
 {
-	TSet<FNarrowPhaseEntityContact> Contacts {};
+	// Contacts found during the current frame.
+	FNarrowPhaseContactArray Contacts {};
+
+	// Contacts from the previous frame, used to classify the current ones as begin/persist and to emit end events.
+	FNarrowPhaseContactArray PreviousContacts {};
+
+	FORCEINLINE static bool Contains(const FNarrowPhaseContactArray& InContacts, const flecs::entity& Entity)
+	{
+		for(const FNarrowPhaseEntityContact& Contact : InContacts)
+		{
+			if(Contact.EntityHit == Entity) { return true; }
+		}
+
+		return false;
+	}
+
+	FORCEINLINE bool Contains(const flecs::entity& Entity) const { return Contains(Contacts, Entity); }
+
+	FORCEINLINE void Add(const FNarrowPhaseEntityContact& Contact)
+	{
+		if(Contains(Contact.EntityHit)) { return; }
+
+		Contacts.Add(Contact);
+	}
+
+	// Contacts found by the most recent narrowphase, once ResolveEvents has rolled them over.
+	FORCEINLINE const FNarrowPhaseContactArray& GetResolvedContacts() const { return PreviousContacts; }
+
+	FORCEINLINE bool HasEvents() const { return Contacts.Num() > 0 || PreviousContacts.Num() > 0; }
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::NarrowPhaseEntityContacts; }
+
+	// Classifies the current contacts against the previous frame, invokes Fn for every begin, persist and end event,
+	// then rolls the current contacts over into the previous ones. Fn may update the contact, e.g. to cache its handler
+	// for the end event. End events are raised even if EntityHit has since been destroyed.
+	template<typename FuncType>
+	void ResolveEvents(FuncType&& Fn)
+	{
+		for(FNarrowPhaseEntityContact& Contact : Contacts)
+		{
+			Contact.Event = Contains(PreviousContacts, Contact.EntityHit) ? ENarrowPhaseContactEvent::Persist : ENarrowPhaseContactEvent::Begin;
+			Fn(Contact);
+		}
+
+		for(FNarrowPhaseEntityContact& PreviousContact : PreviousContacts)
+		{
+			if(Contains(Contacts, PreviousContact.EntityHit)) { continue; }
+
+			PreviousContact.Event = ENarrowPhaseContactEvent::End;
+			Fn(PreviousContact);
+		}
+
+		Swap(Contacts, PreviousContacts);
+		Contacts.Reset();
+	}
 };
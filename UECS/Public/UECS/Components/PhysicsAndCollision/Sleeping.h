@@ -0,0 +1,20 @@
+#pragma once
+
+#include "UECS/EcsComponentType.h"
+
+// Tag for colliders that have been at rest long enough to drop out of hashing, broadphase and narrowphase.
+struct FSleeping
+{
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::Sleeping; }
+};
+
+struct FSleepState
+{
+	// Consecutive frames spent under the sleep velocity thresholds.
+	int32 IdleFrames { 0 };
+
+	// Island the entity was put to sleep with. Only meaningful while FSleeping is present.
+	int32 IslandId { INDEX_NONE };
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::SleepState; }
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "UECS/EcsComponentType.h"
+
+// Position before the last fixed step. Entities that have it are drawn interpolated between the two by
+// SystemPackTransforms, using the alpha of FFixedStepClock, through the FRenderTransform that comes with it. Set it
+// along with FPosition to teleport without a blend.
+struct FPreviousPosition
+{
+	FVector Value { FVector::ZeroVector };
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::PreviousPosition; }
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "UECS/EcsComponentType.h"
 #include "UECS/flecs.h"
 
 struct FRampedMoveToEntity
@@ -8,4 +9,6 @@ struct FRampedMoveToEntity
 	float RampTime { 0.0f };
 	float RampMaxTime { 1.0f };
 	float MaxSpeed { 1000.0f };
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::RampedMoveToEntity; }
 };
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "UECS/EcsComponentType.h"
+
+// Transform an entity is drawn with, interpolated between FPreviousPosition and FPosition by SystemPackTransforms. It
+// is added and removed along with FPreviousPosition. Render only; the simulation keeps reading FTransformComponent,
+// which always holds the pose of the last fixed step.
+struct FRenderTransform
+{
+	FTransform Value;
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::RenderTransform; }
+};
@@ -1,8 +1,12 @@
 #pragma once
 
+#include "UECS/CollisionFilter.h"
+
 struct FGridMember
 {
 	int64 Hash;
 	int32 IndexInArray { -1 };
+	int32 ColliderId { INDEX_NONE };
+	FCollisionFilter Filter {};
 	struct FOctreeNode* OctreeNode { nullptr };
 };
\ No newline at end of file
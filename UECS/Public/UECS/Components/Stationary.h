@@ -4,5 +4,5 @@
 
 struct FStationary
 {
-	FORCEINLINE static int32 GetType() { return EEcsComponentType::Stationary; }
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::Stationary; }
 };
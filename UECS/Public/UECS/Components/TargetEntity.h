@@ -1,8 +1,11 @@
 #pragma once
 
+#include "UECS/EcsComponentType.h"
 #include "UECS/flecs.h"
 
 struct FTargetEntity
 {
 	flecs::entity Value;
-};
\ No newline at end of file
+
+	FORCEINLINE static constexpr int32 GetTypeId() { return EEcsComponentType::TargetEntity; }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+class UStaticMesh;
+struct FConvexHullData;
+
+using FConvexHullRef = TSharedPtr<const FConvexHullData, ESPMode::ThreadSafe>;
+
+// Immutable convex hull, shared between every collider using it. Vertices are in the hull's local space; the neighbours
+// of vertex i are Adjacency[AdjacencyOffsets[i] .. AdjacencyOffsets[i + 1]). The views either point into the hull's own
+// storage or, for baked static geometry, straight into the memory-mapped collision file.
+struct FConvexHullData
+{
+	TConstArrayView<FVector3f> Vertices;
+	TConstArrayView<int32> AdjacencyOffsets;
+	TConstArrayView<int32> Adjacency;
+
+	// Radius of the smallest origin-centred sphere holding every vertex.
+	float BoundingRadius { 0.0f };
+
+	// Half extents of the local bounding box, used as the box proxy for code that only understands FCollisionShape.
+	FVector3f Extents { FVector3f::ZeroVector };
+
+	FConvexHullData() = default;
+	FConvexHullData(FConvexHullData&&) = default;
+	FConvexHullData& operator=(FConvexHullData&&) = default;
+
+	// Copies would keep viewing the source's storage.
+	FConvexHullData(const FConvexHullData&) = delete;
+	FConvexHullData& operator=(const FConvexHullData&) = delete;
+
+	FORCEINLINE int32 Num() const { return Vertices.Num(); }
+	FORCEINLINE bool HasAdjacency() const { return AdjacencyOffsets.Num() == Vertices.Num() + 1; }
+
+	// Computes the bounding radius and extents from the current vertices.
+	void UpdateBounds();
+
+	// Backing storage for hulls built at runtime. Empty for hulls viewing external memory.
+	TArray<FVector3f> VertexStorage;
+	TArray<int32> AdjacencyOffsetStorage;
+	TArray<int32> AdjacencyStorage;
+};
+
+// Shape handed to the support function: an engine collision shape, optionally overridden by a convex hull.
+struct FSupportShape
+{
+	FCollisionShape Shape {};
+
+	// Shared with the FConvexHullShape component of the collider. Holding a reference keeps the hull alive for as long as
+	// any copy of the shape, e.g. in the collider table, even if the component is removed or replaced in the meantime.
+	FConvexHullRef Hull;
+
+	// Vertex the last hull support query ended on. The next query starts climbing from here, which usually lands on the
+	// answer in a step or two as directions change little between GJK iterations and frames.
+	mutable int32 WarmStartVertex { 0 };
+
+	FSupportShape() = default;
+	FSupportShape(const FCollisionShape& InShape) : Shape(InShape) {}
+	FSupportShape(const FCollisionShape& InShape, const FConvexHullRef& InHull, const int32 InWarmStartVertex)
+		: Shape(InShape), Hull(InHull), WarmStartVertex(InWarmStartVertex) {}
+};
+
+struct FLECSLIBRARY_API FConvexHullHelper
+{
+	// Builds a hull from its vertices and the triangles of its surface. Adjacency is taken from the triangle edges; without
+	// triangles the support function falls back to scanning every vertex.
+	static FConvexHullRef Build(TConstArrayView<FVector3f> Vertices, TConstArrayView<int32> Indices);
+
+	// Fills OutOffsets/OutAdjacency with the unique edge neighbours of every vertex, as used by FConvexHullData.
+	static void BuildAdjacency(int32 NumVertices, TConstArrayView<int32> Indices, TArray<int32>& OutOffsets, TArray<int32>& OutAdjacency);
+
+	// Bakes one hull per convex element of the mesh's simple collision, with the element transform applied.
+	static TArray<FConvexHullRef> BakeFromStaticMesh(const UStaticMesh* StaticMesh);
+
+	// Hill-climbs the vertex graph from StartVertex to the vertex furthest along LocalDirection.
+	static int32 FindSupportVertex(const FConvexHullData& Hull, const FVector3f& LocalDirection, int32 StartVertex);
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace flecs
+{
+	struct iter;
+}
+
+// Lets a system skip tables whose read columns haven't been written since it last iterated them, using flecs' table
+// change detection. Skipped tables don't get their written columns marked dirty either, so skipping carries over to
+// systems further down that gate on them.
+//
+// Flecs only sees writes made through out/inout query terms, set() or modified(); a value changed through a bare
+// get_mut() pointer goes unnoticed. Tracking is per table, so a single moving entity keeps its whole table processed.
+struct FLECSLIBRARY_API FEcsChangeFilter
+{
+	// Call at the start of every run, before the first ShouldProcess.
+	FORCEINLINE void BeginRun()
+	{
+		NumTables = 0;
+		NumSkippedTables = 0;
+	}
+
+	// Whether the system has to process the iterator's current table; if not, the table is skipped. bForce processes
+	// it either way, for output that depends on more than the table's columns.
+	bool ShouldProcess(flecs::iter& Iterator, bool bForce = false);
+
+	// Share of tables skipped by the last run.
+	FORCEINLINE float GetSkipRatio() const { return NumTables > 0 ? static_cast<float>(NumSkippedTables) / NumTables : 0.0f; }
+	FORCEINLINE int32 GetNumTables() const { return NumTables; }
+	FORCEINLINE int32 GetNumSkippedTables() const { return NumSkippedTables; }
+
+	// Off by default: the first change query on a flecs query starts tracking for all its tables, which costs a little
+	// on every write to them.
+	bool bEnabled { false };
+
+private:
+	int32 NumTables { 0 };
+	int32 NumSkippedTables { 0 };
+};
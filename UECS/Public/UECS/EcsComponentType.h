@@ -4,12 +4,15 @@ enum EEcsComponentType : int32
 {
 	AngularVelocity = 0,
 	AggroRadius,
+	CcdMode,
 	CollisionEnabled,
 	CollisionGridMember,
 	CollisionShape,
+	ConvexHullShape,
 	Cooldown,
 	EntityGridHash,
 	Health,
+	InverseMass,
 	MaxTargetDistance,
 	MovementInput,
 	NarrowPhaseCollisionCandidates,
@@ -27,6 +30,8 @@ enum EEcsComponentType : int32
 	RampedMoveToEntity,
 	Radius,
 	Reserved,
+	SleepState,
+	Sleeping,
 	SpatialHashMember,
 	Speed,
 	Stationary,
@@ -35,5 +40,8 @@ enum EEcsComponentType : int32
 	TransformComponent,
 	Velocity,
 	TargetEntity,
+	AtTarget,
+	PreviousPosition,
+	RenderTransform,
 	MAX,
 };
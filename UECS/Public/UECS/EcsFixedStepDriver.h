@@ -0,0 +1,66 @@
+#pragma once
+
+#include "UECS/Components/EcsSystemTickDebt.h"
+
+struct FPosition;
+struct FPreviousPosition;
+
+namespace flecs
+{
+	struct world;
+	template<typename ... Components> struct query;
+}
+
+// Runs simulation systems at a fixed rate, however long frames take. Every frame's delta time goes into an
+// FEcsSystemTickDebt, and each whole tick owed runs the registered steps once, in order, with the fixed delta time. At
+// most MaxStepsPerFrame steps run per frame and the rest are dropped, so one slow frame can't pile up ever more
+// catch-up work.
+//
+// Before each step, FPosition is copied to FPreviousPosition on entities that have one. The leftover debt is published
+// as the alpha of the FFixedStepClock singleton, so rendering can blend the two and stay smooth between steps.
+class FLECSLIBRARY_API FEcsFixedStepDriver
+{
+public:
+	using FStepFunction = TFunction<void(float FixedDeltaTime, flecs::world& World)>;
+
+	FEcsFixedStepDriver(flecs::world& InWorld, float InFixedDeltaTime = 1.0f / 60.0f, int32 InMaxStepsPerFrame = 4);
+	~FEcsFixedStepDriver();
+
+	// Steps run in the order they were added. A scheduler can be driven with
+	// AddStep(TEXT("Simulation"), [&Scheduler](const float Dt, flecs::world&) { Scheduler.Run(Dt); }).
+	void AddStep(const TCHAR* Name, FStepFunction Function);
+
+	// Adds DeltaTime to the debt and runs the steps it pays for. Returns the number of steps run.
+	int32 Advance(float DeltaTime);
+
+	void SetFixedDeltaTime(float InFixedDeltaTime);
+	FORCEINLINE float GetFixedDeltaTime() const { return TickDebt.TickInterval; }
+
+	void SetMaxStepsPerFrame(int32 InMaxStepsPerFrame);
+	FORCEINLINE int32 GetMaxStepsPerFrame() const { return MaxStepsPerFrame; }
+
+	FORCEINLINE float GetAlpha() const { return TickDebt.GetAlpha(); }
+	FORCEINLINE uint64 GetNumSteps() const { return NumSteps; }
+	FORCEINLINE uint64 GetNumDroppedSteps() const { return NumDroppedSteps; }
+
+private:
+	struct FStep
+	{
+		const TCHAR* Name;
+		FStepFunction Function;
+	};
+
+	void SnapshotPreviousPositions() const;
+	void PublishClock() const;
+
+	flecs::world& World;
+	FEcsSystemTickDebt TickDebt;
+	int32 MaxStepsPerFrame { 4 };
+
+	uint64 NumSteps { 0 };
+	uint64 NumDroppedSteps { 0 };
+
+	TArray<FStep> Steps;
+
+	flecs::query<const FPosition, FPreviousPosition>* QueryPreviousPositions { nullptr };
+};
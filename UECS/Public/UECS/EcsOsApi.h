@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace flecs
+{
+	struct world;
+}
+
+// Points the flecs OS API at the engine, so flecs shares cores, memory and logs with everything else instead of
+// bringing its own. Allocations go through FMemory, mutexes and condition variables are built on FCriticalSection and
+// pooled FEvents, logs go to LogTemp and time comes from FPlatformTime.
+//
+// Task threads (set_task_threads) run as UE::Tasks on the engine's workers, next to the scheduler's stages. Long-lived
+// worker threads (set_threads) block between frames, which would tie up task workers for good, so those become engine
+// FRunnableThreads instead; prefer task threads.
+struct FLECSLIBRARY_API FEcsOsApi
+{
+	// Must run before the first flecs world is created, as flecs keeps the OS API it started with. The module installs it
+	// on startup. Returns false if flecs was already using another one.
+	static bool Install();
+	static bool IsInstalled();
+
+	// Flecs task threads wait on each other at every sync point, so there may never be more of them than task workers
+	// to run them all at once.
+	static int32 GetMaxTaskThreads();
+
+	// set_task_threads, clamped to GetMaxTaskThreads.
+	static void SetTaskThreads(const flecs::world& World, int32 NumTaskThreads);
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+
+#include "CoreMinimal.h"
+#include "Algo/BinarySearch.h"
+#include "UECS/flecs.h"
+
+// Work-stealing parallel-for over the entities of a query. Reset splits [0, NumItems) into GrainSize-sized chunks and
+// deals each thread a contiguous run of them; Run processes the calling thread's run front to back, then steals half of
+// whatever is left at the back of another thread's run until nothing is left anywhere. Threads that land on cheap
+// entities end up helping the ones stuck on expensive ones, which a static worker(IdxThread, NumThreads) split can't do.
+//
+// Reset with a query resolves the tables it matches once, and Each maps every chunk straight to row ranges of those
+// tables, so a chunk costs a binary search rather than a walk over the query. Chunks cut across tables. The matched
+// entities must not change between Reset and the last Run of the frame.
+class FLECSLIBRARY_API FEcsParallelFor
+{
+public:
+	struct FThreadStats
+	{
+		int32 NumChunks { 0 };
+		int32 NumStolenChunks { 0 };
+		int32 NumItems { 0 };
+		uint64 BusyCycles { 0 };
+		uint64 FirstCycle { 0 };
+		uint64 LastCycle { 0 };
+	};
+
+	FEcsParallelFor(const TCHAR* InName, int32 InGrainSize);
+	~FEcsParallelFor();
+
+	FEcsParallelFor(const FEcsParallelFor&) = delete;
+	FEcsParallelFor& operator=(const FEcsParallelFor&) = delete;
+
+	// Deals out the chunks of the frame. Must not overlap any Run.
+	void Reset(int32 InNumItems, int32 NumThreads);
+
+	// Deals out the rows of the tables Query matches right now, for Each. Walks the query's tables without iterating
+	// them, but syncs the change monitors of queries gated on changed(), so it's not meant for those.
+	void Reset(const flecs::query_base& Query, int32 NumThreads);
+
+	// Calls Fn like Query.each() for the entities of the chunks this thread gets, iterating on Stage, so changes made
+	// through those entities are queued on it. Query must be the one of the last Reset.
+	template<typename ... Components, typename FuncType>
+	void Each(const int32 IdxThread, flecs::world& Stage, const flecs::query<Components...>& Query, FuncType&& Fn)
+	{
+		check(static_cast<flecs::query_t*>(Query) == ResolvedQuery);
+
+		using FDelegate = flecs::_::each_delegate<FuncType, Components...>;
+		Run(IdxThread, [this, &Stage, &Fn](const int32 Offset, const int32 Count)
+		{
+			ForEachTableRange(Offset, Count, [this, &Stage, &Fn](const int32 IdxTable, const int32 RowOffset, const int32 NumRows)
+			{
+				ecs_iter_t TableIterator;
+				if(!InitTableIterator(Stage, IdxTable, TableIterator)) { return; }
+
+				ecs_iter_t PageIterator = ecs_page_iter(&TableIterator, RowOffset, NumRows);
+				if(FDelegate::instanced()) { ECS_BIT_SET(PageIterator.flags, EcsIterIsInstanced); }
+
+				while(ecs_page_next(&PageIterator))
+				{
+					FDelegate(Fn).invoke(&PageIterator);
+				}
+			});
+		});
+	}
+
+	// Calls Fn(Offset, Count) for chunks until none are left. Safe to call from any number of threads at once, each with
+	// its own IdxThread in [0, NumThreads).
+	template<typename FuncType>
+	void Run(const int32 IdxThread, FuncType&& Fn)
+	{
+		if(!Threads.IsValidIndex(IdxThread)) { return; }
+
+		FThreadState& State = Threads[IdxThread];
+		int32 IdxChunk;
+		while(Pop(IdxThread, IdxChunk) || Steal(IdxThread, IdxChunk))
+		{
+			const int32 Offset = IdxChunk * ChunkSize;
+			const int32 Count = FMath::Min(ChunkSize, NumItems - Offset);
+
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Fn(Offset, Count);
+			const uint64 EndCycles = FPlatformTime::Cycles64();
+
+			if(0 == State.Stats.NumChunks) { State.Stats.FirstCycle = StartCycles; }
+			State.Stats.LastCycle = EndCycles;
+			State.Stats.BusyCycles += EndCycles - StartCycles;
+			State.Stats.NumItems += Count;
+			++State.Stats.NumChunks;
+		}
+	}
+
+	// Stats of the last frame, per thread. Only meaningful once every Run of the frame has returned.
+	void GetThreadStats(TArray<FThreadStats>& OutStats) const;
+
+	// Fraction of the frame's span, from the first chunk started on any thread to the last one finished, each thread
+	// spent inside Fn.
+	void GetThreadUtilization(TArray<float>& OutUtilization) const;
+
+	FORCEINLINE const TCHAR* GetName() const { return Name; }
+
+	// Items dealt out by the last Reset.
+	FORCEINLINE int32 GetNumItems() const { return NumItems; }
+
+	// Entities per chunk. Smaller balances uneven per-entity cost better, larger pays for fewer table iterators. Takes
+	// effect on the next Reset.
+	int32 GrainSize { 64 };
+
+private:
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FThreadState
+	{
+		// Remaining chunks of the thread, Begin in the low and End in the high 32 bits, so owner and thieves can
+		// update both ends with a single compare-exchange.
+		std::atomic<uint64> Range { 0 };
+
+		FThreadStats Stats;
+	};
+
+	FORCEINLINE static uint64 PackRange(const uint32 Begin, const uint32 End) { return (uint64(End) << 32) | Begin; }
+
+	bool Pop(int32 IdxThread, int32& OutIdxChunk);
+	bool Steal(int32 IdxThread, int32& OutIdxChunk);
+
+	// Calls Fn(IdxTable, RowOffset, NumRows) for every resolved table the items [Offset, Offset + Count) fall into.
+	template<typename FuncType>
+	void ForEachTableRange(const int32 Offset, const int32 Count, FuncType&& Fn) const
+	{
+		const int32 End = Offset + Count;
+		int32 IdxItem = Offset;
+		for(int32 IdxTable = Algo::UpperBound(TableEnds, Offset); IdxItem < End && IdxTable < TableEnds.Num(); ++IdxTable)
+		{
+			const int32 TableBegin = IdxTable > 0 ? TableEnds[IdxTable - 1] : 0;
+			const int32 ItemEnd = FMath::Min(End, TableEnds[IdxTable]);
+			Fn(IdxTable, IdxItem - TableBegin, ItemEnd - IdxItem);
+			IdxItem = ItemEnd;
+		}
+	}
+
+	// Query iterator on Stage, narrowed down to the resolved table IdxTable. False if the query matches nothing.
+	bool InitTableIterator(flecs::world& Stage, int32 IdxTable, ecs_iter_t& OutIterator) const;
+
+	const TCHAR* Name;
+	int32 NumItems { 0 };
+	int32 ChunkSize { 1 };
+
+	// Query of the last Reset with one, its matched tables, and the end of each table's rows in the items.
+	flecs::query_t* ResolvedQuery { nullptr };
+	TArray<ecs_table_t*> Tables;
+	TArray<int32> TableEnds;
+
+	TArray<FThreadState, TAlignedHeapAllocator<PLATFORM_CACHE_LINE_SIZE>> Threads;
+};
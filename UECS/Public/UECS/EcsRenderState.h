@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/TaskGraphInterfaces.h"
+
+namespace flecs
+{
+	struct world;
+}
+
+// Everything a frame hands over to Unreal, packed flat so it can be built on workers. Entities are packed by id, and
+// their actors and instance indices are only looked up when the buffer is applied on the game thread.
+struct FEcsRenderBuffer
+{
+	struct FIsmBatch
+	{
+		// Entity the FInstancedStaticMesh is read from, usually the prefab the members are instances of.
+		uint64 IsmEntity { 0 };
+		TArray<uint64> Entities;
+		TArray<FTransform> Transforms;
+	};
+
+	TArray<uint64> ActorEntities;
+	TArray<FTransform> ActorTransforms;
+	TArray<FIsmBatch> IsmBatches;
+
+	// Keeps the allocations, since about as much is packed again next frame.
+	void Reset();
+	bool IsEmpty() const { return ActorEntities.IsEmpty() && IsmBatches.IsEmpty(); }
+};
+
+// Double-buffered hand-off of final transforms from the ECS to actors and instanced static meshes. Systems pack into
+// the write buffer at the end of a simulation step, from any one thread (see SystemPackTransforms::Pack and
+// SystemStaticMeshDraw::Pack), without touching any UObject. Submit swaps the buffers and queues a game thread task that
+// applies the packed state once the game thread next processes its queue, or at the latest on the next Submit or Flush.
+//
+// Apply does not overlap the simulation: a scheduler Run on the game thread blocks in its waits without processing the
+// game thread queue, so Apply runs before or after it. What the split buys is packing on workers instead of iterating
+// UObjects from the stages, and the UObject updates landing in one batch outside of Run.
+//
+// Unreal state lags the ECS by one step. Apply reads each entity's actor and ISM instance index from the world as they
+// are at that point, so instances swap-removed since packing still update the right slot, and dead entities are
+// skipped. It must therefore not overlap a structural merge of the world, which holds as long as the scheduler is run
+// from the game thread as well.
+class FLECSLIBRARY_API FEcsRenderState
+{
+public:
+	explicit FEcsRenderState(flecs::world& InWorld);
+	~FEcsRenderState();
+
+	// Buffer to pack the current step into. Not to be used across a Submit.
+	FORCEINLINE FEcsRenderBuffer& GetWriteBuffer() { return Buffers[IdxWriteBuffer]; }
+
+	// Waits for the previous buffer to be applied, swaps, and queues the one just packed to be applied on the game
+	// thread. Call once per step, after every Pack has finished.
+	void Submit();
+
+	// Waits until the last submitted buffer has been applied. Running on the game thread, it applies the buffer itself
+	// if the task hasn't had its turn yet.
+	void Flush();
+
+	FORCEINLINE bool IsApplyPending() const { return ApplyTask.IsValid() && !ApplyTask->IsComplete(); }
+
+private:
+	void Apply(const FEcsRenderBuffer& Buffer) const;
+
+	flecs::world& World;
+
+	FEcsRenderBuffer Buffers[2];
+	int32 IdxWriteBuffer { 0 };
+
+	FGraphEventRef ApplyTask;
+};
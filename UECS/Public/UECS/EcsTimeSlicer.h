@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Spreads a system's entities over NumSlices frames. Each frame only entities of the current slice are processed, in
+// rotation, and each slice is handed the time that really passed since its last turn, so rate-based work comes out the
+// same as processing everything every frame. Entities are assigned to slices by their index, which doesn't change over
+// their lifetime.
+struct FEcsTimeSlicer
+{
+	// Moves on to the next slice. Call once per frame, before any IsInSlice.
+	FORCEINLINE void Advance(const float DeltaTime)
+	{
+		const int32 NumSlicesClamped = FMath::Max(NumSlices, 1);
+		if(SliceElapsed.Num() != NumSlicesClamped)
+		{
+			SliceElapsed.Init(0.0f, NumSlicesClamped);
+			CurrentSlice = -1;
+		}
+
+		for(float& Elapsed : SliceElapsed) { Elapsed += DeltaTime; }
+
+		CurrentSlice = (CurrentSlice + 1) % NumSlicesClamped;
+		CurrentDeltaTime = SliceElapsed[CurrentSlice];
+		SliceElapsed[CurrentSlice] = 0.0f;
+	}
+
+	// Entities in the slice get GetDeltaTime() as their delta, not the frame's.
+	FORCEINLINE bool IsInSlice(const uint64 EntityId) const
+	{
+		return SliceElapsed.Num() <= 1 || static_cast<int32>(static_cast<uint32>(EntityId) % SliceElapsed.Num()) == CurrentSlice;
+	}
+
+	// Time that really passed for every entity in the current slice since it was last processed, the frames it sat out
+	// included. Equal to the frame's delta with a single slice.
+	FORCEINLINE float GetDeltaTime() const { return CurrentDeltaTime; }
+
+	// Takes effect on the next Advance. 1 processes every entity every frame.
+	int32 NumSlices { 1 };
+
+private:
+	TArray<float> SliceElapsed;
+	int32 CurrentSlice { 0 };
+	float CurrentDeltaTime { 0.0f };
+};
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "flecs.h"
+#include "CollisionFilter.h"
 
 struct FEntityPositionCache
 {
 	flecs::entity Entity;
 	FVector Position;
+	int32 ColliderId { INDEX_NONE };
+	FCollisionFilter Filter {};
 };
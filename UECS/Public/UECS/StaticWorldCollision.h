@@ -0,0 +1,114 @@
+#pragma once
+
+#include "UECS/CollisionHelper.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// On-disk layout of a baked static collision file. Every section starts on a 16 byte boundary and is read in place.
+namespace StaticWorldCollision
+{
+	static constexpr uint32 Magic { 0x45435357 }; // "WSCE"
+	static constexpr uint32 Version { 1 };
+	static constexpr int32 LeafSize { 4 };
+
+	struct FHeader
+	{
+		uint32 Magic { StaticWorldCollision::Magic };
+		uint32 Version { StaticWorldCollision::Version };
+
+		int32 NumNodes { 0 };
+		int32 NumHulls { 0 };
+		int32 NumVertices { 0 };
+		int32 NumAdjacencyOffsets { 0 };
+		int32 NumAdjacency { 0 };
+		int32 NumHeightfields { 0 };
+		int32 NumHeights { 0 };
+
+		uint64 NodesOffset { 0 };
+		uint64 HullsOffset { 0 };
+		uint64 VerticesOffset { 0 };
+		uint64 AdjacencyOffsetsOffset { 0 };
+		uint64 AdjacencyOffset { 0 };
+		uint64 HeightfieldsOffset { 0 };
+		uint64 HeightsOffset { 0 };
+	};
+
+	// Leaves reference Count hulls starting at First; inner nodes have a zero Count and their children at First and First + 1.
+	struct FBvhNode
+	{
+		FVector3f Min;
+		int32 First;
+		FVector3f Max;
+		int32 Count;
+	};
+
+	// Vertices are stored relative to Center, which keeps them precise in single floats far from the world origin.
+	struct FHull
+	{
+		FVector3f Center;
+		int32 FirstVertex;
+		int32 NumVertices;
+		int32 FirstAdjacencyOffset;
+		int32 NumAdjacencyOffsets;
+		int32 FirstAdjacency;
+		int32 NumAdjacency;
+		int32 Padding[3];
+	};
+
+	// Regular grid of heights, sample (X, Y) at Origin + (X * CellSize.X, Y * CellSize.Y, Height).
+	struct FHeightfield
+	{
+		FVector3f Origin;
+		int32 FirstHeight;
+		FVector2f CellSize;
+		int32 NumX;
+		int32 NumY;
+	};
+}
+
+// ECS-owned static world geometry: a BVH over baked convex hulls plus landscape heightfields. Loaded from a file that is
+// memory-mapped where the platform allows it. Queries are const and safe to run from any number of worker threads.
+class FLECSLIBRARY_API FStaticWorldCollision
+{
+public:
+	FStaticWorldCollision();
+	~FStaticWorldCollision();
+
+	bool Load(const FString& Filename);
+	void Unload();
+
+	FORCEINLINE bool IsLoaded() const { return nullptr != Header; }
+
+	// Conservative advancement of Shape from From to To against every hull and heightfield triangle in its swept bounds.
+	// Returns true and the earliest contact if anything was hit, or a sweep stopped short of one (bStoppedShort, no contact).
+	bool Sweep(const FSupportShape& Shape, const FTransform& From, const FTransform& To, FConservativeAdvancementOutput& OutHit) const;
+
+	// Appends the hulls whose bounds overlap Box.
+	void GetHullsInBox(const FBox3f& Box, TArray<int32>& OutHulls) const;
+
+	// Bakes the simple collision of every static mesh component and the heightfield of every landscape in World.
+	static bool Bake(UWorld* World, const FString& Filename);
+
+private:
+	bool SweepHeightfield(const StaticWorldCollision::FHeightfield& Heightfield, const FSupportShape& Shape, const FTransform& From, const FTransform& To,
+	                      const FBox3f& SweptBounds, FConservativeAdvancementOutput& InOutHit) const;
+
+	bool Bind(const uint8* Data, int64 Size);
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// Used when the file couldn't be mapped.
+	TArray<uint8> LoadedData;
+
+	const StaticWorldCollision::FHeader* Header { nullptr };
+	TConstArrayView<StaticWorldCollision::FBvhNode> Nodes;
+	TConstArrayView<StaticWorldCollision::FHull> HullRecords;
+	TConstArrayView<StaticWorldCollision::FHeightfield> Heightfields;
+	TConstArrayView<float> Heights;
+
+	// Support views over the mapped hull data, one per hull record. Reference counted like every other hull, so support
+	// shapes can hold them; they must still not outlive the mapped file.
+	TArray<FConvexHullRef> Hulls;
+};
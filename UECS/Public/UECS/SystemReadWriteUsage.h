@@ -1,7 +1,131 @@
 #pragma once
 
+#include <initializer_list>
+#include <type_traits>
+
+#include "UECS/EcsComponentType.h"
+
+struct FCollisionShape;
+
+namespace flecs
+{
+	template<typename ... Components> struct query;
+	template<typename ... Components> struct worker_iterable;
+}
+
+// Component id of an ECS component, from its static GetTypeId. Components we don't own, such as engine types stored
+// directly on entities, get a specialization below.
+template<typename T>
+struct TEcsComponentTypeId
+{
+	static constexpr int32 Value = T::GetTypeId();
+};
+
+template<>
+struct TEcsComponentTypeId<FCollisionShape>
+{
+	static constexpr int32 Value = EEcsComponentType::CollisionShape;
+};
+
+// Fixed-width set of EEcsComponentType ids, one bit per component.
+struct FEcsComponentSet
+{
+	static constexpr int32 NumWords = (EEcsComponentType::MAX + 63) / 64;
+
+	constexpr FEcsComponentSet() = default;
+
+	constexpr FEcsComponentSet(std::initializer_list<int32> Components)
+	{
+		for(const int32 Component : Components) { Add(Component); }
+	}
+
+	constexpr void Add(const int32 Component)
+	{
+		Words[Component / 64] |= uint64(1) << (Component % 64);
+	}
+
+	constexpr bool Contains(const int32 Component) const
+	{
+		return (Words[Component / 64] & (uint64(1) << (Component % 64))) != 0;
+	}
+
+	constexpr bool Intersects(const FEcsComponentSet& Other) const
+	{
+		for(int32 IdxWord = 0; IdxWord < NumWords; ++IdxWord)
+		{
+			if(Words[IdxWord] & Other.Words[IdxWord]) { return true; }
+		}
+		return false;
+	}
+
+	constexpr FEcsComponentSet operator|(const FEcsComponentSet& Other) const
+	{
+		FEcsComponentSet Result;
+		for(int32 IdxWord = 0; IdxWord < NumWords; ++IdxWord)
+		{
+			Result.Words[IdxWord] = Words[IdxWord] | Other.Words[IdxWord];
+		}
+		return Result;
+	}
+
+	uint64 Words[NumWords] {};
+};
+
 struct FSystemReadWriteUsage
 {
-	TSet<int32> Reads;
-	TSet<int32> Writes;
-};
\ No newline at end of file
+	FEcsComponentSet Reads;
+	FEcsComponentSet Writes;
+
+	// Whether the two can't run at the same time: either one writes a component the other reads or writes.
+	constexpr bool Conflicts(const FSystemReadWriteUsage& Other) const
+	{
+		return Writes.Intersects(Other.Reads | Other.Writes) || Other.Writes.Intersects(Reads);
+	}
+
+	constexpr FSystemReadWriteUsage operator|(const FSystemReadWriteUsage& Other) const
+	{
+		return { .Reads = Reads | Other.Reads, .Writes = Writes | Other.Writes };
+	}
+
+	// Components touched outside the query terms, e.g. read from other entities through get().
+	template<typename ... Components>
+	constexpr FSystemReadWriteUsage WithReads() const
+	{
+		FSystemReadWriteUsage Result = *this;
+		(Result.Reads.Add(TEcsComponentTypeId<std::remove_const_t<Components>>::Value), ...);
+		return Result;
+	}
+
+	// Components written outside the query terms, e.g. tags added or removed, or other entities changed through get_mut().
+	template<typename ... Components>
+	constexpr FSystemReadWriteUsage WithWrites() const
+	{
+		FSystemReadWriteUsage Result = *this;
+		(Result.Writes.Add(TEcsComponentTypeId<std::remove_const_t<Components>>::Value), ...);
+		return Result;
+	}
+};
+
+// Usage of a query with the given terms. Every term is read, non-const terms are written as well.
+template<typename ... Components>
+constexpr FSystemReadWriteUsage MakeSystemReadWriteUsage()
+{
+	FSystemReadWriteUsage Usage;
+	(Usage.Reads.Add(TEcsComponentTypeId<std::remove_const_t<Components>>::Value), ...);
+	([&Usage]()
+	{
+		if constexpr(!std::is_const_v<Components>) { Usage.Writes.Add(TEcsComponentTypeId<std::remove_const_t<Components>>::Value); }
+	}(), ...);
+	return Usage;
+}
+
+// Declares a system query from its terms. Members typed through FQuery/FWorker have to be built with exactly these terms,
+// so the usage derived from them can't drift from what the system iterates.
+template<typename ... Components>
+struct TEcsSystemQuery
+{
+	using FQuery = flecs::query<Components...>;
+	using FWorker = flecs::worker_iterable<Components...>;
+
+	static constexpr FSystemReadWriteUsage GetUsage() { return MakeSystemReadWriteUsage<Components...>(); }
+};
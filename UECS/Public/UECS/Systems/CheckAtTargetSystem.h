@@ -1,7 +1,7 @@
 #pragma once
 #include "UECS/flecs.h"
+#include "UECS/SystemReadWriteUsage.h"
 
-struct FSystemReadWriteUsage;
 struct FMaxTargetDistance;
 struct FTargetEntity;
 struct FPosition;
@@ -9,16 +9,20 @@ struct FPosition;
 namespace flecs
 {
 	struct world;
-	template<typename ... Components> struct query;
 }
 
 struct FLECSLIBRARY_API FCheckAtTargetSystem
 {
 	FCheckAtTargetSystem(flecs::world& World);
+	// FAtTarget is added and removed through World, so when run from a stage the flag only changes once the stage's
+	// commands are merged.
 	void Iter(const float DeltaTime, flecs::world& World) const;
+	void Schedule(class UnrealEcsSystemScheduler& Scheduler);
 
 	static FSystemReadWriteUsage GetSystemReadWriteUsage();
 	
 private:
-	flecs::query<const FPosition, const FTargetEntity, const FMaxTargetDistance>* QueryCheckAtTarget { nullptr };
+	using FQueryCheckAtTarget = TEcsSystemQuery<const FPosition, const FTargetEntity, const FMaxTargetDistance>;
+
+	FQueryCheckAtTarget::FQuery* QueryCheckAtTarget { nullptr };
 };
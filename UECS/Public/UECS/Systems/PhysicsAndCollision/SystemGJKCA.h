@@ -1,7 +1,14 @@
 #pragma once
 
+#include "UECS/CollisionHelper.h"
+#include "UECS/CollisionQuery.h"
+#include "UECS/EcsParallelFor.h"
+#include "UECS/StaticWorldCollision.h"
 #include "UECS/SystemReadWriteUsage.h"
+#include "UECS/Components/PhysicsAndCollision/ColliderTable.h"
 #include "UECS/Components/PhysicsAndCollision/CollisionSpatialGrid.h"
+#include "UECS/Components/PhysicsAndCollision/ContactConstraint.h"
+#include "UECS/Components/PhysicsAndCollision/ICollisionHandler.h"
 #include "UECS/Components/PhysicsAndCollision/NarrowPhaseEntityContacts.h"
 
 struct FNarrowPhaseEntityContacts;
@@ -13,13 +20,14 @@ struct FCollisionResults;
 struct FTransformComponent;
 struct FCollisionGridMember;
 struct FPosition;
+struct FSleepState;
+struct FConvexHullShape;
+struct FInverseMass;
 
 namespace flecs
 {
 	struct entity;
 	struct world;
-	template<typename ... Components> struct query;
-	template<typename ... Components> struct worker_iterable;
 }
 
 struct FLECSLIBRARY_API FSystemGJKCA
@@ -31,24 +39,189 @@ struct FLECSLIBRARY_API FSystemGJKCA
 	void Iter_Broadphase(const float DeltaTime, flecs::world& FlecsWorld, int32 IdxThread);
 	void Iter_NarrowPhase(float DeltaTime, flecs::world& FlecsWorld, int32 IdxThread);
 
+	// Turns the contacts found by the narrowphase into collision events. Must not start before every Iter_NarrowPhase
+	// worker has finished, since any of them may still be writing the contacts of an entity.
+	void Iter_CollisionPairs(float DeltaTime, flecs::world& FlecsWorld, int32 IdxThread);
+
+	// Contact solver. PrepContactSolver gathers the blocking contacts of the last collision pairs and colours them so no
+	// two constraints of a colour share a dynamic body. For each of NumContactSolverIterations, Iter_SolveContacts runs
+	// for every colour in order, fanning each colour out over the worker threads, then FinishContactSolver writes the
+	// corrected positions and velocities back. Iter_ContactSolver does all of it and is what Schedule registers; it has to
+	// run with exclusive access to the world.
+	void Iter_ContactSolver(float DeltaTime, flecs::world& FlecsWorld);
+	void PrepContactSolver(float DeltaTime, flecs::world& FlecsWorld);
+	void Iter_SolveContacts(int32 IdxColor, int32 IdxThread);
+	void FinishContactSolver();
+	FORCEINLINE int32 GetNumContactColors() const { return ContactColors.Num(); }
+
+	// Splits the frame's work over NumThreads workers. Must be called every frame, before the broadphase.
 	void Prep(int32 NumThreads);
 
+	// Registers hashing, broadphase, narrowphase, collision pairs, contact solving, event dispatch and sleeping with the
+	// scheduler, in that order.
+	void Schedule(class UnrealEcsSystemScheduler& Scheduler, UWorld* World);
+
+	// Enables or disables contacts between two collision layers, both in [0, MaxCollisionLayers); out of range layers are
+	// ignored. Must not be called while the broadphase is running.
+	void SetLayersCollide(int32 LayerA, int32 LayerB, bool bCollide);
+
+	// Sync point for collision events. Must run after every Iter_CollisionPairs worker has finished; dispatches all events
+	// that weren't already handled on a worker thread. Schedule registers it as the CollisionEvents stage. Callers driving
+	// the Iter_* functions themselves should call it on the game thread once the pairs are done; if they don't, the next
+	// Iter_Hashing dispatches the leftovers a frame late.
+	void DispatchCollisionEvents();
+
+	// Puts islands of resting colliders to sleep and wakes islands that were touched by a contact or had their velocity
+	// changed. Runs on the game thread after the collision events have been dispatched.
+	void Iter_Sleep(float DeltaTime, flecs::world& FlecsWorld);
+
+	// Wakes the entity together with every entity it was put to sleep with.
+	void WakeEntity(const flecs::entity& Entity);
+
+	// Conservative advancement iteration counts of every narrowphase sweep since the last reset, merged over all threads.
+	FConservativeAdvancementHistogram GetConservativeAdvancementHistogram() const;
+	void ResetConservativeAdvancementHistogram();
+
+	// Loads static world geometry baked by FStaticWorldCollision::Bake. Movers and movement polylines are swept against it
+	// in Iter_NarrowPhase after their dynamic candidates. Must not be called while the narrowphase is running.
+	FORCEINLINE bool LoadStaticWorldCollision(const FString& Filename) { return StaticWorldCollision.Load(Filename); }
+	FORCEINLINE void UnloadStaticWorldCollision() { StaticWorldCollision.Unload(); }
+
+	// Gameplay queries against the collision grid as of the last Iter_Hashing, seeing every collider that isn't filtered
+	// out by the query's layer mask, whether asleep or awake. Candidates are treated as stationary. Safe to call from any
+	// number of threads at once; they block while Iter_Hashing or a structural change rewrites the grid. The batched
+	// overloads take the lock once for the whole batch.
+	bool OverlapShape(const FCollisionOverlapQuery& Query, TArray<FCollisionQueryHit>& OutHits);
+	bool SweepShape(const FCollisionSweepQuery& Query, FCollisionQueryHit& OutHit);
+	bool Raycast(const FCollisionRaycastQuery& Query, FCollisionQueryHit& OutHit);
+
+	// Hits of query i are OutHits[OutHitOffsets[i] .. OutHitOffsets[i + 1]).
+	void OverlapShapes(TConstArrayView<FCollisionOverlapQuery> Queries, TArray<FCollisionQueryHit>& OutHits, TArray<int32>& OutHitOffsets);
+
+	// One hit per query, with a zero entity for misses.
+	void SweepShapes(TConstArrayView<FCollisionSweepQuery> Queries, TArray<FCollisionQueryHit>& OutHits);
+	void Raycasts(TConstArrayView<FCollisionRaycastQuery> Queries, TArray<FCollisionQueryHit>& OutHits);
+
+	// Hash of the id, position and velocity of every collider, in entity id order. Lockstep peers, or runs of the same
+	// simulation with different thread counts, can compare it frame by frame to find the first divergence.
+	uint64 HashCollisionState(flecs::world& FlecsWorld);
+
 	static FSystemReadWriteUsage GetSystemReadWriteUsage();
 
 	TAtomic<int> Iterated { 0 };
 
+	// When set, handlers that declare themselves thread-safe receive their batches on the worker threads.
+	bool bDispatchThreadSafeHandlersOnWorkers { true };
+
+	// Lockstep mode. Every event is dispatched at the sync point, in handler registration and entity order, and the
+	// narrowphase skips the SIMD lanes, so every pair goes through the scalar kernels at ecs.Collision.KernelPrecision
+	// (double by default). That makes results independent of the thread count and of the SIMD width. It is not a strict
+	// floating point mode: peers only agree bit for bit when they run the same build on the same platform with the same
+	// kernel precision, as the kernels use the platform's sqrt and trigonometry.
+	bool bDeterministic { false };
+
+	// Colliders moving slower than these thresholds for SleepFrames consecutive frames are put to sleep.
+	float SleepLinearVelocityThreshold { 5.0f };
+	float SleepAngularVelocityThreshold { 0.05f };
+	int32 SleepFrames { 30 };
+
+	int32 NumContactSolverIterations { 4 };
+
+	// Penetration allowed before the solver starts pushing bodies apart, and the fraction of it removed per iteration.
+	float ContactSlop { 0.5f };
+	float ContactPositionCorrection { 0.8f };
+
+	// Grid entries are points, so query bounds are grown by this much to reach the shapes around them.
+	float QueryCandidateMargin { 50.0f };
+
+	// Gap left between a mover and the static geometry it hits, so its next sweep doesn't start out touching it.
+	float StaticContactOffset { 0.1f };
+
 private:
 	FCollisionSpatialGrid SpatialGrid;
+	FColliderTable ColliderTable;
+	FStaticWorldCollision StaticWorldCollision;
+
+	// Held for writing while the grid or collider table change, and for reading by the gameplay queries.
+	FRWLock CollisionWorldLock;
+
+	// Sweeps Shape from From to To against the static world and returns, in OutMove, how far it gets. With bSlide, the
+	// part of the move cut off by a contact is slid along the contact plane and swept once more. Returns true on a hit.
+	bool SweepStaticWorld(const FSupportShape& Shape, const FTransform& From, const FTransform& To, bool bSlide, FVector& OutMove) const;
+
+	bool OverlapShape_Locked(const FCollisionOverlapQuery& Query, TArray<FCollisionQueryHit>& OutHits);
+	bool SweepShape_Locked(const FCollisionSweepQuery& Query, FCollisionQueryHit& OutHit);
+
+	TArray<TArray<FCollisionEvent>> CollisionEvents;
+	TArray<FCollisionEvent> MergedCollisionEvents;
+	TArray<FConservativeAdvancementHistogram> ConservativeAdvancementHistograms;
+
+	static void DispatchCollisionEventBatches(TArray<FCollisionEvent>& Events, bool bThreadSafeOnly);
+
+	// Next ICollisionHandler::RegistrationId to hand out.
+	int32 NextCollisionHandlerId { 0 };
+
+	int32 NumWorkerThreads { 1 };
+
+	float ContactSolverDeltaTime { 0.0f };
+	TArray<FSolverBody> SolverBodies;
+	TArray<FSolverContact> SolverContacts;
+	TArray<FContactConstraint> ContactConstraints;
+
+	// Body index of every collider taking part in a contact, INDEX_NONE until its body has been gathered.
+	TMap<uint64, int32> SolverBodyIndices;
+	TSet<uint64> SolverPairs;
+
+	// Constraint indices per colour. Constraints that couldn't get one of the 64 colours share a trailing colour that is
+	// solved by a single thread.
+	TArray<TArray<int32>> ContactColors;
+	int32 IdxSerialContactColor { INDEX_NONE };
+
+	int32 WakeIsland(int32 IslandId);
+	int32 FindIslandRoot(int32 IdxNode);
+
+	// Members of every sleeping island, keyed by the id stored in their FSleepState.
+	TMap<int32, TArray<flecs::entity>> SleepingIslands;
+	int32 NextIslandId { 0 };
+
+	// Scratch union-find over the awake colliders, rebuilt by every Iter_Sleep.
+	TArray<flecs::entity> IslandEntities;
+	TArray<int32> IslandParents;
+	TArray<bool> IslandNodeIdle;
+	TArray<TPair<int32, flecs::entity>> IslandEdges;
+	TMap<uint64, int32> IslandNodeIndices;
+	TArray<int32> IslandsToWake;
 	
-	flecs::query<const FCollisionShape, const FPosition, const FVelocity, FNarrowPhaseCollisionCandidates>* QueryBroadPhase { nullptr };
-	flecs::query<const FOneFrameMovementSequence, const FCollisionShape, const FVelocity, const FTransformComponent, const FAngularVelocity, FPosition, FNarrowPhaseCollisionCandidates, FNarrowPhaseEntityContacts>* QueryMovePath { nullptr };
-	flecs::query<const FCollisionShape, const FTransformComponent, const FVelocity, const FAngularVelocity, FNarrowPhaseCollisionCandidates, FPosition, FNarrowPhaseEntityContacts>* QueryNarrowPhase { nullptr };
-	flecs::query<const FPosition, FCollisionGridMember>* QueryChangedMembers { nullptr };
-	flecs::query<const FPosition, FNarrowPhaseEntityContacts>* QueryNarrowPhaseCollisionPairs { nullptr };
-
-	TArray<flecs::worker_iterable<const FCollisionShape, const FPosition, const FVelocity, FNarrowPhaseCollisionCandidates>> WorkerBroadPhase;
-	TArray<flecs::worker_iterable<const FOneFrameMovementSequence, const FCollisionShape, const FVelocity, const FTransformComponent, const FAngularVelocity, FPosition, FNarrowPhaseCollisionCandidates, FNarrowPhaseEntityContacts>> WorkerMovePath;
-	TArray<flecs::worker_iterable<const FCollisionShape, const FTransformComponent, const FVelocity, const FAngularVelocity, FNarrowPhaseCollisionCandidates, FPosition, FNarrowPhaseEntityContacts>> WorkerNarrowPhase;
-	TArray<flecs::worker_iterable<const FPosition, FCollisionGridMember>> WorkerChangedMembers;
-	TArray<flecs::worker_iterable<const FPosition, FNarrowPhaseEntityContacts>> WorkerNarrowPhaseCollisionPairs;
+	using FQueryBroadPhase = TEcsSystemQuery<const FCollisionShape, const FPosition, const FVelocity, FNarrowPhaseCollisionCandidates, const FCollisionGridMember>;
+	using FQueryMovePath = TEcsSystemQuery<const FOneFrameMovementSequence, const FCollisionShape, const FVelocity, const FTransformComponent, const FAngularVelocity, FPosition, FNarrowPhaseCollisionCandidates, FNarrowPhaseEntityContacts>;
+	using FQueryNarrowPhase = TEcsSystemQuery<const FCollisionShape, const FTransformComponent, const FVelocity, const FAngularVelocity, FNarrowPhaseCollisionCandidates, FPosition, FNarrowPhaseEntityContacts>;
+	using FQueryChangedMembers = TEcsSystemQuery<const FPosition, FCollisionGridMember>;
+	using FQueryNarrowPhaseCollisionPairs = TEcsSystemQuery<const FPosition, FNarrowPhaseEntityContacts>;
+	using FQueryColliderTable = TEcsSystemQuery<const FCollisionGridMember, const FTransformComponent, const FCollisionShape, const FVelocity, const FAngularVelocity, const FConvexHullShape>;
+	using FQuerySleepCandidates = TEcsSystemQuery<const FNarrowPhaseEntityContacts, FSleepState, const FVelocity, const FAngularVelocity>;
+	using FQuerySleeping = TEcsSystemQuery<const FSleepState, const FVelocity, const FAngularVelocity>;
+	using FQueryContactSolver = TEcsSystemQuery<const FNarrowPhaseEntityContacts>;
+	using FQuerySolverBodies = TEcsSystemQuery<const FPosition, const FTransformComponent, const FCollisionShape, const FConvexHullShape, const FVelocity, const FInverseMass>;
+	using FQueryStateHash = TEcsSystemQuery<const FCollisionGridMember, const FPosition, const FVelocity>;
+
+	FQueryBroadPhase::FQuery* QueryBroadPhase { nullptr };
+	FQueryMovePath::FQuery* QueryMovePath { nullptr };
+	FQueryNarrowPhase::FQuery* QueryNarrowPhase { nullptr };
+	FQueryChangedMembers::FQuery* QueryChangedMembers { nullptr };
+	FQueryNarrowPhaseCollisionPairs::FQuery* QueryNarrowPhaseCollisionPairs { nullptr };
+	FQueryColliderTable::FQuery* QueryColliderTable { nullptr };
+	FQuerySleepCandidates::FQuery* QuerySleepCandidates { nullptr };
+	FQuerySleeping::FQuery* QuerySleeping { nullptr };
+	FQueryContactSolver::FQuery* QueryContactSolver { nullptr };
+	FQuerySolverBodies::FQuery* QuerySolverBodies { nullptr };
+	FQueryStateHash::FQuery* QueryStateHash { nullptr };
+
+	TArray<FQueryChangedMembers::FWorker> WorkerChangedMembers;
+
+	// Per-collider cost varies with the number of candidates, so these stages balance by work stealing instead of a
+	// static worker split.
+	FEcsParallelFor ParallelBroadPhase { TEXT("CollisionBroadphase"), 64 };
+	FEcsParallelFor ParallelNarrowPhase { TEXT("CollisionNarrowPhase"), 16 };
+	FEcsParallelFor ParallelMovePath { TEXT("CollisionMovePath"), 8 };
+	FEcsParallelFor ParallelCollisionPairs { TEXT("CollisionPairs"), 64 };
 };
@@ -1,24 +1,39 @@
 #pragma once
 
+#include "UECS/EcsParallelFor.h"
+#include "UECS/EcsTimeSlicer.h"
 #include "UECS/SystemReadWriteUsage.h"
 
 struct FMovementInput;
+struct FNavmeshAgent;
+struct FNavmeshPathRequest;
+struct FNavmeshPathResponse;
+struct FOneFrameMovementSequence;
+struct FPosition;
+struct FSpeed;
+struct FVelocity;
+class dtNavMesh;
 
 namespace flecs
 {
 	struct world;
-	template<typename ... Components> struct query;
-	template<typename ... Components> struct worker_iterable;
 }
 
 struct FLECSLIBRARY_API SystemFindNavmeshPath
 {
 	SystemFindNavmeshPath(flecs::world& World);
-	void Prep(int32 NumThreads);
+
+	// Splits the frame's work over NumThreads workers. Must be called every frame, before any of the Iter_ functions.
+	void Prep(float DeltaTime, int32 NumThreads);
 	void Iter_FindPath(const float DeltaTime, flecs::world& World, UWorld* UnrealWorld, const int32 IdxThread) const;
+	void Iter_FindPath(const float DeltaTime, flecs::world& World, dtNavMesh* NavMesh, const int32 IdxThread) const;
 	void Iter_EnqueueMovement(const float DeltaTime, flecs::world& World, UWorld* UnrealWorld, const int32 IdxThread) const;
 	void Iter_NavmeshInput(const float DeltaTime, flecs::world& World, UWorld* UnrealWorld, const int32 IdxThread) const;
 
+	// Registers path finding, movement and input with the scheduler, in that order. Found paths and finished ones are
+	// added and removed through the stage world, so they land when the scheduler's segment is merged.
+	void Schedule(class UnrealEcsSystemScheduler& Scheduler, UWorld* UnrealWorld);
+
 	int32 GetCount_PathRequests() const;
 	int32 GetCount_EnqueueMovement() const;
 	int32 GetCount_NavmeshInput() const;
@@ -27,13 +42,23 @@ struct FLECSLIBRARY_API SystemFindNavmeshPath
 	static FSystemReadWriteUsage GetSystemReadWriteUsage_EnqueueMovement();
 	static FSystemReadWriteUsage GetSystemReadWriteUsage_NavmeshInput();
 
+	// Path requests wait for their entity's slice to come up, so raising NumSlices bounds the pathfinding done per
+	// frame. Movement and input stay at the full rate.
+	FEcsTimeSlicer PathRequestSlicer;
+
 	
 private:
-	flecs::query<const struct FNavmeshAgent, const struct FNavmeshPathRequest>* QueryPathRequests { nullptr };
-	flecs::query<struct FNavmeshPathResponse, struct FOneFrameMovementSequence, struct FPosition, struct FSpeed, struct FVelocity>* QueryEnqueueMovement { nullptr };
-	flecs::query<const FNavmeshAgent, const FPosition, const FMovementInput, const FSpeed, FOneFrameMovementSequence>* QueryNavmeshInput { nullptr };
+	using FQueryPathRequests = TEcsSystemQuery<const FNavmeshAgent, const FNavmeshPathRequest>;
+	using FQueryEnqueueMovement = TEcsSystemQuery<FNavmeshPathResponse, FOneFrameMovementSequence, const FPosition, const FSpeed, const FVelocity>;
+	using FQueryNavmeshInput = TEcsSystemQuery<const FNavmeshAgent, FPosition, FMovementInput, const FSpeed, FOneFrameMovementSequence>;
+
+	FQueryPathRequests::FQuery* QueryPathRequests { nullptr };
+	FQueryEnqueueMovement::FQuery* QueryEnqueueMovement { nullptr };
+	FQueryNavmeshInput::FQuery* QueryNavmeshInput { nullptr };
 
-	TArray<flecs::worker_iterable<const struct FNavmeshAgent, const struct FNavmeshPathRequest>> WorkerPathRequests {};
-	TArray<flecs::worker_iterable<struct FNavmeshPathResponse, struct FOneFrameMovementSequence, struct FPosition, struct FSpeed, struct FVelocity>> WorkerEnqueueMovement {};
-	TArray<flecs::worker_iterable<const FNavmeshAgent, const FPosition, const FMovementInput, const FSpeed, FOneFrameMovementSequence>> WorkerNavmeshInput {};
+	// Path queries cost wildly different amounts depending on distance and navmesh layout, so work is balanced by
+	// stealing rather than split statically.
+	mutable FEcsParallelFor ParallelPathRequests { TEXT("NavmeshFindPath"), 4 };
+	mutable FEcsParallelFor ParallelEnqueueMovement { TEXT("NavmeshEnqueueMovement"), 64 };
+	mutable FEcsParallelFor ParallelNavmeshInput { TEXT("NavmeshInput"), 32 };
 };
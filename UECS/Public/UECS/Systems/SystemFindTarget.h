@@ -1,5 +1,6 @@
 #pragma once
 
+#include "UECS/EcsTimeSlicer.h"
 #include "UECS/flecs.h"
 
 namespace flecs
@@ -25,6 +26,10 @@ struct FLECSLIBRARY_API FSystemFindTarget
 	void AsyncUnrealOverlapForTargets(flecs::world& World);
 	void Iter(const float DeltaTime, flecs::world& World);
 
+	// Overlaps and line of sight traces are the most expensive thing our AI does per frame, so they can be spread over
+	// frames by raising TimeSlicer.NumSlices.
+	FEcsTimeSlicer TimeSlicer;
+
 private:
 	flecs::query<const FActorComponent, const FTransformComponent, const FAggroSearchComponent, const FFieldOfViewComponent>* QueryPotentialTargets { nullptr };
 	flecs::query<const FActorComponent, const FTransformComponent, const FPotentialTargetActor, const FAggroSearchComponent>* QueryLineOfSight { nullptr };
@@ -1,21 +1,21 @@
 #pragma once
 
+#include "UECS/SystemReadWriteUsage.h"
 #include "UECS/UnrealEcsSystem.h"
 
 struct FVelocity;
 struct FPosition;
 
-namespace flecs
-{
-	template<typename ... Components> struct query;
-}
-
 struct FSystemIntegrateVelocity : UnrealEcsSystem
 {
 	virtual void Initialize(UWorldSubsystem* InOwner, flecs::world* InEcsWorld) override;
 	virtual void Schedule(UnrealEcsSystemScheduler* InScheduler) override;
 	
 	void Iter(float DeltaTime, flecs::world& World) const;
+
+	static FSystemReadWriteUsage GetSystemReadWriteUsage();
 private:
-	flecs::query<const FVelocity, FPosition>* Query { nullptr };
+	using FQueryIntegrate = TEcsSystemQuery<const FVelocity, FPosition>;
+
+	FQueryIntegrate::FQuery* Query { nullptr };
 };
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "UECS/EcsChangeFilter.h"
+
 struct FActorComponent;
+class FEcsRenderState;
 
 namespace flecs
 {
@@ -11,10 +14,33 @@ namespace flecs
 struct FLECSLIBRARY_API SystemPackTransforms
 {
 	SystemPackTransforms(flecs::world& World);
+
+	// Entities with an FPreviousPosition are drawn between it and FPosition by the alpha of the FFixedStepClock
+	// singleton, if there is one. The blend goes into their FRenderTransform; FTransformComponent keeps the simulated
+	// pose.
 	void Iter(const float DeltaTime, flecs::world& FlecsWorld) const;
 
+	// Like Iter, but actor transforms go into the render state's write buffer instead of straight to the actors, so it
+	// can run on a worker. Pair it with SyncActorsToEcs on the game thread.
+	void Pack(const float DeltaTime, flecs::world& FlecsWorld, FEcsRenderState& RenderState) const;
+
+	// Reads the transforms of actors driven from Unreal back into the ECS. Game thread only.
+	void SyncActorsToEcs(flecs::world& FlecsWorld) const;
+
+	// When enabled, transforms are only rebuilt, and actors only moved, for tables whose position, rotation, scale or
+	// parent transform changed since the last run. The transform pass reports the "PackTransforms skip ratio" stat,
+	// the actor pass the "PackTransforms actor skip ratio" one.
+	mutable FEcsChangeFilter ChangeFilter;
+
 private:
-	flecs::query<const struct FPosition, const struct FRotationComponent, const struct FScale, const struct FTransformComponent, struct FTransformComponent>* QueryTransforms { nullptr };
-	flecs::query<FActorComponent, const FTransformComponent>* QueryEcsToUnrealActors { nullptr };
+	// Counts the actor pass apart from the transform pass; follows ChangeFilter.bEnabled.
+	mutable FEcsChangeFilter ActorChangeFilter;
+
+	void UpdateTransforms(flecs::world& FlecsWorld) const;
+
+	mutable float LastAlpha { -1.0f };
+
+	flecs::query<const struct FPosition, const struct FRotationComponent, const struct FScale, const struct FTransformComponent, struct FTransformComponent, const struct FPreviousPosition, struct FRenderTransform>* QueryTransforms { nullptr };
+	flecs::query<const FActorComponent, const FTransformComponent, const FRenderTransform>* QueryEcsToUnrealActors { nullptr };
 	flecs::query<const FActorComponent, FPosition, FRotationComponent, FScale>* QueryActorsToEcs { nullptr };
 };
@@ -10,7 +10,6 @@ struct FPosition;
 namespace flecs
 {
 	struct world;
-	template<typename ... Components> struct query;
 }
 
 struct FLECSLIBRARY_API FSystemRampedMoveToEntity
@@ -21,7 +20,9 @@ struct FLECSLIBRARY_API FSystemRampedMoveToEntity
 	static FSystemReadWriteUsage GetSystemReadWriteUsage();
 	
 private:
-	flecs::query<const FPosition, FVelocity, FRampedMoveToEntity>* QueryRampedMove { nullptr };
+	using FQueryRampedMove = TEcsSystemQuery<const FPosition, FVelocity, FRampedMoveToEntity>;
+
+	FQueryRampedMove::FQuery* QueryRampedMove { nullptr };
 };
 
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "UECS/EcsChangeFilter.h"
 
 namespace flecs
 {
@@ -8,8 +9,10 @@ namespace flecs
 }
 
 struct FTransformComponent;
+struct FRenderTransform;
 struct FInstancedStaticMesh;
 struct FInstancedStaticMeshMember;
+class FEcsRenderState;
 
 struct FLECSLIBRARY_API SystemStaticMeshDraw
 {
@@ -17,6 +20,14 @@ struct FLECSLIBRARY_API SystemStaticMeshDraw
 
 	void Iter(const float DeltaTime, flecs::world& FlecsWorld) const;
 
+	// Like Iter, but instance updates go into the render state's write buffer instead of straight to the ISM
+	// components, so it can run on a worker.
+	void Pack(const float DeltaTime, flecs::world& FlecsWorld, FEcsRenderState& RenderState) const;
+
+	// When enabled, instances are only updated for tables whose transforms changed since the last run. Its skip ratio
+	// is the "StaticMeshDraw skip ratio" stat.
+	mutable FEcsChangeFilter ChangeFilter;
+
 private:
-	flecs::query<const FInstancedStaticMeshMember, const FTransformComponent, FInstancedStaticMesh>* QueryIsmChanged { nullptr };
+	flecs::query<const FInstancedStaticMeshMember, const FTransformComponent, const FInstancedStaticMesh, const FRenderTransform>* QueryIsmChanged { nullptr };
 };
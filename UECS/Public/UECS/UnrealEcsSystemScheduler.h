@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Tasks/Task.h"
+#include "UECS/SystemReadWriteUsage.h"
+
+namespace flecs
+{
+	struct world;
+}
+
+// Runs registered system stages as a dependency graph on the UE task system. A stage waits for every earlier stage whose
+// read/write usage conflicts with its own (write/write, write/read or read/write on any component), and nothing else, so
+// stages touching disjoint components run concurrently. Registration order decides which of two conflicting stages runs
+// first.
+//
+// Exclusive stages are full barriers that run on the thread calling Run, for work that has to touch the game thread.
+//
+// Between two exclusive stages the world is in flecs readonly mode, and every task of a stage is handed its own flecs
+// stage as World instead of the world itself. Adding, removing or setting components through it, or through entities
+// of queries iterated with it, is queued per task instead of moving entities between tables under other threads. All
+// queues are merged in one batch when the segment ends, before the next exclusive stage or the end of Run, which also
+// collapses several changes to the same entity into a single table move. Changes made in a segment are therefore
+// invisible to the rest of it. Stage functions must go through the World they're handed, and Run must not be called
+// while the world is deferred or progressing.
+class FLECSLIBRARY_API UnrealEcsSystemScheduler
+{
+public:
+	using FStageFunction = TFunction<void(float DeltaTime, flecs::world& World)>;
+	using FParallelStageFunction = TFunction<void(float DeltaTime, flecs::world& World, int32 IdxThread)>;
+	using FPrepFunction = TFunction<void(float DeltaTime, int32 NumThreads)>;
+	using FWorkCountFunction = TFunction<int32()>;
+
+	UnrealEcsSystemScheduler(flecs::world& InWorld, int32 InNumThreads);
+
+	// Single task per frame.
+	void AddStage(const TCHAR* Name, const FSystemReadWriteUsage& Usage, FStageFunction Function);
+
+	// NumThreads tasks per frame, each given its thread index, for systems iterating worker_iterables or an
+	// FEcsParallelFor. Prep is called every frame the stage runs, once its dependencies have finished and before any of
+	// its tasks start, so it can split the work of the frame.
+	//
+	// With a WorkCount, the stage fans out adaptively instead: each frame, after Prep, the number of items times the
+	// measured cost per item decides how many of the NumThreads slices actually get a task, at least
+	// ecs.Scheduler.MinSliceCostUs of work each. Tiny workloads run as a single slice without any fan-out. Prep is still
+	// told NumThreads, and the function is only called for thread indices [0, NumSlices), so it has to cope with the
+	// others never showing up, as an FEcsParallelFor does by stealing their chunks.
+	void AddParallelStage(const TCHAR* Name, const FSystemReadWriteUsage& Usage, FParallelStageFunction Function, FPrepFunction Prep = {}, FWorkCountFunction WorkCount = {});
+
+	// Barrier stage, run on the calling thread once everything registered before it has finished.
+	void AddExclusiveStage(const TCHAR* Name, FStageFunction Function);
+
+	// Runs the stage registered as Name only every FrameInterval frames, handing it the time of all frames since it last
+	// ran. Later stages don't wait on it in the frames it sits out. For AI and other work that doesn't need the full
+	// rate; see FEcsTimeSlicer to spread a stage's entities over frames instead.
+	void SetStageFrameInterval(const TCHAR* Name, int32 FrameInterval);
+
+	void SetNumThreads(int32 InNumThreads);
+	FORCEINLINE int32 GetNumThreads() const { return NumThreads; }
+
+	// Runs every stage once and returns when all have finished.
+	void Run(float DeltaTime);
+
+	// Removes every stage.
+	void Reset();
+
+private:
+	struct FStage
+	{
+		const TCHAR* Name;
+		FSystemReadWriteUsage Usage;
+		FParallelStageFunction Function;
+		FPrepFunction Prep;
+		FWorkCountFunction WorkCount;
+		bool bParallel { false };
+		bool bExclusive { false };
+
+		// First of the flecs stages handed to the stage's tasks, one per task.
+		int32 IdxFirstFlecsStage { 0 };
+
+		int32 FrameInterval { 1 };
+		int32 FramesSinceRun { 0 };
+		float ElapsedSinceRun { 0.0f };
+
+		// Moving average of the cycles spent per item by adaptive stages, negative until first measured.
+		double CyclesPerItem { -1.0 };
+
+		// Earlier stages of the same segment this one has to wait for.
+		TArray<int32> Dependencies;
+	};
+
+	void Build();
+
+	// Runs an adaptive parallel stage: prepares it, picks its fan-out and runs its slices, measuring their cost.
+	void RunAdaptiveStage(FStage& Stage, float DeltaTime);
+	int32 GetNumSlices(const FStage& Stage, int32 NumItems) const;
+
+	// Merges the commands queued by the stages of the segment, if it is still open.
+	void EndSegment();
+
+	// Waits for the stages in [IdxBegin, IdxEnd) this frame, skipping those that sat it out.
+	void WaitForStages(int32 IdxBegin, int32 IdxEnd) const;
+
+	flecs::world& World;
+	int32 NumThreads { 1 };
+	bool bIsBuilt { false };
+	bool bIsInSegment { false };
+
+	// Flecs stages used by the scheduler, including stage 0, which stays with the world itself.
+	int32 NumFlecsStages { 1 };
+
+	TArray<FStage> Stages;
+
+	// Per-frame completion task of every stage.
+	TArray<UE::Tasks::FTask> StageTasks;
+};